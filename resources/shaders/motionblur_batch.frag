@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2009-2010 The Gear Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Gear nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// layer texture that should be blurred
+uniform sampler2D tex;
+// with of texture in pixels
+uniform int textureWidth;
+// height of texture in pixels
+uniform int textureHeight;
+
+varying vec4 Color;
+varying vec2 TexCoord;
+// blur radius (pixels) and angle (radians, CCW)
+varying vec2 Blur;
+
+// must match MAX_BLUR_RADIUS in MotionBlurBatch.cpp
+const int MAX_RADIUS = 32;
+
+void main()
+{
+        int radius = int(Blur.x);
+
+        if (radius <= 0) {
+                gl_FragColor = texture2D(tex, TexCoord);
+                return;
+        }
+
+        vec2 dir = vec2(
+                cos(-Blur.y) / float(textureWidth),
+                sin(-Blur.y) / float(textureHeight)
+        );
+
+        vec4 color = vec4(0.0, 0.0, 0.0, 0.0);
+        float sum = 0.0;
+
+        for (int i = -MAX_RADIUS; i <= MAX_RADIUS; ++i) {
+                if (i < -radius || i > radius) {
+                        continue;
+                }
+
+                float weight = float(radius) - abs(float(i)) / 2.0;
+                color += texture2D(tex, TexCoord + dir * float(i)) * weight;
+
+                sum += weight;
+        }
+
+        gl_FragColor = color / sum;
+}
@@ -26,6 +26,7 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <signal.h>
 #include <stdlib.h>
 
 #include "clanlib/core/math.h"
@@ -40,6 +41,7 @@
 #include "common/Game.h"
 #include "common/Player.h"
 #include "common/Properties.h"
+#include "common/Trace.h"
 #include "gfx/DebugLayer.h"
 #include "gfx/GameWindow.h"
 #include "gfx/Stage.h"
@@ -74,6 +76,8 @@ class Application
 
 		static void onWindowClose();
 
+		static void startTracing();
+
 		/** This method must be called to do a proper drawing */
 		static void wmRepaint() {}
 
@@ -109,6 +113,27 @@ void initializePlayerId()
 
 }
 
+#if defined(UNIX)
+void onTraceDumpSignal(int)
+{
+	Trace::requestDump();
+}
+#endif // UNIX
+
+void Application::startTracing()
+{
+	const CL_String traceFile = Properties::getString(DBG_TRACE_FILE, "");
+
+	if (!traceFile.empty()) {
+		Trace::start(traceFile);
+		Trace::setThreadName("main");
+
+#if defined(UNIX)
+		signal(SIGUSR1, &onTraceDumpSignal);
+#endif // UNIX
+	}
+}
+
 int Application::main(const std::vector<CL_String> &args)
 {
 
@@ -156,6 +181,8 @@ int Application::main(const std::vector<CL_String> &args)
 			}
 		}
 
+		startTracing();
+
 		// set player name
 		Game &game = Game::getInstance();
 		game.getPlayer().setName(Properties::getString(CG_PLAYER_NAME, ""));
@@ -281,9 +308,21 @@ int Application::main(const std::vector<CL_String> &args)
 		MainMenuScene mainMenuScene(&gameWindow);
 		Gfx::Stage::pushScene(&mainMenuScene);
 
-		while(gameWindow.update()) {
+		while(true) {
+			G_TRACE("frame");
+
+			if (!gameWindow.update()) {
+				break;
+			}
+
 			gameWindow.draw(gc);
-			displayWindow.flip(SYNC_PARAM);
+
+			{
+				G_TRACE("flip");
+				displayWindow.flip(SYNC_PARAM);
+			}
+
+			Trace::dumpIfRequested();
 		}
 
 	} catch (CL_Exception &e) {
@@ -293,6 +332,7 @@ int Application::main(const std::vector<CL_String> &args)
 	}
 
 	Properties::save(CONFIG_FILE_CLIENT);
+	Trace::dump();
 
 	// free resources
 	if (setup_gl1) {
@@ -310,5 +350,6 @@ int Application::main(const std::vector<CL_String> &args)
 
 void Application::onWindowClose()
 {
+	Trace::dump();
 	exit(0);
 }
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LoadBotApplication.h"
+
+#include <algorithm>
+#include <signal.h>
+
+#include "ClanLib/network.h"
+
+#include "common/Properties.h"
+#include "network/loadbot/BotSwarm.h"
+
+CL_ClanApplication app(&LoadBotApplication::main);
+
+/** Bot updates per second when not set in properties */
+const int DEFAULT_TICK_RATE = 60;
+
+/** Cleared by termination signals to leave the main loop */
+volatile sig_atomic_t running = 1;
+
+void onTerminateSignal(int)
+{
+	running = 0;
+}
+
+int LoadBotApplication::main(const std::vector<CL_String> &args)
+{
+	try {
+		CL_SetupCore setup_core;
+		CL_SetupNetwork setup_network;
+
+		// no console logger, it would print every event of every bot
+
+		Properties::load(CONFIG_FILE_LOADBOT);
+
+		signal(SIGINT, &onTerminateSignal);
+		signal(SIGTERM, &onTerminateSignal);
+
+		Net::BotSwarm swarm;
+
+		const int tickRate = Properties::getInt(LB_TICK_RATE, DEFAULT_TICK_RATE);
+		const unsigned tickMs = 1000 / std::max(1, std::min(tickRate, 1000));
+
+		unsigned lastTick = CL_System::get_time();
+		unsigned nextTick = lastTick;
+
+		while (running) {
+			const unsigned now = CL_System::get_time();
+
+			if (static_cast<int>(now - nextTick) >= 0) {
+				// cars move by real time, so late ticks do not slow them down
+				swarm.update(now - lastTick);
+
+				lastTick = now;
+				nextTick += tickMs;
+
+				if (static_cast<int>(now - nextTick) >= 0) {
+					nextTick = now + tickMs;
+				}
+			}
+
+			// network events of all bots are handled by this thread
+			const int waitMs = static_cast<int>(nextTick - CL_System::get_time());
+			CL_KeepAlive::process(std::max(0, waitMs));
+		}
+	} catch (CL_Exception e) {
+		CL_Console::write_line("exception thrown: %1", e.message);
+	}
+
+	return 0;
+}
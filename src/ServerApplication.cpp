@@ -28,52 +28,52 @@
 
 #include "ServerApplication.h"
 
+#include <signal.h>
+
 #include "ClanLib/network.h"
 
 #include "common/loglevels.h"
 #include "common/Properties.h"
-#include "network/server/Server.h"
-#include "network/server/TimeTrailServer.h"
+#include "common/Trace.h"
+#include "network/server/RoomManager.h"
 
 CL_ClanApplication app(&ServerApplication::main);
 
-Net::Server *createTimeTrailServer()
-{
-	cl_log_event(LOG_INFO, "starting TIME TRAIL server");
-	return new Net::TimeTrailServer();
-}
+/** Rooms run on their own threads, main one only waits for signals */
+const unsigned SIGNAL_CHECK_MS = 100;
 
-Net::Server *createArcadeServer()
+/** Cleared by termination signals to leave the main loop */
+volatile sig_atomic_t running = 1;
+
+void onTerminateSignal(int)
 {
-	cl_log_event(LOG_INFO, "starting ARCADE server");
-	return new Net::Server();
+	running = 0;
 }
 
-Net::Server *createServer()
+#if defined(UNIX)
+void onTraceDumpSignal(int)
 {
-	const CL_String gameModeStr = Properties::getString(SRV_GAME_MODE, SRV_GAME_MODE_ARCADE);
-
-	if (gameModeStr == SRV_GAME_MODE_ARCADE) {
-		return createArcadeServer();
-	} else if (gameModeStr == SRV_GAME_MODE_TIMETRAIL) {
-		return createTimeTrailServer();
-	} else {
-		throw CL_Exception("unknown game mode: " + gameModeStr);
-	}
+	Trace::requestDump();
 }
+#endif // UNIX
 
-void destroyServer(Net::Server *&p_server)
+void startTracing()
 {
-	if (p_server != NULL) {
-		delete p_server;
-		p_server = NULL;
+	const CL_String traceFile = Properties::getString(DBG_TRACE_FILE, "");
+
+	if (!traceFile.empty()) {
+		Trace::start(traceFile);
+		Trace::setThreadName("main");
+
+#if defined(UNIX)
+		// kill -USR1 writes the trace without stopping the server
+		signal(SIGUSR1, &onTraceDumpSignal);
+#endif // UNIX
 	}
 }
 
 int ServerApplication::main(const std::vector<CL_String> &args)
 {
-	Net::Server *server = NULL;
-
 	try {
 		CL_SetupCore setup_core;
 		CL_SetupNetwork setup_network;
@@ -81,17 +81,25 @@ int ServerApplication::main(const std::vector<CL_String> &args)
 
 		Properties::load(CONFIG_FILE_SERVER);
 
-		server = createServer();
-		server->start();
+		startTracing();
+
+		signal(SIGINT, &onTerminateSignal);
+		signal(SIGTERM, &onTerminateSignal);
 
-		while (true) {
-			CL_KeepAlive::process();
-			CL_System::sleep(2);
+		Net::RoomManager rooms;
+		rooms.start();
+
+		while (running) {
+			Trace::dumpIfRequested();
+			CL_System::sleep(SIGNAL_CHECK_MS);
 		}
+
+		rooms.stop();
 	} catch (CL_Exception e) {
 		CL_Console::write_line("exception thrown: %1", e.message);
 	}
 
-	destroyServer(server);
+	Trace::dump();
+
 	return 0;
 }
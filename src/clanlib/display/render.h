@@ -49,3 +49,4 @@
 #include <ClanLib/Display/Render/shader_object.h>
 #include <ClanLib/Display/Render/shared_gc_data.h>
 #include <ClanLib/Display/Render/texture.h>
+#include <ClanLib/Display/Render/vertex_array_buffer.h>
@@ -191,6 +191,15 @@ static const int CL_PRIARR_TEXCOORDS = 2;
 #define DEPRECATED(func) func
 #endif
 
+// thread local storage
+#ifdef __GNUC__
+#define THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#pragma message("WARNING: You need to implement THREAD_LOCAL for this compiler")
+#endif
+
 // end of line string
 #if defined(WINDOWS)
 #define END_OF_LINE "\r\n"
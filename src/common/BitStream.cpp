@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BitStream.h"
+
+#include "clanlib/core/math.h"
+
+#include "common/gassert.h"
+
+BitWriter::BitWriter() :
+	m_bitPos(0)
+{
+	m_data.reserve(32);
+}
+
+void BitWriter::writeBits(unsigned p_value, int p_bitCount)
+{
+	G_ASSERT(p_bitCount >= 0 && p_bitCount <= 32);
+
+	while (p_bitCount > 0) {
+		if (m_bitPos == 0) {
+			m_data.push_back(0);
+		}
+
+		const int chunk = cl_min(8 - m_bitPos, p_bitCount);
+		const unsigned mask = (1u << chunk) - 1;
+
+		m_data[m_data.length() - 1] |= static_cast<char>((p_value & mask) << m_bitPos);
+
+		p_value >>= chunk;
+		p_bitCount -= chunk;
+		m_bitPos = (m_bitPos + chunk) % 8;
+	}
+}
+
+void BitWriter::writeSigned(int p_value, int p_bitCount)
+{
+	writeBits(static_cast<unsigned>(p_value), p_bitCount);
+}
+
+void BitWriter::writeBool(bool p_value)
+{
+	writeBits(p_value ? 1 : 0, 1);
+}
+
+void BitWriter::writeVarUint(unsigned p_value)
+{
+	while (p_value >= 0x80) {
+		writeBits((p_value & 0x7F) | 0x80, 8);
+		p_value >>= 7;
+	}
+
+	writeBits(p_value, 8);
+}
+
+void BitWriter::writeString(const CL_String8 &p_value)
+{
+	writeVarUint(p_value.length());
+
+	if (m_bitPos == 0) {
+		// byte aligned, copy at once
+		m_data.append(p_value);
+		return;
+	}
+
+	for (CL_String8::size_type i = 0; i < p_value.length(); ++i) {
+		writeBits(static_cast<unsigned char>(p_value[i]), 8);
+	}
+}
+
+BitReader::BitReader(const CL_String8 &p_data) :
+	m_data(p_data),
+	m_bitPos(0),
+	m_overrun(false)
+{
+	// empty
+}
+
+unsigned BitReader::readBits(int p_bitCount)
+{
+	G_ASSERT(p_bitCount >= 0 && p_bitCount <= 32);
+
+	if (m_bitPos + p_bitCount > m_data.length() * 8) {
+		m_overrun = true;
+		return 0;
+	}
+
+	unsigned result = 0;
+	int shift = 0;
+
+	while (shift < p_bitCount) {
+		const unsigned char byte = m_data[m_bitPos / 8];
+		const int offset = m_bitPos % 8;
+		const int chunk = cl_min(8 - offset, p_bitCount - shift);
+
+		result |= ((byte >> offset) & ((1u << chunk) - 1)) << shift;
+
+		shift += chunk;
+		m_bitPos += chunk;
+	}
+
+	return result;
+}
+
+int BitReader::readSigned(int p_bitCount)
+{
+	const unsigned value = readBits(p_bitCount);
+
+	if (p_bitCount > 0 && p_bitCount < 32 && (value & (1u << (p_bitCount - 1)))) {
+		// extend the sign
+		return static_cast<int>(value | ~((1u << p_bitCount) - 1));
+	}
+
+	return static_cast<int>(value);
+}
+
+bool BitReader::readBool()
+{
+	return readBits(1) != 0;
+}
+
+unsigned BitReader::readVarUint()
+{
+	unsigned result = 0;
+
+	for (int shift = 0; shift < 35; shift += 7) {
+		const unsigned byte = readBits(8);
+		result |= (byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0) {
+			break;
+		}
+	}
+
+	return result;
+}
+
+CL_String8 BitReader::readString()
+{
+	const unsigned length = readVarUint();
+
+	if (m_overrun || length > m_data.length() - m_bitPos / 8) {
+		m_overrun = true;
+		return CL_String8();
+	}
+
+	if (m_bitPos % 8 == 0) {
+		const CL_String8 result = m_data.substr(m_bitPos / 8, length);
+		m_bitPos += length * 8;
+
+		return result;
+	}
+
+	CL_String8 result;
+	result.reserve(length);
+
+	for (unsigned i = 0; i < length; ++i) {
+		result.push_back(static_cast<char>(readBits(8)));
+	}
+
+	return result;
+}
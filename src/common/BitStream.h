@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/text.h"
+
+/**
+ * Packs values into a byte string using only as many bits
+ * as each value needs. Bits are stored from the least significant.
+ */
+class BitWriter
+{
+	public:
+
+		BitWriter();
+
+		/** Writes p_bitCount lowest bits of p_value (up to 32) */
+		void writeBits(unsigned p_value, int p_bitCount);
+
+		/** Writes value in two's complement on p_bitCount bits */
+		void writeSigned(int p_value, int p_bitCount);
+
+		void writeBool(bool p_value);
+
+		/** Writes value in 7-bit groups, small numbers take one byte */
+		void writeVarUint(unsigned p_value);
+
+		/** Writes byte length followed by the bytes */
+		void writeString(const CL_String8 &p_value);
+
+		/** @return Packed data, unused bits of the last byte are zero */
+		const CL_String8 &getData() const { return m_data; }
+
+	private:
+
+		CL_String8 m_data;
+
+		/** Bits used in the last byte (0 when it is full) */
+		int m_bitPos;
+};
+
+/**
+ * Reads values written by BitWriter. Reading past the end
+ * returns zeros and marks the reader as overrun.
+ */
+class BitReader
+{
+	public:
+
+		explicit BitReader(const CL_String8 &p_data);
+
+		unsigned readBits(int p_bitCount);
+
+		int readSigned(int p_bitCount);
+
+		bool readBool();
+
+		unsigned readVarUint();
+
+		CL_String8 readString();
+
+		/** @return true when more bits were read than available */
+		bool isOverrun() const { return m_overrun; }
+
+	private:
+
+		/** Copy, so readers of temporaries do not dangle */
+		const CL_String8 m_data;
+
+		/** Position of next bit to read */
+		unsigned m_bitPos;
+
+		bool m_overrun;
+};
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Profiler.h"
+
+#if defined(PROFILER)
+
+#include <algorithm>
+#include <string.h>
+
+#include "common.h"
+
+namespace {
+
+/** True on the thread which calls Profiler::nextFrame() */
+THREAD_LOCAL bool s_profiledThread = false;
+
+}
+
+const int Profiler::HISTORY_SIZE;
+
+Profiler &Profiler::getInstance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler() :
+	m_historyPos(0),
+	m_frameCount(0),
+	m_frameStartUs(0)
+{
+	std::fill(m_frameHistory, m_frameHistory + HISTORY_SIZE, 0);
+
+	m_stack.reserve(16);
+	m_startTimes.reserve(16);
+}
+
+void Profiler::nextFrame()
+{
+	const cl_ubyte64 now = CL_System::get_microseconds();
+
+	if (!s_profiledThread) {
+		s_profiledThread = true;
+		m_frameStartUs = now;
+		return;
+	}
+
+	G_ASSERT(m_stack.empty() && "profile scope left open across frames");
+
+	m_frameHistory[m_historyPos] = static_cast<unsigned>(now - m_frameStartUs);
+
+	const int sectionCount = getSectionCount();
+	for (int i = 0; i < sectionCount; ++i) {
+		Section &section = m_sections[i];
+
+		section.m_history[m_historyPos] = section.m_currentUs;
+		section.m_currentUs = 0;
+	}
+
+	m_historyPos = (m_historyPos + 1) % HISTORY_SIZE;
+	m_frameCount = std::min(m_frameCount + 1, HISTORY_SIZE);
+	m_frameStartUs = now;
+}
+
+int Profiler::enter(const char *p_name)
+{
+	if (!s_profiledThread) {
+		return -1;
+	}
+
+	const int parent = m_stack.empty() ? -1 : m_stack.back();
+
+	// same literal may have different addresses in other translation units
+	int sectionId = -1;
+	const int sectionCount = getSectionCount();
+
+	for (int i = 0; i < sectionCount; ++i) {
+		if (m_sections[i].m_parent == parent && strcmp(m_sections[i].m_name, p_name) == 0) {
+			sectionId = i;
+			break;
+		}
+	}
+
+	if (sectionId == -1) {
+		Section section;
+		section.m_name = p_name;
+		section.m_parent = parent;
+		section.m_currentUs = 0;
+		std::fill(section.m_history, section.m_history + HISTORY_SIZE, 0);
+
+		m_sections.push_back(section);
+		sectionId = sectionCount;
+	}
+
+	m_stack.push_back(sectionId);
+	m_startTimes.push_back(CL_System::get_microseconds());
+
+	return sectionId;
+}
+
+void Profiler::leave(int p_sectionId)
+{
+	G_ASSERT(!m_stack.empty() && m_stack.back() == p_sectionId);
+
+	const cl_ubyte64 elapsed = CL_System::get_microseconds() - m_startTimes.back();
+	m_sections[p_sectionId].m_currentUs += static_cast<unsigned>(elapsed);
+
+	m_stack.pop_back();
+	m_startTimes.pop_back();
+}
+
+const char *Profiler::getSectionName(int p_sectionId) const
+{
+	return m_sections[p_sectionId].m_name;
+}
+
+int Profiler::getSectionParent(int p_sectionId) const
+{
+	return m_sections[p_sectionId].m_parent;
+}
+
+Profiler::Stats Profiler::getSectionStats(int p_sectionId) const
+{
+	return computeStats(m_sections[p_sectionId].m_history);
+}
+
+Profiler::Stats Profiler::getFrameStats() const
+{
+	return computeStats(m_frameHistory);
+}
+
+unsigned Profiler::getFrameTime(int p_age) const
+{
+	G_ASSERT(p_age >= 0 && p_age < HISTORY_SIZE);
+	return m_frameHistory[(m_historyPos - 1 - p_age + 2 * HISTORY_SIZE) % HISTORY_SIZE];
+}
+
+Profiler::Stats Profiler::computeStats(const unsigned *p_history) const
+{
+	Stats stats = { 0, 0, 0, 0 };
+
+	if (m_frameCount == 0) {
+		return stats;
+	}
+
+	// only the filled part of history counts
+	unsigned samples[HISTORY_SIZE];
+	unsigned sum = 0;
+
+	for (int i = 0; i < m_frameCount; ++i) {
+		samples[i] = p_history[(m_historyPos - 1 - i + HISTORY_SIZE) % HISTORY_SIZE];
+		sum += samples[i];
+	}
+
+	stats.m_lastUs = samples[0];
+	stats.m_avgUs = sum / m_frameCount;
+	stats.m_minUs = *std::min_element(samples, samples + m_frameCount);
+
+	const int p99Idx = (m_frameCount * 99) / 100;
+	std::nth_element(samples, samples + p99Idx, samples + m_frameCount);
+	stats.m_p99Us = samples[p99Idx];
+
+	return stats;
+}
+
+#endif // PROFILER
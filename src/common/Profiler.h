@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#if defined(PROFILER)
+
+#include <vector>
+
+#include "clanlib/core/system.h"
+
+/**
+ * Hierarchical CPU frame profiler.
+ * <p>
+ * Scopes are opened with G_PROFILE() and nest into a tree of sections.
+ * Every section keeps its cost from the last HISTORY_SIZE frames, from
+ * which the rolling min, average and 99th percentile are computed.
+ * <p>
+ * Only the thread that calls nextFrame() is profiled. Scopes entered
+ * on other threads (like the simulation thread) are ignored.
+ * <p>
+ * Whole profiler compiles out unless PROFILER is defined.
+ */
+class Profiler
+{
+	public:
+
+		/** Number of frames the statistics are computed from */
+		static const int HISTORY_SIZE = 120;
+
+		struct Stats {
+			/** Cost in the last finished frame */
+			unsigned m_lastUs;
+
+			unsigned m_minUs, m_avgUs, m_p99Us;
+		};
+
+		static Profiler &getInstance();
+
+
+		/** Closes the current frame and opens the next one. */
+		void nextFrame();
+
+		/** @return Section id or -1 when this thread is not profiled */
+		int enter(const char *p_name);
+
+		void leave(int p_sectionId);
+
+
+		int getSectionCount() const { return static_cast<signed>(m_sections.size()); }
+
+		const char *getSectionName(int p_sectionId) const;
+
+		/** @return Parent section id or -1 for the root sections */
+		int getSectionParent(int p_sectionId) const;
+
+		Stats getSectionStats(int p_sectionId) const;
+
+		/** @return Statistics of the whole frame time */
+		Stats getFrameStats() const;
+
+		/** @return Frame time from p_age frames ago (0 is the last one) */
+		unsigned getFrameTime(int p_age) const;
+
+		/** @return Number of finished frames in history */
+		int getFrameCount() const { return m_frameCount; }
+
+	private:
+
+		struct Section {
+			const char *m_name;
+			int m_parent;
+
+			/** Cost accumulated in the current frame */
+			unsigned m_currentUs;
+
+			unsigned m_history[HISTORY_SIZE];
+		};
+
+		std::vector<Section> m_sections;
+
+		/** Opened sections with their start times */
+		std::vector<int> m_stack;
+		std::vector<cl_ubyte64> m_startTimes;
+
+		unsigned m_frameHistory[HISTORY_SIZE];
+
+		/** History slot of the current frame */
+		int m_historyPos;
+
+		int m_frameCount;
+
+		cl_ubyte64 m_frameStartUs;
+
+
+		Profiler();
+
+		Stats computeStats(const unsigned *p_history) const;
+};
+
+/** Measures time spent from construction to the end of scope. */
+class ProfileScope
+{
+	public:
+
+		explicit ProfileScope(const char *p_name) :
+			m_sectionId(Profiler::getInstance().enter(p_name))
+		{}
+
+		~ProfileScope() {
+			if (m_sectionId != -1) {
+				Profiler::getInstance().leave(m_sectionId);
+			}
+		}
+
+	private:
+
+		const int m_sectionId;
+};
+
+#define G_PROFILE_JOIN_IMPL(a, b) a##b
+#define G_PROFILE_JOIN(a, b) G_PROFILE_JOIN_IMPL(a, b)
+
+/** Profiles enclosing scope. Name must be a string literal. */
+#define G_PROFILE(p_name) \
+	ProfileScope G_PROFILE_JOIN(profileScope, __LINE__)(p_name)
+
+#define G_PROFILE_FRAME() \
+	Profiler::getInstance().nextFrame()
+
+#else // PROFILER
+
+#define G_PROFILE(p_name)
+#define G_PROFILE_FRAME()
+
+#endif // PROFILER
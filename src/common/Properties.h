@@ -41,6 +41,9 @@
 // server configuration
 #define CONFIG_FILE_SERVER "server.cfg"
 
+// load bot configuration
+#define CONFIG_FILE_LOADBOT "loadbot.cfg"
+
 
 //
 // Configuration values
@@ -53,6 +56,15 @@
 #define CG_OPENGL_VER "cg_opengl_ver"
 #define CG_USE_SHADERS "cg_use_shaders"
 
+// motion blur of other cars; one of CG_MOTION_BLUR_* values
+#define CG_MOTION_BLUR "cg_motion_blur"
+#define CG_MOTION_BLUR_OFF 0
+#define CG_MOTION_BLUR_PER_CAR 1
+#define CG_MOTION_BLUR_BATCHED 2
+
+// run game logic on its own thread
+#define CG_THREADED_LOGIC "cg_threaded_logic"
+
 // player settings
 #define CG_PLAYER_NAME "cg_player_name"
 #define CG_PLAYER_ID "cg_player_id"
@@ -69,6 +81,14 @@
 // debug constants
 #define DBG_ITER_SPEED "dbg_iter_speed"
 
+// chrome trace output file, tracing is off when empty
+#define DBG_TRACE_FILE "dbg_trace_file"
+
+// simulated datagram loss in percent and delay in milliseconds
+#define DBG_NET_LOSS "dbg_net_loss"
+#define DBG_NET_LATENCY "dbg_net_latency"
+#define DBG_NET_JITTER "dbg_net_jitter"
+
 //
 // Server settings
 //
@@ -77,11 +97,59 @@
 
 #define SRV_LEVEL "srv_level"
 
+// car state snapshots sent per second
+#define SRV_SNAPSHOT_RATE "srv_snapshot_rate"
+
+// server loop updates per second
+#define SRV_TICK_RATE "srv_tick_rate"
+
 // server game mode; avaiable options are 'arcade' and 'timetrail'
 #define SRV_GAME_MODE "srv_game_mode"
 #define SRV_GAME_MODE_TIMETRAIL "timetrail"
 #define SRV_GAME_MODE_ARCADE "arcade"
 
+// rooms hosted by one server process; srv_room<n>_port, srv_room<n>_level
+// and srv_room<n>_game_mode override the settings above for room n
+#define SRV_ROOMS "srv_rooms"
+#define SRV_ROOM_PREFIX "srv_room"
+
+// threads running the rooms, number of cores by default
+#define SRV_WORKERS "srv_workers"
+
+// threads validating car states of all rooms, number of cores by default
+#define SRV_VALIDATION_THREADS "srv_validation_threads"
+
+// car state replay time of one room per tick in microseconds,
+// states over the budget are sampled
+#define SRV_VALIDATION_BUDGET "srv_validation_budget"
+
+//
+// Load bot settings
+//
+
+// server the bots connect to
+#define LB_SERVER "lb_server"
+#define LB_PORT "lb_port"
+
+// bots are named with this prefix and their number
+#define LB_NAME_PREFIX "lb_name_prefix"
+
+// bots started in total, lb_ramp_step more every lb_ramp_interval milliseconds
+#define LB_BOTS "lb_bots"
+#define LB_RAMP_STEP "lb_ramp_step"
+#define LB_RAMP_INTERVAL "lb_ramp_interval"
+
+// bot input; 'track' follows track center line, 'random' drives at random
+#define LB_DRIVING "lb_driving"
+#define LB_DRIVING_TRACK "track"
+#define LB_DRIVING_RANDOM "random"
+
+// bot updates per second
+#define LB_TICK_RATE "lb_tick_rate"
+
+// statistics are written this often in milliseconds
+#define LB_REPORT_INTERVAL "lb_report_interval"
+
 /**
  * Runtime properties. There are several groups:
  * <ul>
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Trace.h"
+
+#include <vector>
+
+#include "clanlib/core/io.h"
+
+#include "common.h"
+#include "common/loglevels.h"
+
+namespace {
+
+/** Events kept per thread. Older ones are overwritten. Power of two. */
+const unsigned BUFFER_CAPACITY = 1 << 16;
+
+const unsigned BUFFER_MASK = BUFFER_CAPACITY - 1;
+
+struct TraceEvent {
+	const char *m_name;
+	cl_ubyte64 m_startUs;
+	unsigned m_durationUs;
+};
+
+struct ThreadBuffer {
+	int m_threadId;
+
+	CL_String8 m_threadName;
+
+	TraceEvent m_events[BUFFER_CAPACITY];
+
+	/**
+	 * Events written so far, modulo 2^32. Only the owner thread
+	 * increments it. Read it through getWritten().
+	 */
+	CL_InterlockedVariable m_written;
+};
+
+/** Guards registration of buffers and the dump */
+CL_Mutex s_registryMutex;
+
+/** Buffers of all threads that ever recorded an event */
+std::vector<ThreadBuffer*> s_buffers;
+
+THREAD_LOCAL ThreadBuffer *s_threadBuffer = NULL;
+
+CL_String s_fileName;
+
+cl_ubyte64 s_startUs = 0;
+
+
+/** Counter is signed, so it is read as unsigned to wrap without overflow */
+unsigned getWritten(ThreadBuffer &p_buffer)
+{
+	return static_cast<unsigned>(p_buffer.m_written.get());
+}
+
+ThreadBuffer *getThreadBuffer()
+{
+	if (s_threadBuffer == NULL) {
+		ThreadBuffer *buffer = new ThreadBuffer();
+		buffer->m_written.set(0);
+
+		CL_MutexSection lock(&s_registryMutex);
+
+		buffer->m_threadId = static_cast<signed>(s_buffers.size()) + 1;
+		s_buffers.push_back(buffer);
+
+		s_threadBuffer = buffer;
+	}
+
+	return s_threadBuffer;
+}
+
+CL_String8 escape(const CL_String8 &p_str)
+{
+	CL_String8 result;
+	result.reserve(p_str.length());
+
+	for (CL_String8::size_type i = 0; i < p_str.length(); ++i) {
+		if (p_str[i] == '"' || p_str[i] == '\\') {
+			result += '\\';
+		}
+
+		result += p_str[i];
+	}
+
+	return result;
+}
+
+void writeThreadEvents(CL_File &p_file, ThreadBuffer &p_buffer, bool &p_first)
+{
+	const unsigned written = getWritten(p_buffer);
+	const unsigned count = cl_min(written, BUFFER_CAPACITY);
+
+	// differences of unsigned counters stay right when they wrap
+	std::vector<TraceEvent> events;
+	events.reserve(count);
+
+	for (unsigned i = 0; i < count; ++i) {
+		events.push_back(p_buffer.m_events[(written - count + i) & BUFFER_MASK]);
+	}
+
+	// the owner could overwrite oldest events while they were copied,
+	// in a full buffer the oldest slot is also the one it writes next
+	const unsigned busy = count == BUFFER_CAPACITY ? 1 : 0;
+	const unsigned overwritten = cl_min(getWritten(p_buffer) - written + busy, count);
+
+	CL_String8 line;
+
+	for (unsigned i = overwritten; i < count; ++i) {
+		const TraceEvent &event = events[i];
+
+		line = cl_format(
+				"%1{\"name\":\"%2\",\"ph\":\"X\",\"pid\":1,\"tid\":%3,\"ts\":%4,\"dur\":%5}\n",
+				p_first ? "" : ",",
+				escape(event.m_name),
+				p_buffer.m_threadId,
+				CL_StringHelp::ull_to_local8(event.m_startUs - s_startUs),
+				event.m_durationUs
+		);
+
+		p_file.write(line.c_str(), line.length());
+		p_first = false;
+	}
+}
+
+}
+
+volatile bool Trace::s_enabled = false;
+
+volatile sig_atomic_t Trace::s_dumpRequested = 0;
+
+void Trace::start(const CL_String &p_fileName)
+{
+	s_fileName = p_fileName;
+	s_startUs = CL_System::get_microseconds();
+	s_enabled = true;
+
+	cl_log_event(LOG_INFO, "tracing to %1", p_fileName);
+}
+
+void Trace::setThreadName(const char *p_name)
+{
+	if (!s_enabled) {
+		return;
+	}
+
+	ThreadBuffer *buffer = getThreadBuffer();
+
+	CL_MutexSection lock(&s_registryMutex);
+	buffer->m_threadName = p_name;
+}
+
+void Trace::record(const char *p_name, cl_ubyte64 p_startUs, cl_ubyte64 p_endUs)
+{
+	ThreadBuffer *buffer = getThreadBuffer();
+	const unsigned written = getWritten(*buffer);
+
+	TraceEvent &event = buffer->m_events[written & BUFFER_MASK];
+	event.m_name = p_name;
+	event.m_startUs = p_startUs;
+	event.m_durationUs = static_cast<unsigned>(p_endUs - p_startUs);
+
+	// publish the event to the dumping thread
+	buffer->m_written.set(static_cast<int>(written + 1));
+}
+
+void Trace::dump()
+{
+	if (!s_enabled) {
+		return;
+	}
+
+	CL_MutexSection lock(&s_registryMutex);
+
+	try {
+		CL_File file(s_fileName, CL_File::create_always, CL_File::access_write);
+
+		const CL_String8 header = "{\"traceEvents\":[\n";
+		file.write(header.c_str(), header.length());
+
+		bool first = true;
+		CL_String8 line;
+
+		foreach (ThreadBuffer *buffer, s_buffers) {
+			if (!buffer->m_threadName.empty()) {
+				line = cl_format(
+						"%1{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%2,"
+						"\"args\":{\"name\":\"%3\"}}\n",
+						first ? "" : ",",
+						buffer->m_threadId,
+						escape(buffer->m_threadName)
+				);
+
+				file.write(line.c_str(), line.length());
+				first = false;
+			}
+
+			writeThreadEvents(file, *buffer, first);
+		}
+
+		const CL_String8 footer = "]}\n";
+		file.write(footer.c_str(), footer.length());
+
+		file.close();
+
+		cl_log_event(LOG_INFO, "trace written to %1", s_fileName);
+
+	} catch (CL_Exception &e) {
+		cl_log_event(
+				LOG_ERROR,
+				"trace %1 cannot be written: %2",
+				s_fileName,
+				e.message
+		);
+	}
+}
+
+void Trace::dumpIfRequested()
+{
+	if (s_dumpRequested) {
+		s_dumpRequested = 0;
+		dump();
+	}
+}
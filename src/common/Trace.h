@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <signal.h>
+
+#include "clanlib/core/system.h"
+#include "clanlib/core/text.h"
+
+/**
+ * Timeline tracing of scoped events in the Chrome trace event format.
+ * Dumped file can be opened in chrome://tracing or in Perfetto UI.
+ * <p>
+ * Each thread writes its events to its own ring buffer, so recording
+ * an event takes no lock. When tracing is not started, G_TRACE() costs
+ * only a flag check.
+ */
+class Trace
+{
+	public:
+
+		/** Starts collecting events. They will be written to p_fileName. */
+		static void start(const CL_String &p_fileName);
+
+		static bool isEnabled() { return s_enabled; }
+
+		/** Sets name of the calling thread shown in the trace */
+		static void setThreadName(const char *p_name);
+
+		/** Records finished event of the calling thread */
+		static void record(const char *p_name, cl_ubyte64 p_startUs, cl_ubyte64 p_endUs);
+
+		/** Writes all collected events to the trace file. */
+		static void dump();
+
+		/** Asks for a dump. Safe to call from a signal handler. */
+		static void requestDump() { s_dumpRequested = 1; }
+
+		/** Writes the dump if it has been requested. */
+		static void dumpIfRequested();
+
+	private:
+
+		static volatile bool s_enabled;
+
+		static volatile sig_atomic_t s_dumpRequested;
+
+		Trace() {}
+};
+
+/** Records an event lasting from construction to the end of scope. */
+class TraceScope
+{
+	public:
+
+		explicit TraceScope(const char *p_name) :
+			m_name(p_name),
+			m_startUs(Trace::isEnabled() ? CL_System::get_microseconds() : 0)
+		{}
+
+		~TraceScope() {
+			if (m_startUs != 0) {
+				Trace::record(m_name, m_startUs, CL_System::get_microseconds());
+			}
+		}
+
+	private:
+
+		const char *const m_name;
+
+		const cl_ubyte64 m_startUs;
+};
+
+#define G_TRACE_JOIN_IMPL(a, b) a##b
+#define G_TRACE_JOIN(a, b) G_TRACE_JOIN_IMPL(a, b)
+
+/** Traces enclosing scope. Name must be a string literal. */
+#define G_TRACE(p_name) \
+	TraceScope G_TRACE_JOIN(traceScope, __LINE__)(p_name)
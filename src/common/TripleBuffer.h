@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/system.h"
+
+/**
+ * Passes values from one writer thread to one reader thread
+ * without locking.
+ * <p>
+ * Writer fills the back buffer and publishes it. Reader always gets
+ * the newest published value. Each side owns its buffer, so none of
+ * them waits for the other and buffers are never reallocated.
+ */
+template <typename T>
+class TripleBuffer
+{
+	public:
+
+		TripleBuffer() :
+			m_back(0),
+			m_front(1)
+		{
+			m_middle.set(2);
+		}
+
+		/** @return Buffer to fill by the writer */
+		T &getBack() {
+			return m_buffers[m_back];
+		}
+
+		/** Makes back buffer visible to the reader. */
+		void publish() {
+			m_back = exchange(m_back | FRESH) & INDEX_MASK;
+		}
+
+		/**
+		 * Takes newest published value. When nothing new has been
+		 * published then the previous value is returned.
+		 */
+		const T &read() {
+			if (m_middle.get() & FRESH) {
+				m_front = exchange(m_front) & INDEX_MASK;
+			}
+
+			return m_buffers[m_front];
+		}
+
+		/** @return True when there is value not read yet */
+		bool hasFresh() const {
+			return (m_middle.get() & FRESH) != 0;
+		}
+
+	private:
+
+		static const int INDEX_MASK = 3;
+
+		static const int FRESH = 4;
+
+		T m_buffers[3];
+
+		/** Writer's buffer index */
+		int m_back;
+
+		/** Reader's buffer index */
+		int m_front;
+
+		/** Buffer waiting for the reader and its fresh flag */
+		CL_InterlockedVariable m_middle;
+
+
+		int exchange(int p_value) {
+			int current;
+
+			do {
+				current = m_middle.get();
+			} while (!m_middle.compare_and_swap(current, p_value));
+
+			return current;
+		}
+};
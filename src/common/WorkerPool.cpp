@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "WorkerPool.h"
+
+#include <deque>
+#include <vector>
+
+#include "common.h"
+#include "common/Trace.h"
+
+class WorkerPoolImpl : public CL_Runnable
+{
+	public:
+
+		CL_Mutex m_mutex;
+
+		std::deque<CL_SharedPtr<WorkerJob> > m_jobs;
+
+		/** Wakes one waiting worker */
+		CL_Event m_eventJobQueued;
+
+		/** Wakes all workers to finish */
+		CL_Event m_eventStopped;
+
+		/** CL_Thread copies share one thread, so each is allocated separately */
+		std::vector<CL_SharedPtr<CL_Thread> > m_threads;
+
+
+		WorkerPoolImpl() :
+			m_eventJobQueued(false),
+			m_eventStopped(true)
+		{ /* empty */ }
+
+		virtual void run();
+};
+
+WorkerPool::WorkerPool(int p_threadCount) :
+	m_impl(new WorkerPoolImpl())
+{
+	G_ASSERT(p_threadCount > 0);
+
+	for (int i = 0; i < p_threadCount; ++i) {
+		CL_SharedPtr<CL_Thread> thread(new CL_Thread());
+		thread->start(m_impl.get());
+
+		m_impl->m_threads.push_back(thread);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	m_impl->m_eventStopped.set();
+
+	for (unsigned i = 0; i < m_impl->m_threads.size(); ++i) {
+		m_impl->m_threads[i]->join();
+	}
+}
+
+void WorkerPool::submit(const CL_SharedPtr<WorkerJob> &p_job)
+{
+	CL_MutexSection lock(&m_impl->m_mutex);
+
+	m_impl->m_jobs.push_back(p_job);
+	m_impl->m_eventJobQueued.set();
+}
+
+int WorkerPool::getThreadCount() const
+{
+	return static_cast<int>(m_impl->m_threads.size());
+}
+
+void WorkerPoolImpl::run()
+{
+	Trace::setThreadName("worker");
+
+	// 0 is the job event, stop event ends the loop
+	while (CL_Event::wait(m_eventJobQueued, m_eventStopped) == 0) {
+
+		CL_SharedPtr<WorkerJob> job;
+
+		{
+			CL_MutexSection lock(&m_mutex);
+
+			if (m_jobs.empty()) {
+				continue;
+			}
+
+			job = m_jobs.front();
+			m_jobs.pop_front();
+
+			// event resets after waking one worker, wake next one
+			if (!m_jobs.empty()) {
+				m_eventJobQueued.set();
+			}
+		}
+
+		job->run();
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/system.h"
+
+class WorkerPoolImpl;
+
+/** Work done by WorkerPool threads */
+class WorkerJob
+{
+	public:
+
+		virtual ~WorkerJob() {}
+
+		/** Runs on one of worker threads */
+		virtual void run() = 0;
+};
+
+/**
+ * Fixed number of threads running submitted jobs in order of
+ * submission. Jobs may run in parallel, so jobs that depend on each
+ * other must not be submitted together.
+ */
+class WorkerPool
+{
+	public:
+
+		explicit WorkerPool(int p_threadCount);
+
+		/** Waits for running jobs, queued ones are dropped */
+		virtual ~WorkerPool();
+
+
+		/** Queues p_job, thread safe */
+		void submit(const CL_SharedPtr<WorkerJob> &p_job);
+
+		int getThreadCount() const;
+
+	private:
+
+		CL_SharedPtr<WorkerPoolImpl> m_impl;
+};
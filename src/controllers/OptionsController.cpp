@@ -64,6 +64,7 @@ void OptionController::onOkClicked()
 	Properties::set(CG_SOUND_VOLUME, m_scene->getSound());
 	Properties::set(CG_PLAYER_NAME, m_scene->getPlayersName());
 	Properties::set(CG_USE_WASD, m_scene->getWASD());
+	Properties::set(CG_MOTION_BLUR, m_scene->getMotionBlur());
 
 	Gfx::Stage::popScene();
 };
@@ -35,6 +35,7 @@
 #include "common/gassert.h"
 #include "controllers/ConnectController.h"
 #include "network/events.h"
+#include "network/PacketRegistry.h"
 #include "gfx/Stage.h"
 #include "gfx/scenes/ConnectScene.h"
 #include "gfx/scenes/PlayOnlineScene.h"
@@ -82,6 +83,8 @@ class ServerInterviewer : public CL_Runnable
 		int m_playerLimit;
 		int m_ping;
 
+		Net::PacketRegistry m_registry;
+
 		void onEventReceived(const CL_NetGameEvent &p_event);
 
 		bool isTimeout() const;
@@ -129,27 +132,36 @@ void ServerInterviewer::run()
 
 void ServerInterviewer::onEventReceived(const CL_NetGameEvent &p_event)
 {
-	if (p_event.get_name() == EVENT_GAME_MODE) {
-		Net::GameMode gamemode;
-		gamemode.parseEvent(p_event);
-		m_gameMode = gamemode.getGameModeType();
-		m_waitingGameMode = false;
+	switch (m_registry.decode(p_event)) {
+		case Net::OP_GAME_MODE: {
+			Net::GameMode gamemode;
+			gamemode.parseEvent(p_event);
+			m_gameMode = gamemode.getGameModeType();
+			m_waitingGameMode = false;
+			break;
+		}
+
+		case Net::OP_INFO_RESPONSE: {
+			m_succeed = true;
 
-	} else if (p_event.get_name() == EVENT_INFO_RESPONSE) {
-		m_succeed = true;
+			Net::ServerInfoResponse response;
+			response.parseEvent(p_event);
 
-		Net::ServerInfoResponse response;
-		response.parseEvent(p_event);
+			m_serverName = response.getServerName();
+			m_mapName = response.getMapName();
+			m_playerCount = response.getPlayerCount();
+			m_playerLimit = response.getPlayerLimit();
 
-		m_serverName = response.getServerName();
-		m_mapName = response.getMapName();
-		m_playerCount = response.getPlayerCount();
-		m_playerLimit = response.getPlayerLimit();
+			m_waitingResponse = false;
+			break;
+		}
 
-		m_waitingResponse = false;
+		case Net::OP_OPCODE_TABLE:
+			// interviewer never sends by opcode, so server doesn't either
+			break;
 
-	} else {
-		m_succeed = false;
+		default:
+			m_succeed = false;
 	}
 }
 
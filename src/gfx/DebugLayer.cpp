@@ -28,8 +28,62 @@
 
 #include "DebugLayer.h"
 
+#if defined(PROFILER)
+
+#include "clanlib/core/text.h"
+#include "clanlib/display/2d.h"
+
+#include "gfx/Stage.h"
+
+namespace {
+
+/** Profiler rows are reformatted every that many frames */
+const int PROFILER_REFRESH_FRAMES = 15;
+
+/** Width of the profiler panel at the right edge of the screen */
+const float PANEL_WIDTH = 420.0f;
+
+const float GRAPH_WIDTH = 240.0f;
+const float GRAPH_HEIGHT = 60.0f;
+
+/** Frame time at the top of the graph */
+const float GRAPH_MAX_US = 1000000.0f / 30.0f;
+
+/** Frame time budget at 60 fps */
+const float FRAME_BUDGET_US = 1000000.0f / 60.0f;
+
+const float PROFILER_MARGIN = 5.0f;
+const float PROFILER_INDENT = 12.0f;
+
+CL_String8 formatMs(unsigned p_us)
+{
+	const unsigned hundredths = (p_us + 5) / 10;
+	const unsigned fraction = hundredths % 100;
+
+	return
+			CL_StringHelp::uint_to_local8(hundredths / 100)
+			+ (fraction < 10 ? ".0" : ".")
+			+ CL_StringHelp::uint_to_local8(fraction);
+}
+
+CL_String8 formatStats(const Profiler::Stats &p_stats)
+{
+	return
+			formatMs(p_stats.m_lastUs) + "  min " + formatMs(p_stats.m_minUs)
+			+ "  avg " + formatMs(p_stats.m_avgUs)
+			+ "  p99 " + formatMs(p_stats.m_p99Us);
+}
+
+}
+
+#endif // PROFILER
+
 DebugLayer::DebugLayer() :
 	m_label(CL_Pointf(), "", Gfx::Label::F_REGULAR)
+#if defined(PROFILER)
+	, m_profilerRowCount(0),
+	m_profilerRefreshCountdown(0)
+#endif // PROFILER
 {
 }
 
@@ -54,6 +108,10 @@ void DebugLayer::draw(CL_GraphicContext &p_gc) {
 		m_label.draw(p_gc);
 		y += m_labelHeight;
 	}
+
+#if defined(PROFILER)
+	drawProfiler(p_gc);
+#endif // PROFILER
 }
 
 void DebugLayer::load(CL_GraphicContext &p_gc)
@@ -65,3 +123,158 @@ void DebugLayer::load(CL_GraphicContext &p_gc)
 
 	Drawable::load(p_gc);
 }
+
+#if defined(PROFILER)
+
+void DebugLayer::drawProfiler(CL_GraphicContext &p_gc)
+{
+	const Profiler &profiler = Profiler::getInstance();
+
+	if (profiler.getFrameCount() == 0) {
+		return;
+	}
+
+	if (m_profilerRefreshCountdown-- <= 0) {
+		refreshProfilerRows(p_gc);
+		m_profilerRefreshCountdown = PROFILER_REFRESH_FRAMES;
+	}
+
+	const float left = Gfx::Stage::getWidth() - PANEL_WIDTH - PROFILER_MARGIN;
+	const CL_Rectf graphRect(
+			left, PROFILER_MARGIN,
+			left + GRAPH_WIDTH, PROFILER_MARGIN + GRAPH_HEIGHT
+	);
+
+	drawFrameGraph(p_gc, graphRect);
+
+	for (int i = 0; i < m_profilerRowCount; ++i) {
+		m_profilerLabels[i]->draw(p_gc);
+	}
+}
+
+void DebugLayer::drawFrameGraph(CL_GraphicContext &p_gc, const CL_Rectf &p_rect)
+{
+	const Profiler &profiler = Profiler::getInstance();
+
+	CL_Draw::fill(p_gc, p_rect, CL_Colorf(0.0f, 0.0f, 0.0f, 0.5f));
+
+	// one vertical bar per frame, the newest on the right
+	const int frameCount = profiler.getFrameCount();
+	const float barWidth = p_rect.get_width() / Profiler::HISTORY_SIZE;
+
+	for (int age = 0; age < frameCount; ++age) {
+		const float frameUs = profiler.getFrameTime(age);
+		const float x = p_rect.right - (age + 0.5f) * barWidth;
+		const float height =
+				cl_min(frameUs / GRAPH_MAX_US, 1.0f) * p_rect.get_height();
+
+		CL_Vec4f color;
+
+		if (frameUs <= FRAME_BUDGET_US) {
+			color = CL_Vec4f(0.0f, 1.0f, 0.0f, 1.0f);
+		} else if (frameUs <= GRAPH_MAX_US) {
+			color = CL_Vec4f(1.0f, 1.0f, 0.0f, 1.0f);
+		} else {
+			color = CL_Vec4f(1.0f, 0.0f, 0.0f, 1.0f);
+		}
+
+		m_graphVerts[age * 2] = CL_Vec2f(x, p_rect.bottom);
+		m_graphVerts[age * 2 + 1] = CL_Vec2f(x, p_rect.bottom - height);
+		m_graphColors[age * 2] = color;
+		m_graphColors[age * 2 + 1] = color;
+	}
+
+	CL_PrimitivesArray priArr(p_gc);
+	priArr.set_attributes(0, m_graphVerts);
+	priArr.set_attributes(1, m_graphColors);
+
+	p_gc.set_program_object(cl_program_color_only);
+	p_gc.draw_primitives(cl_lines, frameCount * 2, priArr);
+	p_gc.reset_program_object();
+
+	// frame budget line
+	const float budgetY =
+			p_rect.bottom - (FRAME_BUDGET_US / GRAPH_MAX_US) * p_rect.get_height();
+
+	CL_Draw::line(
+			p_gc, p_rect.left, budgetY, p_rect.right, budgetY,
+			CL_Colorf(1.0f, 1.0f, 1.0f, 0.5f)
+	);
+}
+
+void DebugLayer::refreshProfilerRows(CL_GraphicContext &p_gc)
+{
+	const Profiler &profiler = Profiler::getInstance();
+	const Profiler::Stats frameStats = profiler.getFrameStats();
+
+	const unsigned fps =
+			frameStats.m_avgUs != 0 ? 1000000 / frameStats.m_avgUs : 0;
+
+	int row = 0;
+	setProfilerRow(
+			p_gc, row++, 0,
+			"frame  " + formatStats(frameStats)
+			+ "  (" + CL_StringHelp::uint_to_local8(fps) + " fps)"
+	);
+
+	addSectionRows(p_gc, -1, 0, row);
+
+	m_profilerRowCount = row;
+}
+
+void DebugLayer::addSectionRows(
+		CL_GraphicContext &p_gc,
+		int p_parent,
+		int p_depth,
+		int &p_row
+)
+{
+	const Profiler &profiler = Profiler::getInstance();
+	const int sectionCount = profiler.getSectionCount();
+
+	for (int i = 0; i < sectionCount; ++i) {
+		if (profiler.getSectionParent(i) != p_parent) {
+			continue;
+		}
+
+		setProfilerRow(
+				p_gc, p_row++, p_depth,
+				CL_String8(profiler.getSectionName(i)) + "  "
+				+ formatStats(profiler.getSectionStats(i))
+		);
+
+		addSectionRows(p_gc, i, p_depth + 1, p_row);
+	}
+}
+
+void DebugLayer::setProfilerRow(
+		CL_GraphicContext &p_gc,
+		int p_row,
+		int p_depth,
+		const CL_String8 &p_text
+)
+{
+	if (p_row == static_cast<signed>(m_profilerLabels.size())) {
+		CL_SharedPtr<Gfx::Label> label(
+				new Gfx::Label(CL_Pointf(), "", Gfx::Label::F_REGULAR, 12)
+		);
+
+		label->setAttachPoint(Gfx::Label::AP_LEFT | Gfx::Label::AP_TOP);
+		label->load(p_gc);
+
+		m_profilerLabels.push_back(label);
+	}
+
+	const CL_SharedPtr<Gfx::Label> &label = m_profilerLabels[p_row];
+
+	label->setText(p_text);
+	label->setPosition(
+			CL_Pointf(
+					Gfx::Stage::getWidth() - PANEL_WIDTH - PROFILER_MARGIN
+					+ p_depth * PROFILER_INDENT,
+					GRAPH_HEIGHT + PROFILER_MARGIN * 2 + p_row * m_labelHeight
+			)
+	);
+}
+
+#endif // PROFILER
@@ -28,8 +28,11 @@
 
 #pragma once
 
+#include <vector>
+
 #include "clanlib/display/render.h"
 
+#include "common/Profiler.h"
 #include "gfx/Drawable.h"
 #include "gfx/race/ui/Label.h"
 
@@ -63,5 +66,43 @@ class DebugLayer : public Gfx::Drawable {
 		Gfx::Label m_label;
 
 		int m_labelHeight;
+
+#if defined(PROFILER)
+
+		/** Frame time graph vertices, two per frame */
+		CL_Vec2f m_graphVerts[Profiler::HISTORY_SIZE * 2];
+		CL_Vec4f m_graphColors[Profiler::HISTORY_SIZE * 2];
+
+		/** Frame summary row followed by one row per section */
+		std::vector<CL_SharedPtr<Gfx::Label> > m_profilerLabels;
+
+		/** Number of rows in use */
+		int m_profilerRowCount;
+
+		/** Frames left to the next refresh of profiler rows */
+		int m_profilerRefreshCountdown;
+
+
+		void drawProfiler(CL_GraphicContext &p_gc);
+
+		void drawFrameGraph(CL_GraphicContext &p_gc, const CL_Rectf &p_rect);
+
+		void refreshProfilerRows(CL_GraphicContext &p_gc);
+
+		void addSectionRows(
+				CL_GraphicContext &p_gc,
+				int p_parent,
+				int p_depth,
+				int &p_row
+		);
+
+		void setProfilerRow(
+				CL_GraphicContext &p_gc,
+				int p_row,
+				int p_depth,
+				const CL_String8 &p_text
+		);
+
+#endif // PROFILER
 };
 
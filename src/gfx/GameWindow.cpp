@@ -31,6 +31,8 @@
 #include "clanlib/display/window.h"
 
 #include "common.h"
+#include "common/Profiler.h"
+#include "common/Trace.h"
 #include "gfx/Scene.h"
 #include "gfx/Stage.h"
 #include "common/Properties.h"
@@ -76,14 +78,32 @@ void GameWindow::repaint()
 
 bool GameWindow::update()
 {
+	G_PROFILE_FRAME();
+	G_TRACE("GameWindow::update");
+
+	// network and input events change the logic
+	Scene *lockedScene = Gfx::Stage::peekScene();
+	CL_Mutex *logicMutex =
+			lockedScene != NULL ? lockedScene->getLogicMutex() : NULL;
+
+	if (logicMutex) {
+		logicMutex->lock();
+	}
+
 	const int result = m_guiMgr->exec(false);
 
+	if (result != EXIT_CODE_QUIT) {
+		dispatchEvents();
+	}
+
+	if (logicMutex) {
+		logicMutex->unlock();
+	}
+
 	if (result == EXIT_CODE_QUIT) {
 		return false;
 	}
 
-	dispatchEvents();
-
 	Scene *scene = Gfx::Stage::peekScene();
 	updateLogic(scene);
 
@@ -92,6 +112,9 @@ bool GameWindow::update()
 
 void GameWindow::draw(CL_GraphicContext &p_gc)
 {
+	G_PROFILE("GameWindow::draw");
+	G_TRACE("GameWindow::draw");
+
 	Scene *scene = Gfx::Stage::peekScene();
 	renderScene(p_gc, scene);
 
@@ -101,6 +124,8 @@ void GameWindow::draw(CL_GraphicContext &p_gc)
 
 void GameWindow::updateLogic(Scene *p_scene)
 {
+	G_PROFILE("GameWindow::updateLogic");
+
 
 	static const float ITERATION_TIME_MS = 1000.0f / 60.0f;
 
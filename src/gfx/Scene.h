@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "clanlib/core/system.h"
 #include "clanlib/display/render.h"
 #include "clanlib/display/window.h"
 
@@ -78,6 +79,13 @@ class Scene {
 
 		virtual void update(unsigned p_timeElapsed) = 0;
 
+		/**
+		 * Mutex guarding the scene logic when it runs on other
+		 * thread, or NULL. It is held while gui and network
+		 * messages are processed.
+		 */
+		virtual CL_Mutex *getLogicMutex() { return NULL; }
+
 };
 
 } // namespace
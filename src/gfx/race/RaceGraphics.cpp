@@ -33,6 +33,8 @@
 #include "common.h"
 #include "common/Game.h"
 #include "common/Player.h"
+#include "common/Profiler.h"
+#include "common/Properties.h"
 #include "common/Units.h"
 #include "gfx/DebugLayer.h"
 #include "gfx/Stage.h"
@@ -42,15 +44,17 @@
 #include "gfx/race/level/DecorationSprite.h"
 #include "gfx/race/level/Level.h"
 #include "gfx/race/level/Sandpit.h"
-#include "gfx/race/level/Smoke.h"
+#include "gfx/race/level/SmokeSystem.h"
 #include "gfx/race/level/TyreStripes.h"
 #include "gfx/race/ui/RaceUI.h"
 #include "gfx/race/ui/SpeedMeter.h"
+#include "gfx/shaders/MotionBlurBatch.h"
 #include "gfx/shaders/MotionBlurShader.h"
 #include "logic/race/Block.h"
 #include "logic/race/level/Bound.h"
 #include "logic/race/Progress.h"
 #include "logic/race/GameLogic.h"
+#include "logic/race/RaceSnapshot.h"
 #include "logic/race/level/Checkpoint.h"
 
 namespace Gfx {
@@ -68,11 +72,19 @@ class RaceGraphicsImpl
 
 		CL_Pointf m_viewportPointHelper, m_viewportPoint;
 
+		/** One of CG_MOTION_BLUR_* values */
+		const int m_motionBlurMode;
+
 		MotionBlurShader m_motionBlurShader;
 
+		MotionBlurBatch m_motionBlurBatch;
+
 		/** Logic with data for reading only */
 		const Race::GameLogic *m_logic;
 
+		/** Race state to display */
+		const Race::RaceSnapshot *m_snapshot;
+
 		/** Level graphics */
 		Gfx::Level m_level;
 
@@ -98,8 +110,7 @@ class RaceGraphicsImpl
 		TyreStripes m_tyreStripes;
 
 		/** Car smoke clouds */
-		typedef std::list< CL_SharedPtr<Gfx::Smoke> > TSmokeList;
-		TSmokeList m_smokes;
+		SmokeSystem m_smokes;
 
 		/** Decorations */
 		typedef std::list< CL_SharedPtr<Gfx::DecorationSprite> > TDecorationList;
@@ -122,6 +133,7 @@ class RaceGraphicsImpl
 		void loadDecorations(CL_GraphicContext &p_gc);
 		void loadSandPits(CL_GraphicContext &p_gc);
 		void loadTyreStripes(CL_GraphicContext &p_gc);
+		void loadSmokes(CL_GraphicContext &p_gc);
 
 		// update routines
 		void updateViewport(unsigned p_timeElapsed);
@@ -138,7 +150,21 @@ class RaceGraphicsImpl
 		void drawTyreStripes(CL_GraphicContext &p_gc);
 		void drawUI(CL_GraphicContext &p_gc);
 		void drawCars(CL_GraphicContext &p_gc);
-		void drawCar(CL_GraphicContext &p_gc, const Race::Car &p_car);
+		void drawCar(CL_GraphicContext &p_gc, const Race::CarSnapshot &p_car);
+		void drawCarsBatched(CL_GraphicContext &p_gc);
+		void drawCarVectors(CL_GraphicContext &p_gc, const Race::CarSnapshot &p_car);
+
+		Gfx::Car *getCarGfx(CL_GraphicContext &p_gc, const Race::CarSnapshot &p_car);
+
+		/** Calculates motion blur of car relative to player's car */
+		void calculateBlur(
+				const Race::CarSnapshot &p_car,
+				int *p_radius,
+				CL_Angle *p_angle
+		);
+
+		/** Car screen area */
+		CL_Rect getCarRect(const Race::CarSnapshot &p_car);
 		void drawSmokes(CL_GraphicContext &p_gc);
 		void drawSandpits(CL_GraphicContext &p_gc);
 
@@ -155,10 +181,14 @@ RaceGraphicsImpl::RaceGraphicsImpl(RaceGraphics *p_parent, const Race::GameLogic
 		m_parent(p_parent),
 		m_loaded(false),
 		m_viewport(),
+		m_motionBlurMode(
+				Properties::getInt(CG_MOTION_BLUR, CG_MOTION_BLUR_BATCHED)
+		),
 		m_logic(p_logic),
+		m_snapshot(NULL),
 		m_level(&p_logic->getLevel(), &m_viewport),
 		m_raceUI(p_logic, &m_viewport),
-		m_tyreStripes(&p_logic->getLevel())
+		m_tyreStripes(&p_logic->getLevel(), &m_viewport)
 {
 	// attach viewport to player's car
 	Game &game = Game::getInstance();
@@ -176,7 +206,16 @@ RaceGraphics::~RaceGraphics()
 RaceGraphicsImpl::~RaceGraphicsImpl()
 {
 	if (m_loaded) {
-		m_motionBlurShader.destroy();
+		switch (m_motionBlurMode) {
+			case CG_MOTION_BLUR_PER_CAR:
+				m_motionBlurShader.destroy();
+				break;
+			case CG_MOTION_BLUR_BATCHED:
+				m_motionBlurBatch.destroy();
+				break;
+			default:
+				break;
+		}
 	}
 }
 
@@ -187,6 +226,8 @@ void RaceGraphics::draw(CL_GraphicContext &p_gc)
 
 void RaceGraphicsImpl::draw(CL_GraphicContext &p_gc)
 {
+	G_PROFILE("RaceGraphics::draw");
+
 	G_ASSERT(m_loaded);
 
 	// clear the background
@@ -226,9 +267,11 @@ void RaceGraphicsImpl::draw(CL_GraphicContext &p_gc)
 
 #ifndef NDEBUG
 	Gfx::Stage::getDebugLayer()->putMessage("fps", CL_StringHelp::int_to_local8(m_fps));
+#endif // NDEBUG
 
+#if !defined(NDEBUG) || defined(PROFILER)
 	Gfx::Stage::getDebugLayer()->draw(p_gc);
-#endif // NDEBUG
+#endif // !NDEBUG || PROFILER
 }
 
 void RaceGraphics::load(CL_GraphicContext &p_gc)
@@ -240,10 +283,20 @@ void RaceGraphicsImpl::load(CL_GraphicContext &p_gc)
 {
 	m_raceUI.load(p_gc);
 	loadTyreStripes(p_gc);
+	loadSmokes(p_gc);
 	loadDecorations(p_gc);
 	loadSandPits(p_gc);
 
-	m_motionBlurShader.initialize(p_gc);
+	switch (m_motionBlurMode) {
+		case CG_MOTION_BLUR_PER_CAR:
+			m_motionBlurShader.initialize(p_gc);
+			break;
+		case CG_MOTION_BLUR_BATCHED:
+			m_motionBlurBatch.initialize(p_gc);
+			break;
+		default:
+			break;
+	}
 
 	m_loaded = true;
 }
@@ -294,6 +347,11 @@ void RaceGraphicsImpl::loadTyreStripes(CL_GraphicContext &p_gc)
 	m_tyreStripes.load(p_gc);
 }
 
+void RaceGraphicsImpl::loadSmokes(CL_GraphicContext &p_gc)
+{
+	m_smokes.load(p_gc);
+}
+
 void RaceGraphicsImpl::drawSandpits(CL_GraphicContext &p_gc)
 {
 	foreach (CL_SharedPtr<Gfx::Sandpit> &sandpit, m_sandpits) {
@@ -303,27 +361,31 @@ void RaceGraphicsImpl::drawSandpits(CL_GraphicContext &p_gc)
 
 void RaceGraphicsImpl::drawSmokes(CL_GraphicContext &p_gc)
 {
-#if !defined(NO_SMOKES)
-	foreach(CL_SharedPtr<Gfx::Smoke> &smoke, m_smokes) {
-		if (!smoke->isLoaded()) {
-			smoke->load(p_gc);
-		}
+	G_PROFILE("smokes draw");
 
-		smoke->draw(p_gc);
-	}
+#if !defined(NO_SMOKES)
+	m_smokes.draw(p_gc);
 #endif // !NO_SMOKES
 }
 
 void RaceGraphicsImpl::drawUI(CL_GraphicContext &p_gc)
 {
-	Gfx::SpeedMeter &speedMeter = m_raceUI.getSpeedMeter();
-	speedMeter.setSpeed(Game::getInstance().getPlayer().getCar().getSpeedKMS());
+	G_PROFILE("RaceUI::draw");
+
+	const Race::CarSnapshot *playerCar = m_snapshot->getPlayerCar();
+
+	if (playerCar != NULL) {
+		Gfx::SpeedMeter &speedMeter = m_raceUI.getSpeedMeter();
+		speedMeter.setSpeed(playerCar->m_speedKMS);
+	}
 
 	m_raceUI.draw(p_gc);
 }
 
 void RaceGraphicsImpl::drawTyreStripes(CL_GraphicContext &p_gc)
 {
+	G_PROFILE("TyreStripes::draw");
+
 	m_tyreStripes.draw(p_gc);
 }
 
@@ -432,72 +494,155 @@ void RaceGraphicsImpl::drawForeBlocks(CL_GraphicContext &p_gc)
 
 void RaceGraphicsImpl::drawCars(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
-	size_t carCount = level.getCarCount();
+	G_PROFILE("cars draw");
+
+	if (m_motionBlurMode == CG_MOTION_BLUR_BATCHED) {
+		drawCarsBatched(p_gc);
+		return;
+	}
 
-	for (size_t i = 0; i < carCount; ++i) {
-		const Race::Car &car = level.getCar(i);
+	foreach (const Race::CarSnapshot &car, m_snapshot->m_cars) {
 		drawCar(p_gc, car);
 	}
 }
 
-void RaceGraphicsImpl::drawCar(CL_GraphicContext &p_gc, const Race::Car &p_car)
+void RaceGraphicsImpl::drawCarsBatched(CL_GraphicContext &p_gc)
+{
+	const Race::CarSnapshot *playerCar = m_snapshot->getPlayerCar();
+
+	int blurRadius;
+	CL_Angle blurAngle;
+
+	// all other cars go to one layer and are blurred at once
+	m_motionBlurBatch.begin(p_gc);
+
+	foreach (const Race::CarSnapshot &car, m_snapshot->m_cars) {
+
+		if (&car == playerCar) {
+			continue;
+		}
+
+		Gfx::Car *carGfx = getCarGfx(p_gc, car);
+
+		if (carGfx == NULL) {
+			continue;
+		}
+
+		calculateBlur(car, &blurRadius, &blurAngle);
+
+		m_motionBlurBatch.beginObject(p_gc, getCarRect(car), blurRadius, blurAngle);
+		carGfx->draw(p_gc);
+		m_motionBlurBatch.endObject(p_gc);
+	}
+
+	m_motionBlurBatch.end(p_gc);
+
+	foreach (const Race::CarSnapshot &car, m_snapshot->m_cars) {
+		if (&car != playerCar) {
+			drawCarVectors(p_gc, car);
+		}
+	}
+
+	// player's car is always on top
+	if (playerCar != NULL) {
+		drawCar(p_gc, *playerCar);
+	}
+}
+
+Gfx::Car *RaceGraphicsImpl::getCarGfx(
+		CL_GraphicContext &p_gc,
+		const Race::CarSnapshot &p_car
+)
 {
-	TCarMapping::iterator itor = m_carGfxMapping.find(&p_car);
+	TCarMapping::iterator itor = m_carGfxMapping.find(p_car.m_car);
 	if (itor == m_carGfxMapping.end()) {
-		return;
+		return NULL;
 	}
 
-	Gfx::Car &carGfx = *m_carGfxMapping[&p_car];
+	Gfx::Car &carGfx = *itor->second;
 
 	if (!carGfx.isLoaded()) {
 		carGfx.load(p_gc);
 	}
 
-	// draw motion blur shader if car is not player car
+	return &carGfx;
+}
 
-	Game &game = Game::getInstance();
-	Race::Car &playerCar = game.getPlayerCar();
+void RaceGraphicsImpl::calculateBlur(
+		const Race::CarSnapshot &p_car,
+		int *p_radius,
+		CL_Angle *p_angle
+)
+{
+	const Race::CarSnapshot *playerCar = m_snapshot->getPlayerCar();
 
-	if (p_car != playerCar) {
+	const CL_Vec2f playerVec =
+			playerCar != NULL ? playerCar->m_moveVector : CL_Vec2f();
+	const CL_Vec2f &otherVec = p_car.m_moveVector;
 
-		const CL_Vec2f &playerVec = playerCar.getPhyMoveVector();
-		const CL_Vec2f &otherVec = p_car.getPhyMoveVector();
+	const CL_Vec2f deltaVec = otherVec - playerVec;
+	CL_Angle blurAngle = deltaVec.angle(CL_Vec2f(1, 0));
 
-		const CL_Vec2f deltaVec = otherVec - playerVec;
-		CL_Angle blurAngle = deltaVec.angle(CL_Vec2f(1, 0));
+	if (deltaVec.y < 0) {
+		blurAngle.set_radians(blurAngle.to_radians());
+	}
 
-		if (deltaVec.y < 0) {
-			blurAngle.set_radians(blurAngle.to_radians());
-		}
+	*p_radius = static_cast<int>(deltaVec.length() / 1.5f);
+	*p_angle = blurAngle;
+}
+
+CL_Rect RaceGraphicsImpl::getCarRect(const Race::CarSnapshot &p_car)
+{
+	const CL_Pointf pos = m_viewport.toScreen(p_car.m_position);
+	return CL_Rect(pos.x - 50, pos.y - 50, pos.x + 50, pos.y + 50);
+}
+
+void RaceGraphicsImpl::drawCar(CL_GraphicContext &p_gc, const Race::CarSnapshot &p_car)
+{
+	Gfx::Car *carGfx = getCarGfx(p_gc, p_car);
+
+	if (carGfx == NULL) {
+		return;
+	}
+
+	// draw motion blur shader if car is not player car
+
+	const bool blur =
+			m_motionBlurMode == CG_MOTION_BLUR_PER_CAR
+			&& &p_car != m_snapshot->getPlayerCar();
+
+	if (blur) {
+		int blurRadius;
+		CL_Angle blurAngle;
 
-		const float blurRadius = deltaVec.length() / 1.5f;
+		calculateBlur(p_car, &blurRadius, &blurAngle);
 
 		m_motionBlurShader.setRadius(blurRadius);
 		m_motionBlurShader.setAngle(blurAngle);
-
-		const CL_Pointf pos = m_viewport.toScreen(p_car.getPosition());
-		CL_Rect rect(pos.x - 50, pos.y - 50, pos.x + 50, pos.y + 50);
-		m_motionBlurShader.setBoundRect(rect);
+		m_motionBlurShader.setBoundRect(getCarRect(p_car));
 
 		m_motionBlurShader.begin(p_gc);
 	}
 
-	carGfx.draw(p_gc);
+	carGfx->draw(p_gc);
 
-	if (p_car != playerCar) {
+	if (blur) {
 		m_motionBlurShader.end(p_gc);
 	}
 
+	drawCarVectors(p_gc, p_car);
+}
+
+void RaceGraphicsImpl::drawCarVectors(CL_GraphicContext &p_gc, const Race::CarSnapshot &p_car)
+{
 	#if defined(DRAW_CAR_VECTORS) && !defined(NDEBUG)
-		const CL_Pointf &pos = p_car.getPosition();
+		const CL_Pointf &pos = p_car.m_position;
 		p_gc.push_translate(pos.x, pos.y);
 		
 		CL_Draw::line(p_gc, 0, 0, p_car.m_moveVector.x/10, p_car.m_moveVector.y/10, CL_Colorf::red);
 		
 		p_gc.pop_modelview();
 	#endif // DRAW_CAR_VECTORS && !NDEBUG
-	
 }
 
 void RaceGraphicsImpl::countFps()
@@ -518,9 +663,23 @@ void RaceGraphics::update(unsigned p_timeElapsed)
 	m_impl->update(p_timeElapsed);
 }
 
+void RaceGraphics::setSnapshot(const Race::RaceSnapshot *p_snapshot)
+{
+	m_impl->m_snapshot = p_snapshot;
+	m_impl->m_raceUI.setSnapshot(p_snapshot);
+}
+
+void RaceGraphics::setLogicMutex(CL_Mutex *p_mutex)
+{
+	m_impl->m_raceUI.setLogicMutex(p_mutex);
+}
+
 void RaceGraphicsImpl::update(unsigned p_timeElapsed)
 {
+	G_PROFILE("RaceGraphics::update");
+
 	G_ASSERT(m_loaded);
+	G_ASSERT(m_snapshot != NULL);
 
 	updateViewport(p_timeElapsed);
 	updateTyreStripes();
@@ -531,7 +690,10 @@ void RaceGraphicsImpl::update(unsigned p_timeElapsed)
 	m_raceUI.update(p_timeElapsed);
 
 #if !defined(NDEBUG)
-	const CL_Pointf &carPos = Game::getInstance().getPlayer().getCar().getPosition();
+	const Race::CarSnapshot *playerCar = m_snapshot->getPlayerCar();
+	const CL_Pointf carPos =
+			playerCar != NULL ? playerCar->m_position : CL_Pointf();
+
 	Gfx::Stage::getDebugLayer()->putMessage("car x",  cl_format("%1", carPos.x));
 	Gfx::Stage::getDebugLayer()->putMessage("car y",  cl_format("%1", carPos.y));
 
@@ -553,7 +715,13 @@ void RaceGraphicsImpl::updateViewport(unsigned p_timeElapsed)
 	static const float MAX_SCALE = 1.0f;
 	static const float MAX_SPEED = 10.0f;
 
-	float speed = Game::getInstance().getPlayer().getCar().getSpeed();
+	const Race::CarSnapshot *playerCar = m_snapshot->getPlayerCar();
+
+	if (playerCar == NULL) {
+		return;
+	}
+
+	float speed = playerCar->m_speed;
 
 	if (speed > MAX_SPEED) {
 		speed = MAX_SPEED;
@@ -572,10 +740,7 @@ void RaceGraphicsImpl::updateViewport(unsigned p_timeElapsed)
 
 	static const float MAX_VIEW_DELTA = 30.0f;
 
-	Game &game = Game::getInstance();
-	Player &player = game.getPlayer();
-
-	const CL_Pointf &carPosition = player.getCar().getPosition();
+	const CL_Pointf &carPosition = playerCar->m_position;
 	CL_Pointf deltaPoint = carPosition - m_viewportPointHelper;
 
 	const float deltaRatio = deltaPoint.length() / MAX_VIEW_DELTA;
@@ -592,54 +757,42 @@ void RaceGraphicsImpl::updateViewport(unsigned p_timeElapsed)
 
 void RaceGraphicsImpl::updateTyreStripes()
 {
-	m_tyreStripes.update();
+	G_PROFILE("TyreStripes::update");
+
+	m_tyreStripes.update(*m_snapshot);
 }
 
 void RaceGraphicsImpl::updateSmokes(unsigned p_timeElapsed)
 {
-	// remove finished smokes and update the ongoing
-	TSmokeList::iterator itor = m_smokes.begin();
+	G_PROFILE("smokes update");
 
-	while (itor != m_smokes.end()) {
-		if ((*itor)->isFinished()) {
-			m_smokes.erase(itor++);
-		} else {
-			(*itor)->update(p_timeElapsed);
-			++itor;
-		}
-	}
+	// remove finished smokes and update the ongoing
+	m_smokes.update(p_timeElapsed);
 
 	static const unsigned SMOKE_PERIOD = 25;
 	static const int RAND_LIMIT = 20;
 
 	// if car is drifting then add new smokes
-	const Race::Level &level = m_logic->getLevel();
-	const int carCount = level.getCarCount();
-
-	for (int i = 0; i < carCount; ++i) {
-		const Race::Car &car = level.getCar(i);
+	foreach (const Race::CarSnapshot &car, m_snapshot->m_cars) {
 
-		if (m_carSmokePeriod.find(&car) == m_carSmokePeriod.end()) {
-			m_carSmokePeriod[&car] = SMOKE_PERIOD;
+		if (m_carSmokePeriod.find(car.m_car) == m_carSmokePeriod.end()) {
+			m_carSmokePeriod[car.m_car] = SMOKE_PERIOD;
 		}
 
-		unsigned &timeFromLastSmoke = m_carSmokePeriod[&car];
+		unsigned &timeFromLastSmoke = m_carSmokePeriod[car.m_car];
 
 		timeFromLastSmoke += p_timeElapsed;
 
 		if (
-				(car.isDrifting() || car.isChoking())
+				(car.m_drifting || car.m_choking)
 				&& timeFromLastSmoke >= SMOKE_PERIOD
 			) {
 
-			CL_Pointf smokePosition = car.getPosition();
+			CL_Pointf smokePosition = car.m_position;
 			smokePosition.x += (rand() % (RAND_LIMIT * 2) - RAND_LIMIT);
 			smokePosition.y += (rand() % (RAND_LIMIT * 2) - RAND_LIMIT);
 
-			CL_SharedPtr<Gfx::Smoke> smoke(new Gfx::Smoke(smokePosition));
-			smoke->start();
-
-			m_smokes.push_back(smoke);
+			m_smokes.emit(smokePosition);
 
 			timeFromLastSmoke = 0;
 		}
@@ -658,21 +811,22 @@ void RaceGraphicsImpl::updateCarGfxs(unsigned p_timeElapsed)
 
 void RaceGraphicsImpl::updateCarGfxMapping()
 {
-	const Race::Level &level = m_logic->getLevel();
-	const int carCount = level.getCarCount();
-
 	TCarMapping newCarGfxMapping;
 	TCarMapping::iterator itor;
 
-	for (int i = 0; i < carCount; ++i) {
-		const Race::Car &car = level.getCar(i);
-		itor = m_carGfxMapping.find(&car);
+	foreach (const Race::CarSnapshot &car, m_snapshot->m_cars) {
+		itor = m_carGfxMapping.find(car.m_car);
+
+		CL_SharedPtr<Gfx::Car> carGfx;
 
 		if (itor != m_carGfxMapping.end()) {
-			newCarGfxMapping[&car] = itor->second;
+			carGfx = itor->second;
 		} else {
-			newCarGfxMapping[&car] = CL_SharedPtr<Gfx::Car>(new Gfx::Car(&car));
+			carGfx = CL_SharedPtr<Gfx::Car>(new Gfx::Car());
 		}
+
+		carGfx->setState(car);
+		newCarGfxMapping[car.m_car] = carGfx;
 	}
 
 	m_carGfxMapping = newCarGfxMapping;
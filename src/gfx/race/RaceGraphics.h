@@ -30,8 +30,11 @@
 
 #include "clanlib/display/render.h"
 
+class CL_Mutex;
+
 namespace Race {
 	class GameLogic;
+	class RaceSnapshot;
 }
 
 namespace Gfx {
@@ -51,6 +54,18 @@ class RaceGraphics {
 
 		void update(unsigned p_timeElapsed);
 
+		/**
+		 * Sets race state to display. Cars are read only from it,
+		 * so it must be set before first update.
+		 */
+		void setSnapshot(const Race::RaceSnapshot *p_snapshot);
+
+		/**
+		 * Sets mutex which guards the logic, when it runs on other
+		 * thread. Interface parts reading the logic will lock it.
+		 */
+		void setLogicMutex(CL_Mutex *p_mutex);
+
 		Gfx::RaceUI &getUi();
 
 	private:
@@ -33,7 +33,7 @@
 #include <assert.h>
 
 #include "gfx/Stage.h"
-#include "logic/race/Car.h"
+#include "logic/race/RaceSnapshot.h"
 #include "math/Float.h"
 
 namespace Gfx {
@@ -48,12 +48,15 @@ class CarImpl
 {
 	public:
 
-		const Race::Car *m_raceCar;
-
 		CL_Pointf m_position;
 
 		CL_Angle m_rotation;
 
+		/** Front wheels turn from -1 to 1 */
+		float m_phyWheelTurn;
+
+		float m_speed;
+
 
 		// body sprites
 		// low will be drawn before the wheels
@@ -67,14 +70,15 @@ class CarImpl
 		float m_wheelTurn;
 
 
-		CarImpl(const Race::Car *p_car) :
-			m_raceCar(p_car),
+		CarImpl() :
+			m_phyWheelTurn(0.0f),
+			m_speed(0.0f),
 			m_wheelTurn(0.0f)
 		{ /* empty */ }
 };
 
-Car::Car(const Race::Car *p_car) :
-	m_impl(new CarImpl(p_car))
+Car::Car() :
+	m_impl(new CarImpl())
 {
 	// empty
 }
@@ -134,7 +138,7 @@ void Car::draw(CL_GraphicContext &p_gc)
 
 	// set from wheels turn
 	const CL_Angle wheelTurnAngle(
-			-m_impl->m_raceCar->getPhyWheelTurn() * WHEEL_TURN_MAX,
+			-m_impl->m_phyWheelTurn * WHEEL_TURN_MAX,
 			cl_radians
 	);
 	m_impl->m_wheels[WHEEL_FL].set_base_angle(wheelTurnAngle);
@@ -144,8 +148,8 @@ void Car::draw(CL_GraphicContext &p_gc)
 	// start drawing
 	p_gc.push_modelview();
 
-	const CL_Pointf &pos = m_impl->m_raceCar->getPosition();
-	const CL_Angle &angle = m_impl->m_raceCar->getCorpseAngle();
+	const CL_Pointf &pos = m_impl->m_position;
+	const CL_Angle &angle = m_impl->m_rotation;
 
 	// put car in right position
 	p_gc.mult_translate(pos.x, pos.y);
@@ -174,7 +178,7 @@ void Car::update(unsigned p_timeElapsed)
 	// get the turn value
 	float turn = m_impl->m_wheelTurn;
 
-	turn += (p_timeElapsed / 1000.0f) * m_impl->m_raceCar->getSpeed();
+	turn += (p_timeElapsed / 1000.0f) * m_impl->m_speed;
 	turn = Math::Float::clamp(turn, 0.0f, WHEEL_TURN_DISTANCE);
 
 	// set the turn back
@@ -195,4 +199,12 @@ void Car::update(unsigned p_timeElapsed)
 	}
 }
 
+void Car::setState(const Race::CarSnapshot &p_state)
+{
+	m_impl->m_position = p_state.m_position;
+	m_impl->m_rotation = p_state.m_corpseAngle;
+	m_impl->m_phyWheelTurn = p_state.m_wheelTurn;
+	m_impl->m_speed = p_state.m_speed;
+}
+
 }
@@ -34,7 +34,7 @@
 #include "gfx/Drawable.h"
 
 namespace Race {
-class Car;
+class CarSnapshot;
 }
 
 namespace Gfx {
@@ -45,7 +45,7 @@ class Car : public Gfx::Drawable {
 
 	public:
 
-		Car(const Race::Car *p_car);
+		Car();
 
 		virtual ~Car();
 
@@ -55,6 +55,9 @@ class Car : public Gfx::Drawable {
 
 		void update(unsigned p_timeElapsed);
 
+		/** Takes car state to display */
+		void setState(const Race::CarSnapshot &p_state);
+
 	private:
 
 		CL_SharedPtr<CarImpl> m_impl;
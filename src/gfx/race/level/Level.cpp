@@ -27,11 +27,13 @@
  */
 
 #include "Level.h"
+#include "StaticSpriteLayer.h"
 
 #include "clanlib/display/2d.h"
 
 #include <vector>
 
+#include "common/Profiler.h"
 #include "common/Units.h"
 #include "gfx/Stage.h"
 #include "gfx/Viewport.h"
@@ -64,25 +66,6 @@ class LevelImpl
 			D_RIGHT
 		};
 
-		struct Crack {
-
-			/** Level position */
-			CL_Pointf m_position;
-
-			/** m_cracks index */
-			int m_crackId;
-
-			/** Crack scaling */
-			float m_scale;
-
-			Crack(const CL_Pointf &p_pos, int p_id, float p_scale) :
-				m_position(p_pos),
-				m_crackId(p_id),
-				m_scale(p_scale)
-			{ /* empty */ }
-		};
-
-
 		const Race::Level *m_levelLogic;
 
 		const Viewport *m_viewport;
@@ -128,11 +111,8 @@ class LevelImpl
 
 		// cracks in street
 
-		/** crack sprites in street */
-		CL_Sprite m_crackSprites[CRACKS_COUNT];
-
-		/** cracks collection to draw */
-		std::vector<Crack> m_crackPositions;
+		/** cracks batched in one atlas */
+		StaticSpriteLayer m_cracks;
 
 
 		// helpers to optimize drawing process
@@ -161,6 +141,7 @@ class LevelImpl
 				m_viewport(p_viewport),
 				m_triangulator(p_levelLogic->getTrackTriangulator()),
 				m_levelEditorMode(false),
+				m_cracks(p_viewport),
 				m_helperArr(NULL),
 				m_grassHelpArr(NULL)
 		{
@@ -251,6 +232,8 @@ Level::~Level()
 
 void Level::draw(CL_GraphicContext &p_gc)
 {
+	G_PROFILE("Level::draw");
+
 	m_impl->drawGrass(p_gc);
 	m_impl->drawTrack(p_gc);
 
@@ -591,41 +574,7 @@ void LevelImpl::drawQuad(
 
 void LevelImpl::drawCracks(CL_GraphicContext &p_gc)
 {
-	float x, y;
-
-	foreach (const Crack &crack, m_crackPositions) {
-
-		x = crack.m_position.x;
-		y = crack.m_position.y;
-
-		CL_Sprite &sprite = m_crackSprites[crack.m_crackId];
-		sprite.set_scale(crack.m_scale, crack.m_scale);
-
-		sprite.draw(p_gc, x, y);
-
-#if defined(DRAW_WIREFRAME)
-		CL_Pen pen;
-		CL_Pen oldPen = p_gc.get_pen();
-
-		pen.set_line_width(1.0f);
-		p_gc.set_pen(pen);
-
-		const int w2_ =
-				(m_crackSprites[crack.m_crackId].get_width() / 2)
-				* crack.m_scale;
-
-		const int h2_ =
-				m_crackSprites[crack.m_crackId].get_height() / 2
-				* crack.m_scale;
-
-
-		CL_Draw::box(
-				p_gc, x - w2_, y - h2_, x + w2_, y + h2_, CL_Colorf::violet
-		);
-
-		p_gc.set_pen(oldPen);
-#endif // DRAW_WIREFRAME
-	}
+	m_cracks.draw(p_gc);
 }
 
 void LevelImpl::drawStartLine(CL_GraphicContext &p_gc)
@@ -818,13 +767,11 @@ void LevelImpl::loadGrassTexture(CL_GraphicContext &p_gc)
 
 void LevelImpl::loadCracks(CL_GraphicContext &p_gc)
 {
+	int crackImages[CRACKS_COUNT];
+
 	for (int i = 0; i < CRACKS_COUNT; ++i) {
-		m_crackSprites[i] =
-				CL_Sprite(
-						p_gc,
-						cl_format("race/street_crack_%1", (i + 1)),
-						Stage::getResourceManager()
-				);
+		crackImages[i] =
+				m_cracks.addImage(cl_format("race/street_crack_%1", (i + 1)));
 	}
 
 
@@ -868,7 +815,7 @@ void LevelImpl::loadCracks(CL_GraphicContext &p_gc)
 						pair.m_left.distance(pair.m_right) / CRACK_SPRITE_RES;
 
 				cl_log_event(LOG_DEBUG, "scale = %1", scale);
-				m_crackPositions.push_back(Crack(pos, index, scale));
+				m_cracks.add(crackImages[index], pos, scale);
 
 				// add new next distance
 				next +=
@@ -881,6 +828,7 @@ void LevelImpl::loadCracks(CL_GraphicContext &p_gc)
 		}
 	}
 
+	m_cracks.load(p_gc);
 }
 
 Race::TrackTriangulator &Level::getTrackTriangulator()
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SmokeSystem.h"
+
+#include <stdlib.h>
+
+#include "clanlib/core/text.h"
+#include "clanlib/display/render.h"
+
+#include "common.h"
+#include "gfx/Stage.h"
+#include "math/Easing.h"
+
+namespace Gfx {
+
+/** Smoke textures count */
+const int SMOKE_KIND_COUNT = 3;
+
+/** Maximum puffs at once */
+const int SMOKE_POOL_SIZE = 4096;
+
+/** Puff life time in ms */
+const unsigned SMOKE_LIFE_TIME = 6000;
+
+class SmokeSystemImpl
+{
+	public:
+
+		// puffs data, first m_count entries are alive
+
+		float m_x[SMOKE_POOL_SIZE];
+
+		float m_y[SMOKE_POOL_SIZE];
+
+		unsigned m_age[SMOKE_POOL_SIZE];
+
+		unsigned char m_kind[SMOKE_POOL_SIZE];
+
+		int m_count;
+
+
+		// drawing data, one batch per texture
+
+		CL_Texture m_textures[SMOKE_KIND_COUNT];
+
+		/** Half of texture size */
+		CL_Vec2f m_halfSizes[SMOKE_KIND_COUNT];
+
+		CL_Vec2f *m_verts[SMOKE_KIND_COUNT];
+
+		CL_Vec4f *m_colors[SMOKE_KIND_COUNT];
+
+		CL_Vec2f *m_texCoords;
+
+		CL_PrimitivesArray m_priArrs[SMOKE_KIND_COUNT];
+
+
+		SmokeSystemImpl() :
+			m_count(0),
+			m_texCoords(new CL_Vec2f[SMOKE_POOL_SIZE * 4])
+		{
+			for (int k = 0; k < SMOKE_KIND_COUNT; ++k) {
+				m_verts[k] = new CL_Vec2f[SMOKE_POOL_SIZE * 4];
+				m_colors[k] = new CL_Vec4f[SMOKE_POOL_SIZE * 4];
+			}
+
+			for (int i = 0; i < SMOKE_POOL_SIZE * 4; i += 4) {
+				m_texCoords[i] = CL_Vec2f(0.0f, 0.0f);
+				m_texCoords[i + 1] = CL_Vec2f(0.0f, 1.0f);
+				m_texCoords[i + 2] = CL_Vec2f(1.0f, 1.0f);
+				m_texCoords[i + 3] = CL_Vec2f(1.0f, 0.0f);
+			}
+		}
+
+		~SmokeSystemImpl()
+		{
+			for (int k = 0; k < SMOKE_KIND_COUNT; ++k) {
+				delete[] m_colors[k];
+				delete[] m_verts[k];
+			}
+
+			delete[] m_texCoords;
+		}
+
+		/** Removes puff at p_idx by moving the last one in its place */
+		void remove(int p_idx);
+
+		static float alphaAt(unsigned p_age);
+
+		static float sizeAt(unsigned p_age);
+};
+
+SmokeSystem::SmokeSystem() :
+	m_impl(new SmokeSystemImpl())
+{
+	// empty
+}
+
+SmokeSystem::~SmokeSystem()
+{
+	// empty
+}
+
+void SmokeSystem::load(CL_GraphicContext &p_gc)
+{
+	Drawable::load(p_gc);
+
+	for (int k = 0; k < SMOKE_KIND_COUNT; ++k) {
+		CL_Texture &texture = m_impl->m_textures[k];
+
+		texture = CL_Texture(
+				cl_format("race/smoke%1", k + 1),
+				Stage::getResourceManager(),
+				p_gc
+		);
+
+		m_impl->m_halfSizes[k] =
+				CL_Vec2f(texture.get_width(), texture.get_height()) / 2.0f;
+
+		CL_PrimitivesArray &arr = m_impl->m_priArrs[k];
+
+		arr = CL_PrimitivesArray(p_gc);
+		arr.set_attributes(CL_PRIARR_VERTS, m_impl->m_verts[k]);
+		arr.set_attributes(CL_PRIARR_COLORS, m_impl->m_colors[k]);
+		arr.set_attributes(CL_PRIARR_TEXCOORDS, m_impl->m_texCoords);
+	}
+}
+
+void SmokeSystem::clear()
+{
+	m_impl->m_count = 0;
+}
+
+void SmokeSystem::emit(const CL_Pointf &p_position)
+{
+	if (m_impl->m_count == SMOKE_POOL_SIZE) {
+		return;
+	}
+
+	const int idx = m_impl->m_count++;
+
+	m_impl->m_x[idx] = p_position.x;
+	m_impl->m_y[idx] = p_position.y;
+	m_impl->m_age[idx] = 0;
+	m_impl->m_kind[idx] = rand() % SMOKE_KIND_COUNT;
+}
+
+void SmokeSystem::update(unsigned p_timeElapsed)
+{
+	int i = 0;
+
+	while (i < m_impl->m_count) {
+		m_impl->m_age[i] += p_timeElapsed;
+
+		if (m_impl->m_age[i] >= SMOKE_LIFE_TIME) {
+			// the moved puff needs to be checked too
+			m_impl->remove(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void SmokeSystemImpl::remove(int p_idx)
+{
+	const int last = --m_count;
+
+	m_x[p_idx] = m_x[last];
+	m_y[p_idx] = m_y[last];
+	m_age[p_idx] = m_age[last];
+	m_kind[p_idx] = m_kind[last];
+}
+
+float SmokeSystemImpl::alphaAt(unsigned p_age)
+{
+	static const unsigned FADE_IN_TIME = 250;
+	static const unsigned FADE_OUT_START = 500;
+
+	static const float START_ALPHA = 0.1f;
+	static const float MAX_ALPHA = 0.3f;
+
+	if (p_age < FADE_IN_TIME) {
+		return START_ALPHA
+				+ (MAX_ALPHA - START_ALPHA) * p_age / FADE_IN_TIME;
+	}
+
+	if (p_age < FADE_OUT_START) {
+		return MAX_ALPHA;
+	}
+
+	return MAX_ALPHA
+			* (SMOKE_LIFE_TIME - p_age)
+			/ (SMOKE_LIFE_TIME - FADE_OUT_START);
+}
+
+float SmokeSystemImpl::sizeAt(unsigned p_age)
+{
+	static const float START_SIZE = 0.1f;
+	static const float END_SIZE = 0.5f;
+
+	return Math::Easing::REGULAR_OUT.ease(
+			START_SIZE, END_SIZE,
+			p_age / static_cast<float>(SMOKE_LIFE_TIME)
+	);
+}
+
+void SmokeSystem::draw(CL_GraphicContext &p_gc)
+{
+	int counts[SMOKE_KIND_COUNT] = { 0 };
+
+	// build quads
+	for (int i = 0; i < m_impl->m_count; ++i) {
+		const int kind = m_impl->m_kind[i];
+		const int v = counts[kind] * 4;
+
+		const float size = SmokeSystemImpl::sizeAt(m_impl->m_age[i]);
+		const CL_Vec4f color(
+				1.0f, 1.0f, 1.0f, SmokeSystemImpl::alphaAt(m_impl->m_age[i])
+		);
+
+		const float hw = m_impl->m_halfSizes[kind].x * size;
+		const float hh = m_impl->m_halfSizes[kind].y * size;
+		const float x = m_impl->m_x[i];
+		const float y = m_impl->m_y[i];
+
+		CL_Vec2f *verts = m_impl->m_verts[kind] + v;
+		CL_Vec4f *colors = m_impl->m_colors[kind] + v;
+
+		verts[0] = CL_Vec2f(x - hw, y - hh);
+		verts[1] = CL_Vec2f(x - hw, y + hh);
+		verts[2] = CL_Vec2f(x + hw, y + hh);
+		verts[3] = CL_Vec2f(x + hw, y - hh);
+
+		colors[0] = color;
+		colors[1] = color;
+		colors[2] = color;
+		colors[3] = color;
+
+		++counts[kind];
+	}
+
+	// and draw them
+	p_gc.set_program_object(cl_program_single_texture);
+
+	for (int k = 0; k < SMOKE_KIND_COUNT; ++k) {
+		if (counts[k] > 0) {
+			p_gc.set_texture(0, m_impl->m_textures[k]);
+			p_gc.draw_primitives(cl_quads, counts[k] * 4, m_impl->m_priArrs[k]);
+		}
+	}
+
+	p_gc.reset_texture(0);
+	p_gc.set_program_object(cl_program_color_only);
+}
+
+} // namespace
@@ -28,47 +28,48 @@
 
 #pragma once
 
-#include "clanlib/display/2d.h"
+#include "clanlib/core/math.h"
+#include "clanlib/core/system.h"
 
-#include "gfx/Animation.h"
-
-#include "math/Float.h"
+#include "gfx/Drawable.h"
 
 namespace Gfx {
 
-class Smoke: public Gfx::Animation {
+class SmokeSystemImpl;
+
+/**
+ * Preallocated pool of smoke puffs. Puffs are kept as plain arrays,
+ * their alpha and size are computed from age and all puffs using the
+ * same texture are drawn with one call.
+ */
+class SmokeSystem : public Drawable {
 
 	public:
 
-		Smoke(const CL_Pointf &p_position);
+		SmokeSystem();
+
+		virtual ~SmokeSystem();
 
-		virtual ~Smoke();
 
 		virtual void draw(CL_GraphicContext &p_gc);
 
 		virtual void load(CL_GraphicContext &p_gc);
 
-		virtual void start();
 
-		virtual void update(unsigned p_timeElapsed);
+		/** Removes all puffs */
+		void clear();
 
-	private:
+		/**
+		 * Starts a new puff at given position. When pool is full
+		 * then nothing happens.
+		 */
+		void emit(const CL_Pointf &p_position);
 
-		// smoke sprites
-		static CL_Sprite m_smokeSprites[];
+		void update(unsigned p_timeElapsed);
 
-		/** Index of this smoke sprite */
-		int m_spriteIdx;
-
-		/** The position */
-		CL_Pointf m_position;
-
-		/** Smoke alpha animation float value */
-		Math::Float m_alpha;
+	private:
 
-		/** Smoke size animation float value */
-		Math::Float m_size;
+		CL_SharedPtr<SmokeSystemImpl> m_impl;
 };
 
-}
-
+} // namespace
@@ -0,0 +1,501 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StaticSpriteLayer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "clanlib/display/2d.h"
+#include "clanlib/display/render.h"
+
+#include "common.h"
+#include "gfx/Stage.h"
+#include "gfx/Viewport.h"
+
+namespace Gfx {
+
+/** Images keep their resolution in the atlas up to this size */
+const int MAX_ATLAS_CELL_SIZE = 512;
+
+/** Transparent border around each image, keeps mipmaps from bleeding */
+const int ATLAS_PADDING = 4;
+
+/** Atlas texture width */
+const int ATLAS_WIDTH = 2048;
+
+/** World size of one bucket */
+const float BUCKET_SIZE = 512.0f;
+
+const CL_Vec4f LAYER_COLOR(1.0f, 1.0f, 1.0f, 1.0f);
+
+class StaticSpriteLayerImpl
+{
+	public:
+
+		struct Image {
+
+			CL_String m_spriteName;
+
+			/** Size of the original sprite */
+			CL_Sizef m_size;
+
+			/** Atlas texture coordinates */
+			CL_Rectf m_texRect;
+
+			Image(const CL_String &p_spriteName) :
+				m_spriteName(p_spriteName)
+			{ /* empty */ }
+		};
+
+		struct Instance {
+
+			int m_imageId;
+
+			CL_Pointf m_position;
+
+			float m_scale;
+
+			int m_bucket;
+
+			Instance(int p_imageId, const CL_Pointf &p_position, float p_scale) :
+				m_imageId(p_imageId),
+				m_position(p_position),
+				m_scale(p_scale),
+				m_bucket(0)
+			{ /* empty */ }
+
+			bool operator<(const Instance &p_other) const {
+				return m_bucket < p_other.m_bucket;
+			}
+		};
+
+
+		const Viewport *m_viewport;
+
+		std::vector<Image> m_images;
+
+		std::vector<Instance> m_instances;
+
+		CL_Texture m_atlas;
+
+
+		// bucket grid
+
+		/** Top left corner of the grid */
+		CL_Pointf m_gridOrigin;
+
+		int m_gridCols, m_gridRows;
+
+		/** Index of first instance in each bucket, one extra at the end */
+		std::vector<int> m_bucketStart;
+
+		/** How far the image can reach outside of its bucket */
+		float m_maxExtent;
+
+
+		// quads of all instances sorted by bucket
+
+		std::vector<CL_Vec2f> m_verts;
+
+		std::vector<CL_Vec2f> m_texCoords;
+
+
+		// quads of visible instances
+
+		std::vector<CL_Vec2f> m_drawVerts;
+
+		std::vector<CL_Vec2f> m_drawTexCoords;
+
+		std::vector<CL_Vec4f> m_drawColors;
+
+		CL_PrimitivesArray m_drawArr;
+
+
+		StaticSpriteLayerImpl(const Viewport *p_viewport) :
+			m_viewport(p_viewport),
+			m_gridCols(0),
+			m_gridRows(0),
+			m_maxExtent(0.0f)
+		{ /* empty */ }
+
+
+		void buildAtlas(CL_GraphicContext &p_gc);
+
+		void buildGrid();
+
+		void buildQuads();
+
+		int toCol(float p_x) const;
+
+		int toRow(float p_y) const;
+};
+
+StaticSpriteLayer::StaticSpriteLayer(const Viewport *p_viewport) :
+	m_impl(new StaticSpriteLayerImpl(p_viewport))
+{
+	// empty
+}
+
+StaticSpriteLayer::~StaticSpriteLayer()
+{
+	// empty
+}
+
+int StaticSpriteLayer::addImage(const CL_String &p_spriteName)
+{
+	G_ASSERT(!isLoaded());
+
+	m_impl->m_images.push_back(StaticSpriteLayerImpl::Image(p_spriteName));
+	return static_cast<int>(m_impl->m_images.size()) - 1;
+}
+
+void StaticSpriteLayer::add(int p_imageId, const CL_Pointf &p_position, float p_scale)
+{
+	G_ASSERT(!isLoaded());
+	G_ASSERT(p_imageId >= 0 && p_imageId < static_cast<int>(m_impl->m_images.size()));
+
+	m_impl->m_instances.push_back(
+			StaticSpriteLayerImpl::Instance(p_imageId, p_position, p_scale)
+	);
+}
+
+int StaticSpriteLayer::getCount() const
+{
+	return static_cast<int>(m_impl->m_instances.size());
+}
+
+void StaticSpriteLayer::load(CL_GraphicContext &p_gc)
+{
+	Drawable::load(p_gc);
+
+	if (m_impl->m_images.empty()) {
+		return;
+	}
+
+	m_impl->buildAtlas(p_gc);
+	m_impl->buildGrid();
+	m_impl->buildQuads();
+
+	const int vertCount = static_cast<int>(m_impl->m_verts.size());
+
+	// never more than all of them will be drawn
+	m_impl->m_drawVerts.resize(vertCount);
+	m_impl->m_drawTexCoords.resize(vertCount);
+	m_impl->m_drawColors.resize(vertCount, LAYER_COLOR);
+
+	m_impl->m_drawArr = CL_PrimitivesArray(p_gc);
+
+	if (vertCount > 0) {
+		m_impl->m_drawArr.set_attributes(
+				CL_PRIARR_VERTS, &m_impl->m_drawVerts[0]
+		);
+		m_impl->m_drawArr.set_attributes(
+				CL_PRIARR_COLORS, &m_impl->m_drawColors[0]
+		);
+		m_impl->m_drawArr.set_attributes(
+				CL_PRIARR_TEXCOORDS, &m_impl->m_drawTexCoords[0]
+		);
+	}
+}
+
+void StaticSpriteLayerImpl::buildAtlas(CL_GraphicContext &p_gc)
+{
+	const int imageCount = static_cast<int>(m_images.size());
+
+	std::vector<CL_Sprite> sprites;
+	sprites.reserve(imageCount);
+
+	// cell of each image, placed in rows from top left
+	std::vector<CL_Rect> cells;
+	cells.reserve(imageCount);
+
+	int x = 0, y = 0, rowHeight = 0;
+
+	for (int i = 0; i < imageCount; ++i) {
+		Image &image = m_images[i];
+
+		sprites.push_back(
+				CL_Sprite(p_gc, image.m_spriteName, Stage::getResourceManager())
+		);
+
+		image.m_size = CL_Sizef(sprites[i].get_width(), sprites[i].get_height());
+
+		const float scale = std::min(
+				1.0f,
+				MAX_ATLAS_CELL_SIZE / std::max(image.m_size.width, image.m_size.height)
+		);
+
+		const int width = static_cast<int>(ceil(image.m_size.width * scale)) + 2 * ATLAS_PADDING;
+		const int height = static_cast<int>(ceil(image.m_size.height * scale)) + 2 * ATLAS_PADDING;
+
+		if (x + width > ATLAS_WIDTH) {
+			x = 0;
+			y += rowHeight;
+			rowHeight = 0;
+		}
+
+		cells.push_back(CL_Rect(x, y, x + width, y + height));
+
+		x += width;
+		rowHeight = std::max(rowHeight, height);
+	}
+
+	// keep power of two height
+	int atlasHeight = 1;
+	while (atlasHeight < y + rowHeight) {
+		atlasHeight *= 2;
+	}
+
+	m_atlas = CL_Texture(p_gc, ATLAS_WIDTH, atlasHeight);
+
+	// render every sprite into its cell
+	CL_FrameBuffer frameBuffer(p_gc);
+	frameBuffer.attach_color_buffer(0, m_atlas);
+	p_gc.set_frame_buffer(frameBuffer);
+
+	p_gc.clear(CL_Colorf::transparent);
+
+	p_gc.push_modelview();
+	p_gc.set_modelview(CL_Mat4f::identity());
+
+	for (int i = 0; i < imageCount; ++i) {
+		Image &image = m_images[i];
+
+		const CL_Rectf cell(
+				cells[i].left + ATLAS_PADDING, cells[i].top + ATLAS_PADDING,
+				cells[i].right - ATLAS_PADDING, cells[i].bottom - ATLAS_PADDING
+		);
+
+		sprites[i].set_scale(
+				cell.get_width() / image.m_size.width,
+				cell.get_height() / image.m_size.height
+		);
+
+		// sprites have centered origin
+		sprites[i].draw(
+				p_gc,
+				(cell.left + cell.right) / 2.0f,
+				(cell.top + cell.bottom) / 2.0f
+		);
+
+		image.m_texRect = CL_Rectf(
+				cell.left / ATLAS_WIDTH,
+				cell.top / atlasHeight,
+				cell.right / ATLAS_WIDTH,
+				cell.bottom / atlasHeight
+		);
+	}
+
+	p_gc.pop_modelview();
+
+	p_gc.reset_frame_buffer();
+	frameBuffer.detach_color_buffer(0, m_atlas);
+
+	// images are drawn much smaller when zoomed out, upload the
+	// rendered atlas again to have its mipmaps generated
+	CL_PixelBuffer pixels = m_atlas.get_pixeldata();
+
+	m_atlas.set_generate_mipmap(true);
+	m_atlas.set_image(pixels);
+
+	m_atlas.set_mag_filter(cl_filter_linear);
+	m_atlas.set_min_filter(cl_filter_linear_mipmap_linear);
+}
+
+int StaticSpriteLayerImpl::toCol(float p_x) const
+{
+	return static_cast<int>(floor((p_x - m_gridOrigin.x) / BUCKET_SIZE));
+}
+
+int StaticSpriteLayerImpl::toRow(float p_y) const
+{
+	return static_cast<int>(floor((p_y - m_gridOrigin.y) / BUCKET_SIZE));
+}
+
+void StaticSpriteLayerImpl::buildGrid()
+{
+	m_bucketStart.clear();
+	m_maxExtent = 0.0f;
+
+	if (m_instances.empty()) {
+		m_gridCols = m_gridRows = 0;
+		m_bucketStart.push_back(0);
+		return;
+	}
+
+	// grid bounds
+	CL_Pointf min = m_instances[0].m_position;
+	CL_Pointf max = min;
+
+	foreach (const Instance &instance, m_instances) {
+		min.x = std::min(min.x, instance.m_position.x);
+		min.y = std::min(min.y, instance.m_position.y);
+		max.x = std::max(max.x, instance.m_position.x);
+		max.y = std::max(max.y, instance.m_position.y);
+
+		const CL_Sizef &size = m_images[instance.m_imageId].m_size;
+
+		m_maxExtent = std::max(
+				m_maxExtent,
+				std::max(size.width, size.height) * instance.m_scale / 2.0f
+		);
+	}
+
+	m_gridOrigin = min;
+	m_gridCols = toCol(max.x) + 1;
+	m_gridRows = toRow(max.y) + 1;
+
+	// sort by bucket (row major)
+	foreach (Instance &instance, m_instances) {
+		instance.m_bucket =
+				toRow(instance.m_position.y) * m_gridCols
+				+ toCol(instance.m_position.x);
+	}
+
+	std::stable_sort(m_instances.begin(), m_instances.end());
+
+	// remember bucket ranges
+	const int bucketCount = m_gridCols * m_gridRows;
+	const int instanceCount = static_cast<int>(m_instances.size());
+
+	m_bucketStart.resize(bucketCount + 1);
+
+	int idx = 0;
+	for (int b = 0; b <= bucketCount; ++b) {
+		while (idx < instanceCount && m_instances[idx].m_bucket < b) {
+			++idx;
+		}
+
+		m_bucketStart[b] = idx;
+	}
+}
+
+void StaticSpriteLayerImpl::buildQuads()
+{
+	m_verts.clear();
+	m_texCoords.clear();
+
+	m_verts.reserve(m_instances.size() * 4);
+	m_texCoords.reserve(m_instances.size() * 4);
+
+	foreach (const Instance &instance, m_instances) {
+		const Image &image = m_images[instance.m_imageId];
+
+		const float hw = image.m_size.width * instance.m_scale / 2.0f;
+		const float hh = image.m_size.height * instance.m_scale / 2.0f;
+		const CL_Pointf &p = instance.m_position;
+		const CL_Rectf &tr = image.m_texRect;
+
+		m_verts.push_back(CL_Vec2f(p.x - hw, p.y - hh));
+		m_verts.push_back(CL_Vec2f(p.x - hw, p.y + hh));
+		m_verts.push_back(CL_Vec2f(p.x + hw, p.y + hh));
+		m_verts.push_back(CL_Vec2f(p.x + hw, p.y - hh));
+
+		m_texCoords.push_back(CL_Vec2f(tr.left, tr.top));
+		m_texCoords.push_back(CL_Vec2f(tr.left, tr.bottom));
+		m_texCoords.push_back(CL_Vec2f(tr.right, tr.bottom));
+		m_texCoords.push_back(CL_Vec2f(tr.right, tr.top));
+	}
+}
+
+void StaticSpriteLayer::draw(CL_GraphicContext &p_gc)
+{
+	G_ASSERT(isLoaded());
+
+	if (m_impl->m_instances.empty()) {
+		return;
+	}
+
+	// images can reach neighbour buckets
+	const CL_Rectf &worldClip = m_impl->m_viewport->getWorldClipRect();
+	const float extent = m_impl->m_maxExtent;
+
+	const CL_Rectf clip(
+			worldClip.left - extent, worldClip.top - extent,
+			worldClip.right + extent, worldClip.bottom + extent
+	);
+
+	const int c0 = std::max(m_impl->toCol(clip.left), 0);
+	const int c1 = std::min(m_impl->toCol(clip.right), m_impl->m_gridCols - 1);
+	const int r0 = std::max(m_impl->toRow(clip.top), 0);
+	const int r1 = std::min(m_impl->toRow(clip.bottom), m_impl->m_gridRows - 1);
+
+	if (c0 > c1 || r0 > r1) {
+		return;
+	}
+
+	// visible buckets of one row are next to each other
+	int count = 0;
+
+	for (int r = r0; r <= r1; ++r) {
+		const int rowBucket = r * m_impl->m_gridCols;
+		const int first = m_impl->m_bucketStart[rowBucket + c0] * 4;
+		const int last = m_impl->m_bucketStart[rowBucket + c1 + 1] * 4;
+		const int n = last - first;
+
+		if (n > 0) {
+			memcpy(
+					&m_impl->m_drawVerts[count], &m_impl->m_verts[first],
+					n * sizeof(CL_Vec2f)
+			);
+
+			memcpy(
+					&m_impl->m_drawTexCoords[count], &m_impl->m_texCoords[first],
+					n * sizeof(CL_Vec2f)
+			);
+
+			count += n;
+		}
+	}
+
+	if (count == 0) {
+		return;
+	}
+
+	p_gc.set_program_object(cl_program_single_texture);
+	p_gc.set_texture(0, m_impl->m_atlas);
+
+	p_gc.draw_primitives(cl_quads, count, m_impl->m_drawArr);
+
+	p_gc.reset_texture(0);
+	p_gc.set_program_object(cl_program_color_only);
+
+#if defined(DRAW_WIREFRAME)
+	for (int i = 0; i < count; i += 4) {
+		const CL_Vec2f &tl = m_impl->m_drawVerts[i];
+		const CL_Vec2f &br = m_impl->m_drawVerts[i + 2];
+
+		CL_Draw::box(p_gc, tl.x, tl.y, br.x, br.y, CL_Colorf::violet);
+	}
+#endif // DRAW_WIREFRAME
+}
+
+} // namespace
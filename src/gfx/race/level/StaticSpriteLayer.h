@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/math.h"
+#include "clanlib/core/system.h"
+
+#include "gfx/Drawable.h"
+
+namespace Gfx {
+
+class StaticSpriteLayerImpl;
+class Viewport;
+
+/**
+ * Lots of sprites that never move, like street cracks or decorations.
+ * <p>
+ * On load all sprite images are packed into one texture atlas and
+ * sprite instances are sorted into a grid of world buckets. Drawing
+ * collects only buckets visible in the viewport and sends them with
+ * a single call.
+ */
+class StaticSpriteLayer : public Drawable {
+
+	public:
+
+		StaticSpriteLayer(const Viewport *p_viewport);
+
+		virtual ~StaticSpriteLayer();
+
+
+		virtual void draw(CL_GraphicContext &p_gc);
+
+		virtual void load(CL_GraphicContext &p_gc);
+
+
+		/**
+		 * Registers sprite image. Must be called before load().
+		 *
+		 * @return Image id to use with add().
+		 */
+		int addImage(const CL_String &p_spriteName);
+
+		/**
+		 * Places image in the world. Must be called before load().
+		 *
+		 * @param p_imageId Id returned by addImage().
+		 * @param p_position Center of the image.
+		 * @param p_scale Image scale.
+		 */
+		void add(int p_imageId, const CL_Pointf &p_position, float p_scale);
+
+		/** @return Count of placed images */
+		int getCount() const;
+
+	private:
+
+		CL_SharedPtr<StaticSpriteLayerImpl> m_impl;
+};
+
+} // namespace
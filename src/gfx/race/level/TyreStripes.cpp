@@ -28,125 +28,112 @@
 
 #include "TyreStripes.h"
 
+#include <algorithm>
 #include <map>
-#include <list>
-#include <deque>
+#include <math.h>
+#include <vector>
 
 #include "clanlib/display/2d.h"
 #include "clanlib/core/text.h"
 
 #include "common.h"
+#include "gfx/Viewport.h"
 #include "logic/race/Car.h"
+#include "logic/race/RaceSnapshot.h"
 #include "logic/race/level/Level.h"
+#include "logic/race/level/Track.h"
+#include "logic/race/level/TrackPoint.h"
 #include "math/Float.h"
 
 namespace Gfx {
 
-const int IMMUTABLE_STRIPE_LIMIT = 256;
+/** How many wheels leave a stripe */
+const int WHEEL_COUNT = 4;
+
+/** Tile size in world units. Tile texture has one texel per unit. */
+const int TILE_SIZE = 512;
+
+/**
+ * Least tiles kept at once. Budget grows to cover the level, only marks
+ * far away from the track are dropped above it (least recently used first).
+ */
+const unsigned MIN_TILES = 32;
+
+/** Off track space around track bounds where stripes are still kept */
+const float BOUNDS_MARGIN = TILE_SIZE;
+
+/** Stripe line width */
+const float STRIPE_WIDTH = 3.0f;
 
 const CL_Colorf STRIPE_COLOR(0.0f, 0.0f, 0.0f, 0.15f);
 const CL_Vec4f STRIPE_COLOR_VEC(
 		STRIPE_COLOR.r, STRIPE_COLOR.g, STRIPE_COLOR.b, STRIPE_COLOR.a
 );
 
-class Stripe {
+const CL_Vec4f TILE_COLOR_VEC(1.0f, 1.0f, 1.0f, 1.0f);
+
+/** Stripe that is still growing behind a wheel */
+class StripeTail {
 
 	public:
 
 		/** Stipe from -> to points */
 		CL_Pointf m_from, m_to;
 
-		/** Owner to continue last stripe */
-		const Race::Car *m_owner;
-
-		/** If this stripe is still mutable?  */
-		bool m_mutable;
-
-		Stripe(const CL_Pointf &p_from, const CL_Pointf &p_to, const Race::Car *p_owner) :
-			m_from(p_from), m_to(p_to), m_owner(p_owner), m_mutable(true) {}
+		/** If this tail is in use */
+		bool m_open;
 
+		StripeTail() :
+			m_open(false) {}
 
 		float length() const { return m_from.distance(m_to); }
-
-		const CL_Pointf &getFromPoint() const { return m_from; }
-
-		const CL_Pointf &getToPoint() const { return m_to; }
-
 };
 
-// array of primitives for quicker drawing
-class StripeArr
-{
-	private:
-
-		/** Verticle array */
-		CL_Vec2f *const m_verticles;
+/** Per car stripes state */
+class CarStripes {
 
-		/** Color array */
-		CL_Vec4f *const m_colors;
+	public:
 
-		/** Compiled state */
-		bool m_compiled;
+		/** Car position when last drift update was done */
+		CL_Pointf m_lastDriftPoint;
 
-		/** Primitives array */
-		CL_PrimitivesArray *m_priArr;
+		/** If m_lastDriftPoint is valid */
+		bool m_drifting;
 
-		/** m_size * 2 */
-		const int m_size2;
+		/** Growing stripe of each wheel */
+		StripeTail m_tails[WHEEL_COUNT];
 
-		void compile(CL_GraphicContext &p_gc) {
-			G_ASSERT(!m_compiled);
+		/** Last update with this car in the snapshot */
+		unsigned m_lastUpdate;
 
-			m_priArr = new CL_PrimitivesArray(p_gc);
-			m_priArr->set_attributes(0, m_verticles);
-			m_priArr->set_attributes(1, m_colors);
+		CarStripes() :
+			m_drifting(false),
+			m_lastUpdate(0) {}
+};
 
-			m_compiled = true;
-		}
+/**
+ * Square piece of the world where finished stripes are rendered once
+ * and kept for the rest of the race.
+ */
+class StripeTile {
 
 	public:
 
-		/** Array size */
-		const int m_size;
-
-		StripeArr(int p_size) :
-			m_verticles(new CL_Vec2f[p_size * 2]),
-			m_colors(new CL_Vec4f[p_size * 2]),
-			m_size(p_size),
-			m_size2(p_size * 2),
-			m_compiled(false),
-			m_priArr(NULL)
-		{ /* empty */ }
-
-		~StripeArr() {
-			if (m_priArr) {
-				delete m_priArr;
-			}
-			delete[] m_colors;
-			delete[] m_verticles;
-		}
+		/** Texture with baked stripes */
+		CL_Texture m_texture;
 
-		void add(int p_idx, const Stripe &p_stripe) {
-			G_ASSERT(!m_compiled);
-			G_ASSERT(p_idx >= 0 && p_idx < m_size);
+		/** Stripes waiting for baking in tile coordinates */
+		std::vector<CL_Vec2f> m_pending;
 
-			const int idx2 = p_idx * 2;
+		/** If texture was cleared */
+		bool m_prepared;
 
-			m_verticles[idx2] = p_stripe.m_from;
-			m_verticles[idx2 + 1] = p_stripe.m_to;
+		/** Last draw or bake, decides which tile is dropped first */
+		unsigned m_lastUse;
 
-			m_colors[idx2] = STRIPE_COLOR_VEC;
-			m_colors[idx2 + 1] = STRIPE_COLOR_VEC;
-		}
-
-		void draw(CL_GraphicContext &p_gc) {
-			if (!m_compiled) {
-				compile(p_gc);
-			}
-
-			p_gc.set_program_object(cl_program_color_only);
-			p_gc.draw_primitives(cl_lines, m_size2, *m_priArr);
-		}
+		StripeTile() :
+			m_prepared(false),
+			m_lastUse(0) {}
 };
 
 
@@ -154,43 +141,120 @@ class TyreStripesImpl
 {
 	public:
 
-		typedef std::list<Stripe> TStripeList;
-		typedef std::deque<StripeArr*> TStripeArrList;
-		typedef std::map<const Race::Car*, CL_Pointf> TDriftPointMap;
+		typedef std::map<const Race::Car*, CarStripes> TCarStripesMap;
+		typedef std::pair<int, int> TTileKey;
+		typedef std::map<TTileKey, StripeTile*> TTileMap;
 
 		/** Level at what stripes are drawn */
 		const Race::Level *const m_level;
 
-		/** Stripes container. First stripe is the youngest one. */
-		TStripeList m_stripes;
+		/** Viewport to know which tiles are visible */
+		const Viewport *const m_viewport;
+
+		/** Per car stripes state */
+		TCarStripesMap m_carStripes;
+
+		/** Tiles with baked stripes. Allocated when first needed. */
+		TTileMap m_tiles;
+
+		/** Tiles which have pending stripes */
+		std::vector<StripeTile*> m_dirtyTiles;
+
+		/** Counts draws and updates, marks use of tiles and cars */
+		unsigned m_useCounter;
+
+		/** Tiles kept at once, sized from level bounds on load */
+		unsigned m_maxTiles;
+
+		/** Vertices of currently growing stripes */
+		std::vector<CL_Vec2f> m_tailVerts;
+
+		/** Colors of currently growing stripes */
+		std::vector<CL_Vec4f> m_tailColors;
+
+		/** Count of used m_tailVerts */
+		int m_tailVertCount;
+
+		/** Growing stripes primitives array */
+		CL_PrimitivesArray m_tailArr;
 
-		/** Stripe arrays containter */
-		TStripeArrList m_stripeArrays;
+		/** Frame buffer used for baking */
+		CL_FrameBuffer m_frameBuffer;
 
-		/** Immutable stripes count (for optimalization) */
-		int m_immutableStripeCnt;
+		/** Tile baking blend mode (alpha accumulates) */
+		CL_BlendMode m_bakeBlendMode;
 
-		/** Last drift point map */
-		TDriftPointMap m_lastDriftMap;
+		// tile drawing helper
 
+		CL_Vec2f m_tileVerts[4];
 
-		TyreStripesImpl(const Race::Level *p_level) :
+		CL_Vec4f m_tileColors[4];
+
+		CL_Vec2f m_tileTexCoords[4];
+
+		CL_PrimitivesArray m_tileArr;
+
+		/** Helper for pending stripe colors */
+		std::vector<CL_Vec4f> m_bakeColors;
+
+
+		TyreStripesImpl(const Race::Level *p_level, const Viewport *p_viewport) :
 			m_level(p_level),
-			m_immutableStripeCnt(0)
-		{ /* empty */ }
+			m_viewport(p_viewport),
+			m_useCounter(0),
+			m_maxTiles(MIN_TILES),
+			m_tailVertCount(0)
+		{
+			m_bakeBlendMode.set_blend_function(
+					cl_blend_src_alpha, cl_blend_one_minus_src_alpha,
+					cl_blend_one, cl_blend_one_minus_src_alpha
+			);
+
+			for (int i = 0; i < 4; ++i) {
+				m_tileColors[i] = TILE_COLOR_VEC;
+			}
+
+			m_tileTexCoords[0] = CL_Vec2f(0.0f, 0.0f);
+			m_tileTexCoords[1] = CL_Vec2f(0.0f, 1.0f);
+			m_tileTexCoords[2] = CL_Vec2f(1.0f, 1.0f);
+			m_tileTexCoords[3] = CL_Vec2f(1.0f, 0.0f);
+		}
 
 		~TyreStripesImpl() {
 			clear();
 		}
 
 		void add(
+				StripeTail &p_tail,
 				const CL_Pointf &p_from,
-				const CL_Pointf &p_to,
-				const Race::Car *p_owner
+				const CL_Pointf &p_to
+		);
+
+		void add4WheelStripe(
+				const Race::CarSnapshot &p_car,
+				CarStripes &p_stripes,
+				const CL_Pointf &p_from
 		);
 
-		void add4WheelStripe(const Race::Car &p_car, const CL_Pointf &p_from);
+		/** Queues finished stripe for baking */
+		void bake(const CL_Pointf &p_from, const CL_Pointf &p_to);
 
+		/** Sets m_maxTiles to cover whole level */
+		void computeTileBudget();
+
+		/** Drops the least recently used tile */
+		void dropOldestTile();
+
+		/** Renders pending stripes into tile textures */
+		void flushTiles(CL_GraphicContext &p_gc);
+
+		void drawTiles(CL_GraphicContext &p_gc);
+
+		/** Moves all growing stripes of car to the tiles */
+		void finish(CarStripes &p_stripes);
+
+		/** Collects growing stripes vertices of car */
+		void collectTails(const CarStripes &p_stripes);
 
 		void clear();
 
@@ -200,14 +264,12 @@ class TyreStripesImpl
 				float p_precission
 		);
 
-
-		/** Splits immutable sprites from mutable */
-		void splitImmutable();
+		int toTile(float p_coord) const;
 
 };
 
-TyreStripes::TyreStripes(const Race::Level *p_level) :
-	m_impl(new TyreStripesImpl(p_level))
+TyreStripes::TyreStripes(const Race::Level *p_level, const Viewport *p_viewport) :
+	m_impl(new TyreStripesImpl(p_level, p_viewport))
 {
 	// empty
 }
@@ -217,74 +279,281 @@ TyreStripes::~TyreStripes()
 	// empty
 }
 
+void TyreStripes::load(CL_GraphicContext &p_gc)
+{
+	Drawable::load(p_gc);
+
+	m_impl->computeTileBudget();
+
+	m_impl->m_frameBuffer = CL_FrameBuffer(p_gc);
+	m_impl->m_tailArr = CL_PrimitivesArray(p_gc);
+
+	m_impl->m_tileArr = CL_PrimitivesArray(p_gc);
+	m_impl->m_tileArr.set_attributes(CL_PRIARR_VERTS, m_impl->m_tileVerts);
+	m_impl->m_tileArr.set_attributes(CL_PRIARR_COLORS, m_impl->m_tileColors);
+	m_impl->m_tileArr.set_attributes(
+			CL_PRIARR_TEXCOORDS, m_impl->m_tileTexCoords
+	);
+}
+
 void TyreStripesImpl::add(
+		StripeTail &p_tail,
 		const CL_Pointf &p_from,
-		const CL_Pointf &p_to,
-		const Race::Car *p_owner
+		const CL_Pointf &p_to
 )
 {
-	static const unsigned STRIPE_LENGTH_LIMIT = 30;
-	// how many last stripes that belongs to this car should I check?
-	static const int BACK_SEARCH_LIMIT = 4;
+	static const float STRIPE_LENGTH_LIMIT = 30.0f;
 	// point equals check precission
 	static const float EQUAL_CHECK_PRECISSION = 3.0f;
 
-	// search for four last stripes of this car and check if I can merge
-	// this stripe to the last one
-	bool merged = false;
-	int foundCount = 0;
+	// continue the stripe when it ends on the same point and
+	// length is below limit
+	if (
+			p_tail.m_open
+			&& equals(p_tail.m_to, p_from, EQUAL_CHECK_PRECISSION)
+			&& p_tail.length() < STRIPE_LENGTH_LIMIT
+	) {
+		p_tail.m_to = p_to;
+		return;
+	}
 
-	// last found stripe
-	Stripe *lastFound = NULL;
+	// otherwise the old stripe is done and new one begins
+	if (p_tail.m_open) {
+		bake(p_tail.m_from, p_tail.m_to);
+	}
 
-	for (
-			TStripeList::iterator itor = m_stripes.begin();
-			itor != m_stripes.end();
-			++itor
-	) {
-		Stripe &s = *itor;
+	p_tail.m_from = p_from;
+	p_tail.m_to = p_to;
+	p_tail.m_open = true;
+}
 
-		if (s.m_owner == p_owner) {
+int TyreStripesImpl::toTile(float p_coord) const
+{
+	return static_cast<int>(floor(p_coord / TILE_SIZE));
+}
+
+void TyreStripesImpl::bake(const CL_Pointf &p_from, const CL_Pointf &p_to)
+{
+	static const float MARGIN = STRIPE_WIDTH / 2.0f;
 
-			++foundCount;
+	// stripe can cross tile borders, so put it to every tile it touches
+	const int left = toTile(std::min(p_from.x, p_to.x) - MARGIN);
+	const int right = toTile(std::max(p_from.x, p_to.x) + MARGIN);
+	const int top = toTile(std::min(p_from.y, p_to.y) - MARGIN);
+	const int bottom = toTile(std::max(p_from.y, p_to.y) + MARGIN);
 
-			// must end on the same point and length must be below limit
-			if (
-					equals(s.m_to, p_from, EQUAL_CHECK_PRECISSION)
-					&& s.length() < STRIPE_LENGTH_LIMIT
-				) {
-				G_ASSERT(s.m_mutable);
+	for (int tx = left; tx <= right; ++tx) {
+		for (int ty = top; ty <= bottom; ++ty) {
 
-				// remove old stripe
-				Stripe copy = s;
-				m_stripes.erase(itor);
+			const TTileKey key(tx, ty);
+			TTileMap::iterator itor = m_tiles.find(key);
 
-				// and construct new one
-				m_stripes.push_front(Stripe(copy.m_from, p_to, p_owner));
-				merged = true;
+			if (itor == m_tiles.end()) {
+				if (m_tiles.size() >= m_maxTiles) {
+					dropOldestTile();
+				}
 
-				break;
+				itor = m_tiles.insert(std::make_pair(key, new StripeTile())).first;
 			}
 
-			if (foundCount == BACK_SEARCH_LIMIT) {
-				lastFound = &s;
-				break;
+			StripeTile *tile = itor->second;
+			tile->m_lastUse = m_useCounter;
+
+			if (tile->m_pending.empty()) {
+				m_dirtyTiles.push_back(tile);
 			}
+
+			const CL_Vec2f origin(tx * TILE_SIZE, ty * TILE_SIZE);
+
+			tile->m_pending.push_back(CL_Vec2f(p_from) - origin);
+			tile->m_pending.push_back(CL_Vec2f(p_to) - origin);
 		}
 	}
+}
+
+void TyreStripesImpl::computeTileBudget()
+{
+	const Race::Track &track = m_level->getTrack();
+	const int pointCount = track.getPointCount();
 
-	if (!merged) {
-		// when not merged, then create a new stripe
-		m_stripes.push_front(Stripe(p_from, p_to, p_owner));
+	if (pointCount == 0) {
+		m_maxTiles = MIN_TILES;
+		return;
+	}
+
+	const CL_Pointf &firstPos = track.getPoint(0).getPosition();
+	CL_Rectf bounds(firstPos.x, firstPos.y, firstPos.x, firstPos.y);
+
+	for (int i = 0; i < pointCount; ++i) {
+		const Race::TrackPoint &point = track.getPoint(i);
+		const CL_Pointf &pos = point.getPosition();
+		const float radius = point.getRadius() + BOUNDS_MARGIN;
+
+		bounds.left = std::min(bounds.left, pos.x - radius);
+		bounds.top = std::min(bounds.top, pos.y - radius);
+		bounds.right = std::max(bounds.right, pos.x + radius);
+		bounds.bottom = std::max(bounds.bottom, pos.y + radius);
+	}
 
-		// set the last found as immutable
-		if (lastFound) {
-			lastFound->m_mutable = false;
-			m_immutableStripeCnt++;
+	const unsigned cols = toTile(bounds.right) - toTile(bounds.left) + 1;
+	const unsigned rows = toTile(bounds.bottom) - toTile(bounds.top) + 1;
+
+	m_maxTiles = std::max(cols * rows, MIN_TILES);
+
+	cl_log_event(LOG_DEBUG, "tyre stripes keep up to %1 tiles", m_maxTiles);
+}
+
+void TyreStripesImpl::dropOldestTile()
+{
+	cl_log_event(LOG_WARN, "tyre stripes exceed %1 tiles, dropping the oldest one", m_maxTiles);
+
+	TTileMap::iterator oldest = m_tiles.begin();
+
+	for (TTileMap::iterator itor = m_tiles.begin(); itor != m_tiles.end(); ++itor) {
+		// counter may wrap, so compare ages
+		if (m_useCounter - itor->second->m_lastUse > m_useCounter - oldest->second->m_lastUse) {
+			oldest = itor;
 		}
+	}
+
+	StripeTile *tile = oldest->second;
+
+	m_dirtyTiles.erase(
+			std::remove(m_dirtyTiles.begin(), m_dirtyTiles.end(), tile),
+			m_dirtyTiles.end()
+	);
 
+	m_tiles.erase(oldest);
+	delete tile;
+}
+
+void TyreStripesImpl::flushTiles(CL_GraphicContext &p_gc)
+{
+	if (m_dirtyTiles.empty()) {
+		return;
+	}
+
+	p_gc.push_modelview();
+	p_gc.set_modelview(CL_Mat4f::identity());
+
+	p_gc.set_program_object(cl_program_color_only);
+	p_gc.set_blend_mode(m_bakeBlendMode);
+
+	CL_PrimitivesArray priArr(p_gc);
+
+	foreach (StripeTile *tile, m_dirtyTiles) {
+
+		if (!tile->m_prepared) {
+			tile->m_texture = CL_Texture(p_gc, TILE_SIZE, TILE_SIZE);
+			tile->m_texture.set_mag_filter(cl_filter_linear);
+			tile->m_texture.set_min_filter(cl_filter_linear);
+		}
+
+		m_frameBuffer.attach_color_buffer(0, tile->m_texture);
+		p_gc.set_frame_buffer(m_frameBuffer);
+
+		if (!tile->m_prepared) {
+			p_gc.clear(CL_Colorf::transparent);
+			tile->m_prepared = true;
+		}
+
+		const int vertCount = static_cast<int>(tile->m_pending.size());
+
+		if (static_cast<int>(m_bakeColors.size()) < vertCount) {
+			m_bakeColors.resize(vertCount, STRIPE_COLOR_VEC);
+		}
+
+		priArr.set_attributes(CL_PRIARR_VERTS, &tile->m_pending[0]);
+		priArr.set_attributes(CL_PRIARR_COLORS, &m_bakeColors[0]);
+
+		p_gc.draw_primitives(cl_lines, vertCount, priArr);
+
+		p_gc.reset_frame_buffer();
+		m_frameBuffer.detach_color_buffer(0, tile->m_texture);
+
+		tile->m_pending.clear();
+	}
+
+	m_dirtyTiles.clear();
+
+	p_gc.reset_blend_mode();
+	p_gc.pop_modelview();
+}
+
+void TyreStripesImpl::drawTiles(CL_GraphicContext &p_gc)
+{
+	if (m_tiles.empty()) {
+		return;
+	}
+
+	const CL_Rectf &clip = m_viewport->getWorldClipRect();
+
+	const int left = toTile(clip.left);
+	const int right = toTile(clip.right);
+	const int top = toTile(clip.top);
+	const int bottom = toTile(clip.bottom);
+
+	TTileMap::const_iterator itor;
+
+	++m_useCounter;
+
+	p_gc.set_program_object(cl_program_single_texture);
+
+	for (int tx = left; tx <= right; ++tx) {
+		for (int ty = top; ty <= bottom; ++ty) {
+
+			itor = m_tiles.find(TTileKey(tx, ty));
+
+			if (itor == m_tiles.end() || !itor->second->m_prepared) {
+				continue;
+			}
+
+			itor->second->m_lastUse = m_useCounter;
+
+			const float x = tx * TILE_SIZE;
+			const float y = ty * TILE_SIZE;
+
+			m_tileVerts[0] = CL_Vec2f(x, y);
+			m_tileVerts[1] = CL_Vec2f(x, y + TILE_SIZE);
+			m_tileVerts[2] = CL_Vec2f(x + TILE_SIZE, y + TILE_SIZE);
+			m_tileVerts[3] = CL_Vec2f(x + TILE_SIZE, y);
+
+			p_gc.set_texture(0, itor->second->m_texture);
+			p_gc.draw_primitives(cl_quads, 4, m_tileArr);
+		}
+	}
+
+	p_gc.reset_texture(0);
+	p_gc.set_program_object(cl_program_color_only);
+}
+
+void TyreStripesImpl::finish(CarStripes &p_stripes)
+{
+	for (int i = 0; i < WHEEL_COUNT; ++i) {
+		StripeTail &tail = p_stripes.m_tails[i];
+
+		if (tail.m_open) {
+			bake(tail.m_from, tail.m_to);
+			tail.m_open = false;
+		}
 	}
+}
+
+void TyreStripesImpl::collectTails(const CarStripes &p_stripes)
+{
+	for (int i = 0; i < WHEEL_COUNT; ++i) {
+		const StripeTail &tail = p_stripes.m_tails[i];
 
+		if (tail.m_open) {
+			if (m_tailVertCount + 2 > static_cast<int>(m_tailVerts.size())) {
+				m_tailVerts.resize(m_tailVertCount + WHEEL_COUNT * 2);
+				m_tailColors.resize(m_tailVerts.size(), STRIPE_COLOR_VEC);
+			}
+
+			m_tailVerts[m_tailVertCount++] = tail.m_from;
+			m_tailVerts[m_tailVertCount++] = tail.m_to;
+		}
+	}
 }
 
 bool TyreStripesImpl::equals(
@@ -303,64 +572,72 @@ void TyreStripes::clear()
 
 void TyreStripesImpl::clear()
 {
-	m_stripes.clear();
-	m_lastDriftMap.clear();
-
-
-	foreach (StripeArr *sarr, m_stripeArrays) {
-		delete sarr;
+	std::pair<TTileKey, StripeTile*> pair;
+	foreach (pair, m_tiles) {
+		delete pair.second;
 	}
 
-	m_stripeArrays.clear();
+	m_tiles.clear();
+	m_dirtyTiles.clear();
+	m_carStripes.clear();
+	m_tailVertCount = 0;
 }
 
-void TyreStripes::update()
+void TyreStripes::update(const Race::RaceSnapshot &p_snapshot)
 {
-	const int carCount = m_impl->m_level->getCarCount();
-	TyreStripesImpl::TDriftPointMap::iterator itor;
+	m_impl->m_tailVertCount = 0;
+
+	const unsigned updateId = ++m_impl->m_useCounter;
 
-	for (int i = 0; i < carCount; ++i) {
-		const Race::Car &car = m_impl->m_level->getCar(i);
-		itor = m_impl->m_lastDriftMap.find(&car);
+	foreach (const Race::CarSnapshot &car, p_snapshot.m_cars) {
+		CarStripes &stripes = m_impl->m_carStripes[car.m_car];
+		stripes.m_lastUpdate = updateId;
 
-		if (car.isDrifting()) {
+		if (car.m_drifting) {
 			// add drift point if has last drift point
-			if (itor != m_impl->m_lastDriftMap.end()) {
-				//m_impl->add(itor->second, car.getPosition(), &car);
-				m_impl->add4WheelStripe(car, itor->second);
+			if (stripes.m_drifting) {
+				m_impl->add4WheelStripe(car, stripes, stripes.m_lastDriftPoint);
 			}
 
 			// remember this point
-			m_impl->m_lastDriftMap[&car] = car.getPosition();
-		} else {
-			// remove last drift point if not drifting
-			if (itor != m_impl->m_lastDriftMap.end()) {
-				m_impl->m_lastDriftMap.erase(itor);
-			}
+			stripes.m_lastDriftPoint = car.m_position;
+			stripes.m_drifting = true;
+		} else if (stripes.m_drifting) {
+			// drift has ended, stripes will not grow anymore
+			m_impl->finish(stripes);
+			stripes.m_drifting = false;
 		}
+
+		m_impl->collectTails(stripes);
 	}
 
-	// check immutable stripes count for optimalization
-	if (m_impl->m_immutableStripeCnt >= IMMUTABLE_STRIPE_LIMIT) {
-		cl_log_event(LOG_DEBUG, "split stripes: %1, %2", m_impl->m_stripes.size(), m_impl->m_stripeArrays.size());
-		m_impl->splitImmutable();
+	// forget cars which have left, their car objects may be gone
+	TyreStripesImpl::TCarStripesMap::iterator itor = m_impl->m_carStripes.begin();
+
+	while (itor != m_impl->m_carStripes.end()) {
+		if (itor->second.m_lastUpdate != updateId) {
+			m_impl->finish(itor->second);
+			m_impl->m_carStripes.erase(itor++);
+		} else {
+			++itor;
+		}
 	}
 }
 
 void TyreStripesImpl::add4WheelStripe(
-		const Race::Car &p_car,
+		const Race::CarSnapshot &p_car,
+		CarStripes &p_stripes,
 		const CL_Pointf &p_from
 )
 {
-	static const int WHEEL_COUNT = 4;
 	static const float TYRE_RADIUS = 20.0f; // tire distance from car center
 	static const float DEG_90_RAD = CL_PI / 2;
 	static const float DEG_45_RAD = DEG_90_RAD / 2;
 
-	const CL_Pointf carPos = p_car.getPosition();
+	const CL_Pointf carPos = p_car.m_position;
 	const CL_Vec2f posDelta = carPos - p_from;
 
-	CL_Angle angle = p_car.getCorpseAngle();
+	CL_Angle angle = p_car.m_corpseAngle;
 
 	CL_Vec2f v;
 	float rad;
@@ -381,47 +658,7 @@ void TyreStripesImpl::add4WheelStripe(
 		tyrePosB = carPos + v;
 		tyrePosA = tyrePosB - posDelta;
 
-		add(tyrePosA, tyrePosB, &p_car);
-	}
-}
-
-void TyreStripesImpl::splitImmutable()
-{
-	static const unsigned ARRAYS_LIMIT = 128;
-
-	// I need to skip first immutable stripes in order to take back
-	// the oldest ones
-	int skipCount = m_immutableStripeCnt - IMMUTABLE_STRIPE_LIMIT;
-	m_immutableStripeCnt -= IMMUTABLE_STRIPE_LIMIT;
-
-	StripeArr *arr = new StripeArr(IMMUTABLE_STRIPE_LIMIT);
-	int idx = 0;
-
-	for (
-			TStripeList::iterator itor = m_stripes.begin();
-			itor != m_stripes.end();
-	) {
-		Stripe &s = *itor;
-		if (!s.m_mutable) {
-
-			// skip first stripes if necessary
-			if (skipCount == 0) {
-				arr->add(idx++, s);
-				m_stripes.erase(itor++);
-			} else {
-				skipCount--;
-				itor++;
-			}
-		} else {
-			itor++;
-		}
-	}
-
-	m_stripeArrays.push_back(arr);
-
-	if (m_stripeArrays.size() > ARRAYS_LIMIT) {
-		delete m_stripeArrays.front();
-		m_stripeArrays.pop_front();
+		add(p_stripes.m_tails[i], tyrePosA, tyrePosB);
 	}
 }
 
@@ -430,21 +667,25 @@ void TyreStripes::draw(CL_GraphicContext &p_gc)
 	CL_Pen oldPen = p_gc.get_pen();
 
 	CL_Pen newPen;
-	newPen.set_line_width(3);
+	newPen.set_line_width(STRIPE_WIDTH);
 	p_gc.set_pen(newPen);
 
-	// draw arrays
-	foreach (StripeArr *sarr, m_impl->m_stripeArrays) {
-		sarr->draw(p_gc);
-	}
+	// finished stripes are rendered once to tiles
+	m_impl->flushTiles(p_gc);
+	m_impl->drawTiles(p_gc);
+
+	// growing stripes
+	if (m_impl->m_tailVertCount > 0) {
+		CL_PrimitivesArray &arr = m_impl->m_tailArr;
 
-	foreach (const Stripe &stripe, m_impl->m_stripes) {
-		const CL_Pointf &from = stripe.getFromPoint();
-		const CL_Pointf &to = stripe.getToPoint();
+		arr.set_attributes(CL_PRIARR_VERTS, &m_impl->m_tailVerts[0]);
+		arr.set_attributes(CL_PRIARR_COLORS, &m_impl->m_tailColors[0]);
 
-		CL_Draw::line(p_gc, from, to, STRIPE_COLOR);
+		p_gc.set_program_object(cl_program_color_only);
+		p_gc.draw_primitives(cl_lines, m_impl->m_tailVertCount, arr);
 	}
+
+	p_gc.set_pen(oldPen);
 }
 
 } // namespace
-
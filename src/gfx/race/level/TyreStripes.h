@@ -35,27 +35,31 @@
 
 namespace Race {
 	class Level;
+	class RaceSnapshot;
 }
 
 namespace Gfx {
 
 class Car;
 class TyreStripesImpl;
+class Viewport;
 
 class TyreStripes : public Drawable {
 
 	public:
 
-		TyreStripes(const Race::Level *p_level);
+		TyreStripes(const Race::Level *p_level, const Viewport *p_viewport);
 
 		virtual ~TyreStripes();
 
 
 		virtual void draw(CL_GraphicContext &p_gc);
 
+		virtual void load(CL_GraphicContext &p_gc);
+
 		void clear();
 
-		void update();
+		void update(const Race::RaceSnapshot &p_snapshot);
 
 	private:
 
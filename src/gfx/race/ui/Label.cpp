@@ -28,8 +28,15 @@
 
 #include "Label.h"
 
+#include <algorithm>
+#include <map>
+#include <math.h>
+
+#include "clanlib/display/2d.h"
 #include "clanlib/display/font.h"
+#include "clanlib/display/render.h"
 
+#include "common.h"
 #include "common/gassert.h"
 
 namespace Gfx {
@@ -43,6 +50,67 @@ const int Label::AP_CENTER = 16;
 const int AP_SIDES = Label::AP_LEFT | Label::AP_RIGHT;
 const int AP_TOPS = Label::AP_TOP | Label::AP_BOTTOM;
 
+/** Free space around cached text */
+const int CACHE_PADDING = 2;
+
+/** Shadow quad and text quad */
+const int MESH_SIZE = 8;
+
+namespace {
+
+/** Font shared by all loaded labels of the same font and size */
+struct SharedFont {
+	CL_SharedPtr<CL_Font> m_font;
+	int m_users;
+};
+
+typedef std::pair<Label::Font, int> TFontKey;
+typedef std::map<TFontKey, SharedFont> TFontMap;
+
+TFontMap s_fonts;
+
+/** Creates the font only for its first user */
+CL_Font *acquireFont(CL_GraphicContext &p_gc, Label::Font p_font, int p_size)
+{
+	SharedFont &shared = s_fonts[TFontKey(p_font, p_size)];
+
+	if (!shared.m_font) {
+		CL_FontDescription desc;
+		desc.set_height(p_size);
+
+		if (p_font == Label::F_REGULAR || p_font == Label::F_BOLD) {
+			desc.set_typeface_name("tahoma");
+
+			if (p_font == Label::F_BOLD) {
+				desc.set_weight(100000);
+			}
+
+			shared.m_font = CL_SharedPtr<CL_Font>(new CL_Font_System(p_gc, desc));
+		} else {
+			desc.set_typeface_name("resources/pixel.ttf");
+			shared.m_font = CL_SharedPtr<CL_Font>(new CL_Font_Freetype(p_gc, desc));
+		}
+
+		shared.m_users = 0;
+	}
+
+	++shared.m_users;
+	return shared.m_font.get();
+}
+
+/** Destroys the font with its last user */
+void releaseFont(Label::Font p_font, int p_size)
+{
+	TFontMap::iterator itor = s_fonts.find(TFontKey(p_font, p_size));
+	G_ASSERT(itor != s_fonts.end());
+
+	if (--itor->second.m_users == 0) {
+		s_fonts.erase(itor);
+	}
+}
+
+}
+
 class LabelImpl
 {
 	public:
@@ -60,10 +128,38 @@ class LabelImpl
 		CL_Colorf m_shadowColor;
 		CL_Vec2f m_shadowOffset;
 
+		/** Shared with other labels, see acquireFont() */
 		CL_Font *m_clFont;
 		CL_FontMetrics m_fontMetrics;
 
 
+		// text cache
+
+		/** Text size must be measured again */
+		bool m_layoutDirty;
+
+		/** Cached text must be rendered again */
+		bool m_meshDirty;
+
+		CL_Size m_textSize;
+
+		/** Text rendered in white, tinted when drawn */
+		CL_Texture m_cache;
+
+		/** Used part of cache texture */
+		CL_Size m_cacheSize;
+
+		CL_FrameBuffer m_frameBuffer;
+
+		CL_BlendMode m_cacheBlendMode;
+
+		CL_Vec2f m_meshVerts[MESH_SIZE];
+
+		CL_Vec4f m_meshColors[MESH_SIZE];
+
+		CL_Vec2f m_meshTexCoords[MESH_SIZE];
+
+
 		LabelImpl(
 				Label *p_parent,
 				const CL_Pointf &p_pos,
@@ -75,7 +171,14 @@ class LabelImpl
 
 		void load(CL_GraphicContext &p_gc);
 		void draw(CL_GraphicContext &p_gc);
-		void drawShadow(CL_GraphicContext &p_gc, const CL_Pointf &p_pos);
+		void setQuad(
+				int p_offset,
+				const CL_Pointf &p_pos,
+				const CL_Colorf &p_color
+		);
+
+		void updateLayout(CL_GraphicContext &p_gc);
+		void updateCache(CL_GraphicContext &p_gc);
 
 		void calculateAttachPoint(float p_w, float p_h, float &p_x, float &p_y);
 };
@@ -108,9 +211,15 @@ LabelImpl::LabelImpl(
 		m_shadowVisible(false),
 		m_shadowColor(CL_Colorf::black),
 		m_shadowOffset(1.5f, 1.5f),
-		m_clFont(NULL)
+		m_clFont(NULL),
+		m_layoutDirty(true),
+		m_meshDirty(true)
 {
-	// empty
+	// text is drawn to empty texture, so keep the alpha as it is
+	m_cacheBlendMode.set_blend_function(
+			cl_blend_one, cl_blend_one_minus_src_alpha,
+			cl_blend_one, cl_blend_one_minus_src_alpha
+	);
 }
 
 Label::~Label()
@@ -121,7 +230,7 @@ Label::~Label()
 LabelImpl::~LabelImpl()
 {
 	if (m_clFont) {
-		delete m_clFont;
+		releaseFont(m_font, m_size);
 	}
 }
 
@@ -133,24 +242,19 @@ void Label::load(CL_GraphicContext &p_gc)
 
 void LabelImpl::load(CL_GraphicContext &p_gc)
 {
-	CL_FontDescription desc;
-	desc.set_height(m_size);
-
-	if (m_font == Label::F_REGULAR || m_font == Label::F_BOLD) {
-		desc.set_typeface_name("tahoma");
-
-		if (m_font == Label::F_BOLD) {
-			desc.set_weight(100000);
-		}
-
-		m_clFont = new CL_Font_System(p_gc, desc);
-	} else {
-		desc.set_typeface_name("resources/pixel.ttf");
-		m_clFont = new CL_Font_Freetype(p_gc, desc);
+	if (m_clFont) {
+		releaseFont(m_font, m_size);
 	}
 
+	m_clFont = acquireFont(p_gc, m_font, m_size);
+
 	// remember metrics
 	m_fontMetrics = m_clFont->get_font_metrics(p_gc);
+
+	m_frameBuffer = CL_FrameBuffer(p_gc);
+
+	m_layoutDirty = true;
+	m_meshDirty = true;
 }
 
 void Label::draw(CL_GraphicContext &p_gc)
@@ -162,20 +266,44 @@ void LabelImpl::draw(CL_GraphicContext &p_gc)
 {
 	G_ASSERT(m_parent->isLoaded());
 
-	float ax, ay;
-	const CL_Size s = m_parent->size(p_gc);
+	updateLayout(p_gc);
 
-	calculateAttachPoint(s.width, s.height, ax, ay);
+	if (m_text.empty()) {
+		return;
+	}
+
+	updateCache(p_gc);
+
+	float ax, ay;
+	calculateAttachPoint(m_textSize.width, m_textSize.height, ax, ay);
 
 	CL_Pointf position;
 	position.x = m_pos.x - ax;
 	position.y = m_pos.y - ay - m_fontMetrics.get_descent();
 
+	// shadow goes first, so text covers it
+	int count = 0;
+
 	if (m_shadowVisible) {
-		drawShadow(p_gc, position);
+		setQuad(count, position + m_shadowOffset, m_shadowColor);
+		count += 4;
 	}
 
-	m_clFont->draw_text(p_gc, position.x, position.y, m_text, m_color);
+	setQuad(count, position, m_color);
+	count += 4;
+
+	CL_PrimitivesArray priArr(p_gc);
+	priArr.set_attributes(CL_PRIARR_VERTS, m_meshVerts);
+	priArr.set_attributes(CL_PRIARR_COLORS, m_meshColors);
+	priArr.set_attributes(CL_PRIARR_TEXCOORDS, m_meshTexCoords);
+
+	p_gc.set_program_object(cl_program_single_texture);
+	p_gc.set_texture(0, m_cache);
+
+	p_gc.draw_primitives(cl_quads, count, priArr);
+
+	p_gc.reset_texture(0);
+	p_gc.set_program_object(cl_program_color_only);
 
 #if !defined(NDEBUG) && defined(DRAW_LABEL_BOUNDS)
 	// draw label frame debug code
@@ -185,19 +313,119 @@ void LabelImpl::draw(CL_GraphicContext &p_gc)
 	const CL_Pen oldPen = p_gc.get_pen();
 	p_gc.set_pen(newPen);
 
-	const float y2 = y + m_fontMetrics.get_descent();
-	CL_Draw::box(p_gc, x, y2 - s.height, x + s.width, y2, CL_Colorf::red);
+	const float x = position.x;
+	const float y2 = position.y + m_fontMetrics.get_descent();
+	CL_Draw::box(
+			p_gc, x, y2 - m_textSize.height, x + m_textSize.width, y2,
+			CL_Colorf::red
+	);
 
 	p_gc.set_pen(oldPen);
 #endif // !NDEBUG && DRAW_LABEL_BOUNDS
 }
 
-void LabelImpl::drawShadow(CL_GraphicContext &p_gc, const CL_Pointf &p_pos)
+void LabelImpl::setQuad(
+		int p_offset,
+		const CL_Pointf &p_pos,
+		const CL_Colorf &p_color
+)
 {
-	CL_Pointf position;
-	position.x = p_pos.x + m_shadowOffset.x;
-	position.y = p_pos.y + m_shadowOffset.y;
-	m_clFont->draw_text(p_gc, position.x, position.y, m_text, m_shadowColor);
+	// p_pos is the text baseline
+	const float x1 = p_pos.x - CACHE_PADDING;
+	const float y1 = p_pos.y - m_fontMetrics.get_ascent() - CACHE_PADDING;
+	const float x2 = x1 + m_cacheSize.width;
+	const float y2 = y1 + m_cacheSize.height;
+
+	const float tx = m_cacheSize.width / static_cast<float>(m_cache.get_width());
+	const float ty = m_cacheSize.height / static_cast<float>(m_cache.get_height());
+
+	CL_Vec2f *verts = m_meshVerts + p_offset;
+	CL_Vec2f *texCoords = m_meshTexCoords + p_offset;
+
+	verts[0] = CL_Vec2f(x1, y1);
+	verts[1] = CL_Vec2f(x1, y2);
+	verts[2] = CL_Vec2f(x2, y2);
+	verts[3] = CL_Vec2f(x2, y1);
+
+	texCoords[0] = CL_Vec2f(0.0f, 0.0f);
+	texCoords[1] = CL_Vec2f(0.0f, ty);
+	texCoords[2] = CL_Vec2f(tx, ty);
+	texCoords[3] = CL_Vec2f(tx, 0.0f);
+
+	for (int i = 0; i < 4; ++i) {
+		m_meshColors[p_offset + i] = p_color;
+	}
+}
+
+void LabelImpl::updateLayout(CL_GraphicContext &p_gc)
+{
+	if (!m_layoutDirty) {
+		return;
+	}
+
+	m_textSize = m_clFont->get_text_size(p_gc, m_text);
+	m_layoutDirty = false;
+}
+
+void LabelImpl::updateCache(CL_GraphicContext &p_gc)
+{
+	if (!m_meshDirty) {
+		return;
+	}
+
+	m_cacheSize.width = m_textSize.width + CACHE_PADDING * 2;
+	m_cacheSize.height =
+			static_cast<int>(ceilf(m_fontMetrics.get_height()))
+			+ CACHE_PADDING * 2;
+
+	// grow only, so changing text will not reallocate
+	if (
+			m_cache.is_null()
+			|| m_cache.get_width() < m_cacheSize.width
+			|| m_cache.get_height() < m_cacheSize.height
+	) {
+		int w = 16, h = 16;
+
+		while (w < m_cacheSize.width) {
+			w *= 2;
+		}
+
+		while (h < m_cacheSize.height) {
+			h *= 2;
+		}
+
+		if (!m_cache.is_null()) {
+			w = std::max(w, m_cache.get_width());
+			h = std::max(h, m_cache.get_height());
+		}
+
+		m_cache = CL_Texture(p_gc, w, h);
+		m_cache.set_mag_filter(cl_filter_linear);
+		m_cache.set_min_filter(cl_filter_linear);
+	}
+
+	m_frameBuffer.attach_color_buffer(0, m_cache);
+	p_gc.set_frame_buffer(m_frameBuffer);
+
+	p_gc.clear(CL_Colorf::transparent);
+
+	p_gc.push_modelview();
+	p_gc.set_modelview(CL_Mat4f::identity());
+	p_gc.set_blend_mode(m_cacheBlendMode);
+
+	m_clFont->draw_text(
+			p_gc,
+			CACHE_PADDING, CACHE_PADDING + m_fontMetrics.get_ascent(),
+			m_text, CL_Colorf::white
+	);
+
+	p_gc.reset_blend_mode();
+	p_gc.pop_modelview();
+
+	p_gc.reset_frame_buffer();
+	m_frameBuffer.detach_color_buffer(0, m_cache);
+
+	m_meshDirty = false;
 }
 
 void Label::setColor(const CL_Colorf &p_color)
@@ -212,7 +440,14 @@ void Label::setPosition(const CL_Pointf &p_pos)
 
 void Label::setText(const CL_String &p_text)
 {
+	if (p_text == m_impl->m_text) {
+		return;
+	}
+
 	m_impl->m_text = p_text;
+
+	m_impl->m_layoutDirty = true;
+	m_impl->m_meshDirty = true;
 }
 
 float Label::height()
@@ -224,7 +459,9 @@ float Label::height()
 CL_Size Label::size(CL_GraphicContext &p_gc)
 {
 	G_ASSERT(isLoaded());
-	return m_impl->m_clFont->get_text_size(p_gc, m_impl->m_text);
+
+	m_impl->updateLayout(p_gc);
+	return m_impl->m_textSize;
 }
 
 void Label::setAttachPoint(int p_attachPoint)
@@ -72,6 +72,11 @@ class Label: public Gfx::Drawable {
 		void setAttachPoint(int p_attachPoint);
 		void setColor(const CL_Colorf &p_color);
 		void setPosition(const CL_Pointf &p_pos);
+
+		/**
+		 * Sets label text. Text is rendered once to a cached texture
+		 * and rendered again only when it differs from current text.
+		 */
 		void setText(const CL_String &p_text);
 
 		void setShadowVisible(bool p_visible);
@@ -28,6 +28,8 @@
 
 #include "PlayerList.h"
 
+#include <vector>
+
 #include "clanlib/core/text.h"
 
 #include "common/Player.h"
@@ -39,6 +41,9 @@
 
 namespace Gfx {
 
+/** Rows created on load, enough for a full server */
+const int PRELOADED_ROWS = 32;
+
 class PlayerListImpl
 {
 	public:
@@ -51,11 +56,19 @@ class PlayerListImpl
 
 		int m_labelHeight;
 
+		/** One label per row, so texts are not rendered again */
+		std::vector<CL_SharedPtr<Label> > m_rowLabels;
+
+		/** Player names displayed in rows */
+		std::vector<CL_String> m_rowNames;
+
 
 		PlayerListImpl(const Race::GameLogic *p_logic) :
 			m_logic(p_logic),
 			m_label(CL_Pointf(), "", Label::F_BOLD, 16)
 		{ /* empty */ }
+
+		Label &getRowLabel(CL_GraphicContext &p_gc, int p_row);
 };
 
 PlayerList::PlayerList(const Race::GameLogic *p_logic) :
@@ -87,10 +100,17 @@ void PlayerList::draw(CL_GraphicContext &p_gc)
 	for (int i = 0; i < carCount; ++i) {
 		const Race::Car &car = level.getCar(i);
 
-		m_impl->m_label.setPosition(CL_Pointf(0, h));
-		m_impl->m_label.setText(cl_format("%1. %2", i + 1, car.getOwnerPlayer().getName()));
+		const CL_String &name = car.getOwnerPlayer().getName();
+
+		Label &label = m_impl->getRowLabel(p_gc, i);
+
+		if (name != m_impl->m_rowNames[i]) {
+			label.setText(cl_format("%1. %2", i + 1, name));
+			m_impl->m_rowNames[i] = name;
+		}
 
-		m_impl->m_label.draw(p_gc);
+		label.setPosition(CL_Pointf(0, h));
+		label.draw(p_gc);
 
 		h += m_impl->m_labelHeight;
 	}
@@ -98,6 +118,19 @@ void PlayerList::draw(CL_GraphicContext &p_gc)
 	p_gc.pop_modelview();
 }
 
+Label &PlayerListImpl::getRowLabel(CL_GraphicContext &p_gc, int p_row)
+{
+	while (static_cast<int>(m_rowLabels.size()) <= p_row) {
+		CL_SharedPtr<Label> label(new Label(CL_Pointf(), "", Label::F_BOLD, 16));
+		label->load(p_gc);
+
+		m_rowLabels.push_back(label);
+		m_rowNames.push_back(CL_String());
+	}
+
+	return *m_rowLabels[p_row];
+}
+
 void PlayerList::load(CL_GraphicContext &p_gc)
 {
 	m_impl->m_label.load(p_gc);
@@ -105,6 +138,9 @@ void PlayerList::load(CL_GraphicContext &p_gc)
 	m_impl->m_label.setText("X");
 	m_impl->m_labelHeight = m_impl->m_label.size(p_gc).height;
 
+	// rows are not created while drawing
+	m_impl->getRowLabel(p_gc, PRELOADED_ROWS - 1);
+
 	Drawable::load(p_gc);
 }
 
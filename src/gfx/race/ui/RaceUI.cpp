@@ -28,7 +28,9 @@
 
 #include "RaceUI.h"
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 #include "common/Game.h"
 #include "common/utils/rtti.h"
@@ -47,10 +49,39 @@
 #include "logic/race/GameLogicTimeTrailOnline.h"
 #include "logic/race/MessageBoard.h"
 #include "logic/race/Progress.h"
+#include "logic/race/RaceSnapshot.h"
 #include "math/Time.h"
 
 namespace Gfx {
 
+/** Car labels created on load, enough for a full server */
+const int PRELOADED_CAR_LABELS = 32;
+
+/** Locks the logic mutex for a scope, when there is one */
+class LogicLock
+{
+	public:
+
+		LogicLock(CL_Mutex *p_mutex) :
+			m_mutex(p_mutex)
+		{
+			if (m_mutex) {
+				m_mutex->lock();
+			}
+		}
+
+		~LogicLock()
+		{
+			if (m_mutex) {
+				m_mutex->unlock();
+			}
+		}
+
+	private:
+
+		CL_Mutex *m_mutex;
+};
+
 struct Comparator {
 	bool operator() (unsigned s1, unsigned s2) const
 	{
@@ -70,21 +101,45 @@ class RaceUIImpl
 
 		Label m_globMsgLabel;
 		Label m_voteLabel;
-		Label m_messageBoardLabel;
+		Label m_voteHintLabel;
 		Label m_lapLabel;
-		Label m_carLabel;
 		Label m_countdownLabel;
 
+		/** One label per car, so names are not rendered again */
+		std::vector<CL_SharedPtr<Label> > m_carLabels;
+
+		/** Message board labels by message id */
+		std::map<int, CL_SharedPtr<Label> > m_messageLabels;
+
 		Label m_bestLapTimeTitleLabel;
 		Label m_lastLapTimeTitleLabel;
 		Label m_bestLapTimeLabel;
 		Label m_lastLapTimeLabel;
 		Label m_currentLapTimeLabel;
 
+
+		// last displayed values, text is formatted only when these change
+
+		int m_shownLap, m_shownLapsTotal;
+
+		int m_shownBestTime, m_shownLastTime, m_shownCurrentTime;
+
+		unsigned m_shownVoteTimeLeft;
+
+		int m_shownYesCount, m_shownNoCount;
+
+		CL_String m_shownVoteSubject;
+
 		// Race logic pointer
 		const Race::GameLogic *const m_logic;
 		Race::RaceGameState m_lastState;
 
+		/** Race state for car and lap labels */
+		const Race::RaceSnapshot *m_snapshot;
+
+		/** Guards the logic when it runs on other thread */
+		CL_Mutex *m_logicMutex;
+
 		// Viewport pointer
 		const Gfx::Viewport *m_viewport;
 
@@ -119,6 +174,9 @@ class RaceUIImpl
 		void drawGlobalMessage(CL_GraphicContext &p_gc);
 		void drawScoreTable(CL_GraphicContext &p_gc);
 
+		Label &getCarLabel(CL_GraphicContext &p_gc, int p_index);
+		Label &getMessageLabel(CL_GraphicContext &p_gc, int p_messageId);
+
 };
 
 RaceUI::RaceUI(const Race::GameLogic *p_logic, const Gfx::Viewport *p_viewport) :
@@ -133,23 +191,31 @@ RaceUIImpl::RaceUIImpl(const Race::GameLogic *p_logic, const Gfx::Viewport *p_vi
 		m_scoreTable(p_logic),
 		m_globMsgLabel(CL_Pointf(Stage::getWidth() / 2, Stage::getHeight() / 3), "", Label::F_BOLD, 36),
 		m_voteLabel(CL_Pointf(100, 20), "", Label::F_BOLD, 20),
-		m_messageBoardLabel(CL_Pointf(), "", Label::F_REGULAR, 14),
+		m_voteHintLabel(CL_Pointf(100, 20), _("To vote press F1 (YES) or F2 (NO)"), Label::F_BOLD, 20),
 		m_lapLabel(CL_Pointf(Stage::getWidth() - 20, 5), "", Label::F_BOLD, 25),
-		m_carLabel(CL_Pointf(), "", Label::F_REGULAR, 14),
 		m_countdownLabel(CL_Pointf(0.0f, 0.0f), "", Label::F_BOLD, 75),
 		m_bestLapTimeTitleLabel(CL_Pointf(), _("Best Lap"), Label::F_BOLD, 22),
 		m_lastLapTimeTitleLabel(CL_Pointf(), _("Last Lap"), Label::F_BOLD, 22),
 		m_bestLapTimeLabel(CL_Pointf(), "", Label::F_REGULAR, 22),
 		m_lastLapTimeLabel(CL_Pointf(), "", Label::F_REGULAR, 22),
 		m_currentLapTimeLabel(CL_Pointf(), "", Label::F_REGULAR, 22),
+		m_shownLap(-1),
+		m_shownLapsTotal(-1),
+		m_shownBestTime(-1),
+		m_shownLastTime(-1),
+		m_shownCurrentTime(-1),
+		m_shownVoteTimeLeft(0),
+		m_shownYesCount(-1),
+		m_shownNoCount(-1),
 		m_logic(p_logic),
 		m_lastState(m_logic->getRaceGameState()),
+		m_snapshot(NULL),
+		m_logicMutex(NULL),
 		m_viewport(p_viewport)
 {
 	m_globMsgLabel.setAttachPoint(Label::AP_CENTER | Label::AP_BOTTOM);
 	m_playerList.setPosition(CL_Pointf(Stage::getWidth() - 250, 100));
 	m_lapLabel.setAttachPoint(Label::AP_RIGHT | Label::AP_TOP);
-	m_carLabel.setAttachPoint(Label::AP_CENTER | Label::AP_TOP);
 	m_countdownLabel.setAttachPoint(Label::AP_CENTER);
 
 	positionLapTimeLabels();
@@ -205,8 +271,20 @@ RaceUIImpl::~RaceUIImpl()
 	// empty
 }
 
+void RaceUI::setSnapshot(const Race::RaceSnapshot *p_snapshot)
+{
+	m_impl->m_snapshot = p_snapshot;
+}
+
+void RaceUI::setLogicMutex(CL_Mutex *p_mutex)
+{
+	m_impl->m_logicMutex = p_mutex;
+}
+
 void RaceUI::update(unsigned p_timeElapsed)
 {
+	LogicLock lock(m_impl->m_logicMutex);
+
 	m_impl->watchRaceGameStateForChanges();
 	m_impl->m_scoreTable.update(p_timeElapsed);
 }
@@ -228,22 +306,36 @@ void RaceUI::draw(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::draw(CL_GraphicContext &p_gc)
 {
+	G_ASSERT(m_snapshot != NULL);
+
 	drawMeters(p_gc);
-	drawVote(p_gc);
-	drawMessageBoard(p_gc);
+
+	{
+		LogicLock lock(m_logicMutex);
+
+		drawVote(p_gc);
+		drawMessageBoard(p_gc);
+	}
+
+	// these are read from the snapshot
 	drawLapLabel(p_gc);
 	drawLapTimes(p_gc);
 	drawCarLabels(p_gc);
-	drawPlayerList(p_gc);
-	drawGlobalMessage(p_gc);
-	drawScoreTable(p_gc);
 
-	if (isInstance<Race::GameLogicArcade>(m_logic)) {
-		drawCountdown(p_gc);
-	}
+	{
+		LogicLock lock(m_logicMutex);
 
-	if (m_modeBasedUI) {
-		m_modeBasedUI->draw(p_gc);
+		drawPlayerList(p_gc);
+		drawGlobalMessage(p_gc);
+		drawScoreTable(p_gc);
+
+		if (isInstance<Race::GameLogicArcade>(m_logic)) {
+			drawCountdown(p_gc);
+		}
+
+		if (m_modeBasedUI) {
+			m_modeBasedUI->draw(p_gc);
+		}
 	}
 }
 
@@ -268,19 +360,30 @@ void RaceUIImpl::drawVote(CL_GraphicContext &p_gc)
 		const int yesCount = voteSystem.getYesCount();
 		const int noCount = voteSystem.getNoCount();
 
-		m_voteLabel.setText(
-				cl_format(
-						_("VOTE (%1): %2 yes: %3 no: %4"),
-						timeLeftSec, subject, yesCount, noCount
-				)
-		);
+		if (
+				timeLeftSec != m_shownVoteTimeLeft
+				|| yesCount != m_shownYesCount
+				|| noCount != m_shownNoCount
+				|| subject != m_shownVoteSubject
+		) {
+			m_voteLabel.setText(
+					cl_format(
+							_("VOTE (%1): %2 yes: %3 no: %4"),
+							timeLeftSec, subject, yesCount, noCount
+					)
+			);
+
+			m_shownVoteTimeLeft = timeLeftSec;
+			m_shownYesCount = yesCount;
+			m_shownNoCount = noCount;
+			m_shownVoteSubject = subject;
+		}
 
 		m_voteLabel.setPosition(CL_Pointf(10, m_voteLabel.size(p_gc).height));
 		m_voteLabel.draw(p_gc);
 
-		m_voteLabel.setPosition(CL_Pointf(10, m_voteLabel.size(p_gc).height * 2));
-		m_voteLabel.setText(_("To vote press F1 (YES) or F2 (NO)"));
-		m_voteLabel.draw(p_gc);
+		m_voteHintLabel.setPosition(CL_Pointf(10, m_voteLabel.size(p_gc).height * 2));
+		m_voteHintLabel.draw(p_gc);
 	}
 }
 
@@ -299,8 +402,8 @@ void RaceUIImpl::drawMessageBoard(CL_GraphicContext &p_gc)
 	std::vector<int> messages = board.getMessageIdsYoungerThat(VISIBLE_TIME_MS, ITEM_LIMIT);
 
 	// sort results in multimap by age
-	typedef std::multimap<unsigned, CL_String, Comparator> TMessageMap;
-	typedef std::pair<unsigned, CL_String> TMessagePair;
+	typedef std::multimap<unsigned, int, Comparator> TMessageMap;
+	typedef std::pair<unsigned, int> TMessagePair;
 
 	TMessageMap messageMap;
 
@@ -308,9 +411,18 @@ void RaceUIImpl::drawMessageBoard(CL_GraphicContext &p_gc)
 
 	foreach(int id, messages) {
 		age = board.getMessageCreationTime(id);
-		const CL_String &msg = board.getMessageString(id);
+		messageMap.insert(TMessagePair(age, id));
+	}
+
+	// forget labels of messages that are gone
+	std::map<int, CL_SharedPtr<Label> >::iterator itor = m_messageLabels.begin();
 
-		messageMap.insert(TMessagePair(age, msg));
+	while (itor != m_messageLabels.end()) {
+		if (std::find(messages.begin(), messages.end(), itor->first) == messages.end()) {
+			m_messageLabels.erase(itor++);
+		} else {
+			++itor;
+		}
 	}
 
 	// display in sorted order
@@ -319,20 +431,20 @@ void RaceUIImpl::drawMessageBoard(CL_GraphicContext &p_gc)
 
 	TMessagePair pair;
 	foreach (pair, messageMap) {
-		m_messageBoardLabel.setPosition(position);
-		m_messageBoardLabel.setText(pair.second);
+		Label &label = getMessageLabel(p_gc, pair.second);
+		label.setPosition(position);
 
 		// calculate color
 		age = now - pair.first;
 
 		if (age < VISIBLE_TIME_MS - FADE_TIME_MS) {
-			m_messageBoardLabel.setColor(CL_Colorf::white);
+			label.setColor(CL_Colorf::white);
 		} else {
 			const float alpha = 1.0f - ((age - (VISIBLE_TIME_MS - FADE_TIME_MS)) / (float) FADE_TIME_MS);
-			m_messageBoardLabel.setColor(CL_Colorf(1.0f, 1.0f, 1.0f, alpha));
+			label.setColor(CL_Colorf(1.0f, 1.0f, 1.0f, alpha));
 		}
 
-		m_messageBoardLabel.draw(p_gc);
+		label.draw(p_gc);
 		position.y += CHANGE_Y;
 	}
 
@@ -340,53 +452,62 @@ void RaceUIImpl::drawMessageBoard(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::drawLapLabel(CL_GraphicContext &p_gc)
 {
-	Game &game = Game::getInstance();
-	Player &player = game.getPlayer();
-	Race::Car &car = player.getCar();
+	const Race::CarSnapshot *playerCar = m_snapshot->getPlayerCar();
 
-	const Race::Progress &progress = m_logic->getProgressObject();
-	const int currentLap = progress.getLapNumber(car);
-	const int lapsTotal = m_logic->getLapCount();
+	if (playerCar == NULL) {
+		return;
+	}
 
-	CL_String text;
+	const int currentLap = playerCar->m_lap;
+	const int lapsTotal = m_snapshot->m_lapCount;
 
-	if (lapsTotal == 0) {
-		text = cl_format(_("Lap %1"), currentLap);
-	} else {
-		text = cl_format(_("Lap %1 / %2"), currentLap, lapsTotal);
+	if (currentLap != m_shownLap || lapsTotal != m_shownLapsTotal) {
+		if (lapsTotal == 0) {
+			m_lapLabel.setText(cl_format(_("Lap %1"), currentLap));
+		} else {
+			m_lapLabel.setText(cl_format(_("Lap %1 / %2"), currentLap, lapsTotal));
+		}
+
+		m_shownLap = currentLap;
+		m_shownLapsTotal = lapsTotal;
 	}
 
-	m_lapLabel.setText(text);
 	m_lapLabel.draw(p_gc);
 }
 
 void RaceUIImpl::drawLapTimes(CL_GraphicContext &p_gc)
 {
-	const int best = m_logic->getBestLapTime();
-	const int curr = m_logic->getCurrentLapTime();
-	const int last = m_logic->getLastLapTime();
-
-	// display times
-	Math::Time tbest(best);
-	Math::Time tcurr(curr);
-	Math::Time tlast(last);
+	const int best = m_snapshot->m_bestLapTime;
+	const int curr = m_snapshot->m_currentLapTime;
+	const int last = m_snapshot->m_lastLapTime;
 
 	// Best Time
-	if (best != 0) {
-		m_bestLapTimeLabel.setText(tbest.raceFormat());
-	} else {
-		m_bestLapTimeLabel.setText("--:--:---");
+	if (best != m_shownBestTime) {
+		if (best != 0) {
+			m_bestLapTimeLabel.setText(Math::Time(best).raceFormat());
+		} else {
+			m_bestLapTimeLabel.setText("--:--:---");
+		}
+
+		m_shownBestTime = best;
 	}
 
 	// Last Time
-	if (last != 0) {
-		m_lastLapTimeLabel.setText(tlast.raceFormat());
-	} else {
-		m_lastLapTimeLabel.setText("--:--:---");
+	if (last != m_shownLastTime) {
+		if (last != 0) {
+			m_lastLapTimeLabel.setText(Math::Time(last).raceFormat());
+		} else {
+			m_lastLapTimeLabel.setText("--:--:---");
+		}
+
+		m_shownLastTime = last;
 	}
 
 	// current time
-	m_currentLapTimeLabel.setText(tcurr.raceFormat());
+	if (curr != m_shownCurrentTime) {
+		m_currentLapTimeLabel.setText(Math::Time(curr).raceFormat());
+		m_shownCurrentTime = curr;
+	}
 
 	m_bestLapTimeTitleLabel.draw(p_gc);
 	m_lastLapTimeTitleLabel.draw(p_gc);
@@ -397,25 +518,61 @@ void RaceUIImpl::drawLapTimes(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::drawCarLabels(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
-	const int carCount = level.getCarCount();
+	const int carCount = static_cast<int>(m_snapshot->m_cars.size());
 
 	CL_Pointf pos;
 
 	for (int i = 0; i < carCount; ++i) {
 
-		const Race::Car &car = level.getCar(i);
-		pos = m_viewport->toScreen(car.getPosition());
+		const Race::CarSnapshot &car = m_snapshot->m_cars[i];
+		pos = m_viewport->toScreen(car.m_position);
 
 		pos.y += 20;
 
-		m_carLabel.setPosition(pos);
-		m_carLabel.setText(car.getOwnerPlayer().getName());
+		Label &label = getCarLabel(p_gc, i);
 
-		m_carLabel.draw(p_gc);
+		label.setPosition(pos);
+		label.setText(car.m_name);
+
+		label.draw(p_gc);
 	}
 }
 
+Label &RaceUIImpl::getCarLabel(CL_GraphicContext &p_gc, int p_index)
+{
+	while (static_cast<int>(m_carLabels.size()) <= p_index) {
+		CL_SharedPtr<Label> label(
+				new Label(CL_Pointf(), "", Label::F_REGULAR, 14)
+		);
+
+		label->setAttachPoint(Label::AP_CENTER | Label::AP_TOP);
+		label->load(p_gc);
+
+		m_carLabels.push_back(label);
+	}
+
+	return *m_carLabels[p_index];
+}
+
+Label &RaceUIImpl::getMessageLabel(CL_GraphicContext &p_gc, int p_messageId)
+{
+	CL_SharedPtr<Label> &label = m_messageLabels[p_messageId];
+
+	if (!label) {
+		label = CL_SharedPtr<Label>(
+				new Label(
+						CL_Pointf(),
+						m_logic->getMessageBoard().getMessageString(p_messageId),
+						Label::F_REGULAR, 14
+				)
+		);
+
+		label->load(p_gc);
+	}
+
+	return *label;
+}
+
 void RaceUIImpl::drawPlayerList(CL_GraphicContext &p_gc)
 {
 	m_playerList.draw(p_gc);
@@ -526,14 +683,16 @@ void RaceUIImpl::load(CL_GraphicContext &p_gc)
 	m_playerList.load(p_gc);
 	m_globMsgLabel.load(p_gc);
 	m_voteLabel.load(p_gc);
-	m_messageBoardLabel.load(p_gc);
+	m_voteHintLabel.load(p_gc);
 	m_lapLabel.load(p_gc);
-	m_carLabel.load(p_gc);
 	m_countdownLabel.load(p_gc);
 	m_scoreTable.load(p_gc);
 
 	loadLapTimeLabels(p_gc);
 
+	// car labels are not created while drawing
+	getCarLabel(p_gc, PRELOADED_CAR_LABELS - 1);
+
 	if (m_modeBasedUI) {
 		m_modeBasedUI->load(p_gc);
 	}
@@ -38,6 +38,7 @@ namespace Math {
 
 namespace Race {
 	class GameLogic;
+	class RaceSnapshot;
 }
 
 namespace Gfx {
@@ -60,6 +61,12 @@ class RaceUI : public Gfx::Drawable {
 
 		void update(unsigned p_timeElapsed);
 
+		/** Race state for car and lap dependent labels */
+		void setSnapshot(const Race::RaceSnapshot *p_snapshot);
+
+		/** Mutex to lock while reading the logic, can be NULL */
+		void setLogicMutex(CL_Mutex *p_mutex);
+
 		ScoreTable &getScoreTable();
 		SpeedMeter &getSpeedMeter();
 
@@ -47,6 +47,11 @@ class RaceUITimeTrailImpl
 		Label m_bestOnlineTimeTitleLabel;
 		Label m_bestOnlineTimeLabel;
 
+		/** Displayed time, -1 when there is no entry */
+		int m_shownTimeMs;
+
+		CL_String m_shownName;
+
 
 		RaceUITimeTrailImpl(
 				RaceUITimeTrail *p_parent, const Race::GameLogicTimeTrailOnline *p_logic);
@@ -69,7 +74,8 @@ RaceUITimeTrailImpl::RaceUITimeTrailImpl(
 		m_parent(p_parent),
 		m_logic(*p_logic),
 		m_bestOnlineTimeTitleLabel(CL_Pointf(), _("Best Online Lap"), Label::F_BOLD, 22),
-		m_bestOnlineTimeLabel(CL_Pointf(), "", Label::F_REGULAR, 22)
+		m_bestOnlineTimeLabel(CL_Pointf(), "--:--:---", Label::F_REGULAR, 22),
+		m_shownTimeMs(-1)
 {
 	positionLapTimeLabels();
 
@@ -125,12 +131,22 @@ void RaceUITimeTrailImpl::draw(CL_GraphicContext &p_gc)
 {
 	if (m_logic.hasFirstPlaceRankingEntry()) {
 		const RankingEntry &rankingEntry = m_logic.getFirstPlaceRankingEntry();
-		Math::Time bestTime(rankingEntry.timeMs);
 
-		m_bestOnlineTimeLabel.setText(
-				cl_format("%1 by %2", bestTime.raceFormat(), rankingEntry.name));
-	} else {
+		if (
+				rankingEntry.timeMs != m_shownTimeMs
+				|| rankingEntry.name != m_shownName
+		) {
+			Math::Time bestTime(rankingEntry.timeMs);
+
+			m_bestOnlineTimeLabel.setText(
+					cl_format("%1 by %2", bestTime.raceFormat(), rankingEntry.name));
+
+			m_shownTimeMs = rankingEntry.timeMs;
+			m_shownName = rankingEntry.name;
+		}
+	} else if (m_shownTimeMs != -1) {
 		m_bestOnlineTimeLabel.setText("--:--:---");
+		m_shownTimeMs = -1;
 	}
 
 	m_bestOnlineTimeTitleLabel.draw(p_gc);
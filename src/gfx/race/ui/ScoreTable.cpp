@@ -70,6 +70,16 @@ class TableRow
 
 		const Math::Time m_best, m_total;
 
+		// row texts never change, so each row keeps own labels
+
+		Gfx::Label m_posLabel;
+
+		Gfx::Label m_nickLabel;
+
+		Gfx::Label m_totalLabel;
+
+		Gfx::Label m_bestLabel;
+
 
 		TableRow(
 				int p_place,
@@ -80,19 +90,31 @@ class TableRow
 			m_place(p_place),
 			m_name(p_name),
 			m_best(p_best),
-			m_total(p_total)
+			m_total(p_total),
+			m_posLabel(
+					CL_Pointf(), CL_StringHelp::int_to_local8(p_place),
+					Gfx::Label::F_PIXEL, p_place <= 3 ? 108 : 72
+			),
+			m_nickLabel(CL_Pointf(), p_name, Gfx::Label::F_PIXEL, 36),
+			m_totalLabel(
+					CL_Pointf(), cl_format(_("TIME: %1"), p_total.raceFormat()),
+					Gfx::Label::F_PIXEL, 24
+			),
+			m_bestLabel(
+					CL_Pointf(), cl_format(_("BEST: %1"), p_best.raceFormat()),
+					Gfx::Label::F_PIXEL, 24
+			)
+		{
+			m_posLabel.setAttachPoint(Gfx::Label::AP_CENTER);
+			m_nickLabel.setAttachPoint(Gfx::Label::AP_LEFT | Gfx::Label::AP_CENTER);
+			m_totalLabel.setAttachPoint(Gfx::Label::AP_RIGHT | Gfx::Label::AP_CENTER);
+			m_bestLabel.setAttachPoint(Gfx::Label::AP_RIGHT | Gfx::Label::AP_CENTER);
+		}
 
-		{ /* empty */ }
 
+		void load(CL_GraphicContext &p_gc);
 
-		void draw(
-				CL_GraphicContext &p_gc,
-				float p_animProgress,
-				Gfx::Label &p_highPosLabel,
-				Gfx::Label &p_lowPosLabel,
-				Gfx::Label &p_nickLabel,
-				Gfx::Label &p_timeLabel
-		);
+		void draw(CL_GraphicContext &p_gc, float p_animProgress);
 
 
 }; // class TableRow
@@ -126,16 +148,6 @@ class ScoreTableImpl
 
 		std::vector<TableRow*> m_rows;
 
-		// labels
-
-		Gfx::Label m_highPosLabel;
-
-		Gfx::Label m_lowPosLabel;
-
-		Gfx::Label m_nickLabel;
-
-		Gfx::Label m_timeLabel;
-
 		// animation progress
 		Math::Float m_animProgress;
 
@@ -143,10 +155,6 @@ class ScoreTableImpl
 
 		ScoreTableImpl(const Race::GameLogic *p_logic) :
 			m_logic(p_logic),
-			m_highPosLabel(CL_Pointf(), "", Gfx::Label::F_PIXEL, 108),
-			m_lowPosLabel(CL_Pointf(), "", Gfx::Label::F_PIXEL, 72),
-			m_nickLabel(CL_Pointf(), "", Gfx::Label::F_PIXEL, 36),
-			m_timeLabel(CL_Pointf(), "", Gfx::Label::F_PIXEL, 24),
 			m_animProgress(1.0f)
 		{
 			// calculate y positions
@@ -187,34 +195,29 @@ ScoreTable::~ScoreTable()
 void ScoreTable::load(CL_GraphicContext &p_gc)
 {
 	Drawable::load(p_gc);
-	m_impl->m_highPosLabel.load(p_gc);
-	m_impl->m_lowPosLabel.load(p_gc);
-	m_impl->m_nickLabel.load(p_gc);
-	m_impl->m_timeLabel.load(p_gc);
 }
 
 void ScoreTable::draw(CL_GraphicContext &p_gc)
 {
 	foreach (TableRow *row, m_impl->m_rows) {
-		row->draw(
-				p_gc,
-				m_impl->m_animProgress.get(),
-				m_impl->m_highPosLabel,
-				m_impl->m_lowPosLabel,
-				m_impl->m_nickLabel,
-				m_impl->m_timeLabel
-		);
+		// rows are built when race finishes
+		if (!row->m_posLabel.isLoaded()) {
+			row->load(p_gc);
+		}
+
+		row->draw(p_gc, m_impl->m_animProgress.get());
 	}
 }
 
-void TableRow::draw(
-		CL_GraphicContext &p_gc,
-		float p_animProgress,
-		Gfx::Label &p_highPosLabel,
-		Gfx::Label &p_lowPosLabel,
-		Gfx::Label &p_nickLabel,
-		Gfx::Label &p_timeLabel
-)
+void TableRow::load(CL_GraphicContext &p_gc)
+{
+	m_posLabel.load(p_gc);
+	m_nickLabel.load(p_gc);
+	m_totalLabel.load(p_gc);
+	m_bestLabel.load(p_gc);
+}
+
+void TableRow::draw(CL_GraphicContext &p_gc, float p_animProgress)
 {
 	// place position offset (from entry center)
 	static const CL_Vec2f POS_OFFSET(-300.0f, 0.0f);
@@ -247,42 +250,22 @@ void TableRow::draw(
 
 	const CL_Pointf entryCenter(Stage::getWidth() / 2, y + ENTRY_HEIGHT / 2);
 
-	Gfx::Label *posLabel;
-
-	if (m_place <= 3) {
-		posLabel = &p_highPosLabel;
-	} else {
-		posLabel = &p_lowPosLabel;
-	}
-
 	// draw position label
-	posLabel->setPosition(entryCenter + POS_OFFSET);
-	posLabel->setAttachPoint(Gfx::Label::AP_CENTER);
-	posLabel->setText(CL_StringHelp::int_to_local8(m_place));
-
-	posLabel->draw(p_gc);
+	m_posLabel.setPosition(entryCenter + POS_OFFSET);
+	m_posLabel.draw(p_gc);
 
 	// draw nick label
-	p_nickLabel.setPosition(entryCenter + NICK_OFFSET);
-	p_nickLabel.setAttachPoint(Gfx::Label::AP_LEFT | Gfx::Label::AP_CENTER);
-	p_nickLabel.setText(m_name);
-
-	p_nickLabel.draw(p_gc);
+	m_nickLabel.setPosition(entryCenter + NICK_OFFSET);
+	m_nickLabel.draw(p_gc);
 
 	// draw times
-	const float th2 = p_timeLabel.height() / 2.0f;
-
-	p_timeLabel.setAttachPoint(Gfx::Label::AP_RIGHT | Gfx::Label::AP_CENTER);
-
-	p_timeLabel.setPosition(entryCenter + TIME_OFFSET + CL_Vec2f(0.0f, -th2));
-	p_timeLabel.setText(cl_format(_("TIME: %1"), m_total.raceFormat()));
-
-	p_timeLabel.draw(p_gc);
+	const float th2 = m_totalLabel.height() / 2.0f;
 
-	p_timeLabel.setPosition(entryCenter + TIME_OFFSET + CL_Vec2f(0.0f, +th2));
-	p_timeLabel.setText(cl_format(_("BEST: %1"), m_best.raceFormat()));
+	m_totalLabel.setPosition(entryCenter + TIME_OFFSET + CL_Vec2f(0.0f, -th2));
+	m_totalLabel.draw(p_gc);
 
-	p_timeLabel.draw(p_gc);
+	m_bestLabel.setPosition(entryCenter + TIME_OFFSET + CL_Vec2f(0.0f, +th2));
+	m_bestLabel.draw(p_gc);
 }
 
 void ScoreTable::rebuild()
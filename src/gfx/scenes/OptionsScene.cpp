@@ -70,6 +70,9 @@ OptionScene::OptionScene(CL_GUIComponent *p_parent) :
 	m_soundLabel(this),
 	m_soundValueLabel(this),
 	m_wsadCheckBox(this),
+	m_motionBlurLabel(this),
+	m_motionBlurComboBox(this),
+	m_motionBlurMenu(),
 	m_soundSlider(this),
 	m_errorLabel(this),
 	m_cancelButton(this),
@@ -121,6 +124,22 @@ OptionScene::OptionScene(CL_GUIComponent *p_parent) :
 	x = START_X;
 	y += V_MARGIN;
 
+	m_motionBlurLabel.set_text(_("Motion blur"));
+	m_motionBlurLabel.set_geometry(CL_Rect(x, y, x + LABEL_WIDTH, y + LABEL_HEIGHT));
+
+	x += LABEL_WIDTH + H_MARGIN;
+
+	// order must follow CG_MOTION_BLUR_* values
+	m_motionBlurMenu.insert_item(_("Off"));
+	m_motionBlurMenu.insert_item(_("High quality"));
+	m_motionBlurMenu.insert_item(_("Fast"));
+	m_motionBlurComboBox.set_popup_menu(m_motionBlurMenu);
+	m_motionBlurComboBox.set_geometry(CL_Rect(x, y, x + COMBOBOX_WIDTH, y + COMBOBOX_HEIGHT));
+	m_motionBlurComboBox.set_selected_item(CG_MOTION_BLUR_BATCHED);
+
+	x = START_X;
+	y += V_MARGIN;
+
 	m_soundLabel.set_text(_("Sound"));
 	m_soundLabel.set_geometry(CL_Rect(x, y, x + LABEL_WIDTH, y + LABEL_HEIGHT));
 	m_soundLabel.set_enabled(false);
@@ -205,6 +224,9 @@ void OptionScene::pushed()
 		m_nameLineEdit.set_text(Properties::getString(CG_PLAYER_NAME, ""));
 		m_fullScreenCheckBox.set_checked(Properties::getBool(CG_FULLSCREEN, false));
 		m_wsadCheckBox.set_checked(Properties::getBool(CG_USE_WASD, false));
+		m_motionBlurComboBox.set_selected_item(
+				Properties::getInt(CG_MOTION_BLUR, CG_MOTION_BLUR_BATCHED)
+		);
 		m_soundSlider.set_position(Properties::getInt(CG_SOUND_VOLUME, 100));
 		setSliderLabelValue();
 	}
@@ -256,6 +278,7 @@ void OptionScene::useDefaultSetings()
 	m_resolutionComboBox.set_selected_item(0);
 	m_fullScreenCheckBox.set_checked(false);
 	m_wsadCheckBox.set_checked(false);
+	m_motionBlurComboBox.set_selected_item(CG_MOTION_BLUR_BATCHED);
 	m_soundSlider.set_position(100);
 	setSliderLabelValue();
 	m_errorLabel.set_text("");
@@ -290,3 +313,8 @@ bool OptionScene::getWASD() const
 {
 	return m_wsadCheckBox.is_checked(); 
 }
+
+int OptionScene::getMotionBlur() const
+{
+	return m_motionBlurComboBox.get_selected_item();
+}
@@ -65,6 +65,9 @@ class OptionScene : public Gfx::GuiScene
 
 		bool getWASD() const;
 
+		/** @return One of CG_MOTION_BLUR_* values */
+		int getMotionBlur() const;
+
 	private:
 
 		std::vector<CL_Size> m_resolutions;
@@ -87,6 +90,12 @@ class OptionScene : public Gfx::GuiScene
 
 		CL_CheckBox m_wsadCheckBox;
 
+		CL_Label m_motionBlurLabel;
+
+		CL_ComboBox m_motionBlurComboBox;
+
+		CL_PopupMenu m_motionBlurMenu;
+
 		CL_Label m_soundLabel;
 
 		CL_Label m_soundValueLabel;
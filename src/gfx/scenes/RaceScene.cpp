@@ -41,7 +41,9 @@
 #include "logic/race/GameLogic.h"
 #include "logic/race/GameLogicArcadeOnline.h"
 #include "logic/race/GameLogicTimeTrailOnline.h"
+#include "logic/race/RaceSnapshot.h"
 #include "logic/race/ScoreTable.h"
+#include "logic/race/SimulationThread.h"
 #include "network/events.h"
 #include "network/packets/CarState.h"
 #include "network/packets/GameState.h"
@@ -74,12 +76,33 @@ class RaceSceneImpl
 		Race::Level *m_level;
 		bool m_levelOwner;
 
+		// threading
+
+		/** Race state given to graphics when logic runs on this thread */
+		Race::RaceSnapshot m_snapshot;
+
+		/** Logic thread, NULL when logic runs on this thread */
+		Race::SimulationThread *m_simulation;
+
+		CL_Thread m_simulationThread;
+
+		bool m_simulationStarted;
+
+		/** Guards the logic from simulation thread */
+		CL_Mutex m_logicMutex;
+
 		// input
 
 		/** Set to true if user interaction should be locked */
 		bool m_inputLock;
 
+		/**
+		 * Key states, applied to the car before each logic step.
+		 * Written by input events and read by simulation thread,
+		 * both under m_logicMutex.
+		 */
 		bool m_keyTurnLeftDown, m_keyTurnRightDown;
+		bool m_keyAccelDown, m_keyBrakeDown;
 
 		// display
 
@@ -130,13 +153,22 @@ class RaceSceneImpl
 
 		void handleInput(InputState p_state, const CL_InputEvent& p_event);
 
-		void updateCarTurn();
+		void applyInput();
+
+
+		// threading
+
+		void startSimulation();
+
+		void stopSimulation();
 
 
 		// event handlers
 
 		void onInputLock();
 
+		void onSimulationIterationStarted();
+
 		void onRaceStateChanged(int p_lapsNum);
 
 
@@ -158,9 +190,13 @@ RaceSceneImpl::RaceSceneImpl(RaceScene *p_parent) :
 		m_graphics(NULL),
 		m_level(NULL),
 		m_levelOwner(false),
+		m_simulation(NULL),
+		m_simulationStarted(false),
 		m_inputLock(false),
 		m_keyTurnLeftDown(false),
 		m_keyTurnRightDown(false),
+		m_keyAccelDown(false),
+		m_keyBrakeDown(false),
 		m_gameMenu(*p_parent),
 		m_gameMenuController(&m_logic, &m_gameMenu)
 {
@@ -258,6 +294,21 @@ void RaceSceneImpl::initCommon()
 {
 	m_graphics = new Gfx::RaceGraphics(m_logic);
 
+	if (Properties::getBool(CG_THREADED_LOGIC, false)) {
+		m_simulation = new Race::SimulationThread(m_logic, &m_logicMutex);
+
+		m_slots.connect(
+				m_simulation->sig_iterationStarted(),
+				this, &RaceSceneImpl::onSimulationIterationStarted
+		);
+
+		m_graphics->setSnapshot(&m_simulation->readSnapshot());
+		m_graphics->setLogicMutex(&m_logicMutex);
+	} else {
+		m_snapshot.capture(*m_logic);
+		m_graphics->setSnapshot(&m_snapshot);
+	}
+
 	// bind keys
 	if (Properties::getBool(CG_USE_WASD, false)) {
 		// use WASD instead of arrows
@@ -285,6 +336,8 @@ void RaceSceneImpl::destroy()
 {
 	G_ASSERT(m_initialized);
 
+	stopSimulation();
+
 	m_logic->destroy();
 
 	delete m_logic;
@@ -340,13 +393,61 @@ void RaceSceneImpl::update(unsigned p_timeElapsed)
 {
 	G_ASSERT(m_initialized);
 
-	if (m_logic) {
+	if (m_simulation) {
+		startSimulation();
+
+		// logic steps on its own, take the newest state
+		m_graphics->setSnapshot(&m_simulation->readSnapshot());
+	} else if (m_logic) {
+		applyInput();
+
 		m_logic->update(p_timeElapsed);
+		m_snapshot.capture(*m_logic);
 	}
 
 	m_graphics->update(p_timeElapsed);
 }
 
+void RaceSceneImpl::startSimulation()
+{
+	if (!m_simulationStarted) {
+		cl_log_event(LOG_DEBUG, "starting simulation thread");
+
+		m_simulationThread.start(m_simulation);
+		m_simulationStarted = true;
+	}
+}
+
+void RaceSceneImpl::stopSimulation()
+{
+	if (m_simulation == NULL) {
+		return;
+	}
+
+	if (m_simulationStarted) {
+		cl_log_event(LOG_DEBUG, "stopping simulation thread");
+
+		m_simulation->interrupt();
+		m_simulationThread.join();
+
+		m_simulationStarted = false;
+	}
+
+	delete m_simulation;
+	m_simulation = NULL;
+}
+
+void RaceSceneImpl::onSimulationIterationStarted()
+{
+	// input is sampled right before each step
+	applyInput();
+}
+
+CL_Mutex *RaceScene::getLogicMutex()
+{
+	return m_impl->m_simulation != NULL ? &m_impl->m_logicMutex : NULL;
+}
+
 void RaceScene::inputPressed(const CL_InputEvent &p_event)
 {
 	m_impl->inputPressed(p_event);
@@ -375,7 +476,6 @@ void RaceSceneImpl::handleInput(InputState p_state, const CL_InputEvent& p_event
 {
 	G_ASSERT(m_initialized);
 
-	Race::Car &car = Game::getInstance().getPlayer().getCar();
 	bool pressed;
 
 	switch (p_state) {
@@ -394,9 +494,9 @@ void RaceSceneImpl::handleInput(InputState p_state, const CL_InputEvent& p_event
 	} else if (p_event.id == m_keySteerRight) {
 		m_keyTurnRightDown = pressed;
 	} else if (p_event.id == m_keyAccel) {
-		car.setAcceleration(pressed);
+		m_keyAccelDown = pressed;
 	} else if (p_event.id == m_keyBrake) {
-		car.setBrake(pressed);
+		m_keyBrakeDown = pressed;
 	} else {
 
 		// what the fuck?! If I don't cast this logic to const GameLogic
@@ -423,6 +523,8 @@ void RaceSceneImpl::handleInput(InputState p_state, const CL_InputEvent& p_event
 #if !defined(NDEBUG)
 			case CL_KEY_R:
 				if (!pressed) {
+					const Race::Car &car = Game::getInstance().getPlayer().getCar();
+
 					std::cout << "<ref>\n\t<position x=\""
 							<< Units::toWorld(car.getPosition().x)
 							<< "\" y=\""
@@ -445,19 +547,20 @@ void RaceSceneImpl::handleInput(InputState p_state, const CL_InputEvent& p_event
 		}
 	}
 
-	updateCarTurn();
-
 #if !defined(NDEBUG)
 	// debug key bindings
 	Dbg::RaceSceneKeyBindings::handleInput(pressed, p_event);
 #endif // !NDEBUG
 }
 
-void RaceSceneImpl::updateCarTurn()
+void RaceSceneImpl::applyInput()
 {
 	G_ASSERT(m_initialized);
 
 	Race::Car &car = Game::getInstance().getPlayer().getCar();
+
+	car.setAcceleration(m_keyAccelDown);
+	car.setBrake(m_keyBrakeDown);
 	car.setTurn((int) -m_keyTurnLeftDown + (int) m_keyTurnRightDown);
 }
 
@@ -76,6 +76,8 @@ class RaceScene: public Gfx::DirectScene
 
 		virtual void poped();
 
+		virtual CL_Mutex *getLogicMutex();
+
 		const Race::GameLogic *getLogic() const;
 
 
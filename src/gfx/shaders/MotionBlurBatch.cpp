@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MotionBlurBatch.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "clanlib/core/math.h"
+#include "clanlib/core/text.h"
+#include "clanlib/display/2d.h"
+#include "clanlib/display/render.h"
+
+#include "common.h"
+#include "gfx/Stage.h"
+
+namespace Gfx
+{
+
+const CL_String BATCH_FRAG_NAME = "shaders/motionblur_batch.frag";
+const CL_String BATCH_VERT_NAME = "shaders/motionblur_batch.vert";
+
+/** Blur parameters attribute (radius, angle) */
+const int PRIARR_BLUR_PARAMS = 3;
+
+/** Must match MAX_RADIUS in motionblur_batch.frag */
+const int MAX_BLUR_RADIUS = 32;
+
+const CL_Vec4f BATCH_COLOR_WHITE(1.0f, 1.0f, 1.0f, 1.0f);
+
+/** Space between layer areas, blur samples up to radius outside of quad */
+const int AREA_MARGIN = MAX_BLUR_RADIUS + 1;
+
+class MotionBlurBatchImpl
+{
+	public:
+
+		bool m_initialized;
+		bool m_began;
+		bool m_objectBegan;
+
+		CL_ShaderObject m_vertShader;
+		CL_ShaderObject m_fragShader;
+		CL_ProgramObject m_program;
+
+		CL_FrameBuffer m_frameBuffer;
+
+		/** Screen sized layer, objects are placed in rows */
+		CL_Texture m_layer;
+
+		/** Free place of current row */
+		CL_Point m_rowPos;
+
+		int m_rowHeight;
+
+		// quads data
+
+		std::vector<CL_Vec2f> m_verts;
+		std::vector<CL_Vec4f> m_colors;
+		std::vector<CL_Vec2f> m_texCoords;
+		std::vector<CL_Vec2f> m_blurParams;
+
+		int m_quadCount;
+
+		CL_PrimitivesArray m_quads;
+
+
+		MotionBlurBatchImpl() :
+			m_initialized(false),
+			m_began(false),
+			m_objectBegan(false),
+			m_rowHeight(0),
+			m_quadCount(0)
+		{ /* empty */ }
+
+		void initialize(CL_GraphicContext &p_gc);
+		void destroy();
+
+		void begin(CL_GraphicContext &p_gc);
+		void end(CL_GraphicContext &p_gc);
+
+		void beginObject(
+				CL_GraphicContext &p_gc,
+				const CL_Rect &p_boundRect,
+				int p_radius,
+				const CL_Angle &p_angle
+		);
+
+		void endObject(CL_GraphicContext &p_gc);
+
+		/**
+		 * Finds layer place for area of p_size.
+		 *
+		 * @return false when the layer is full
+		 */
+		bool allocate(const CL_Size &p_size, CL_Point *p_pos);
+
+		void addQuad(const CL_Rect &p_screenRect, const CL_Point &p_layerPos, int p_radius, const CL_Angle &p_angle);
+};
+
+// --------------------------------------------------------
+
+MotionBlurBatch::MotionBlurBatch() :
+		m_impl(new MotionBlurBatchImpl())
+{
+	// empty
+}
+
+MotionBlurBatch::~MotionBlurBatch()
+{
+	// empty
+}
+
+// --------------------------------------------------------
+
+void MotionBlurBatch::initialize(CL_GraphicContext &p_gc)
+{
+	m_impl->initialize(p_gc);
+}
+
+void MotionBlurBatchImpl::initialize(CL_GraphicContext &p_gc)
+{
+	G_ASSERT(!m_initialized);
+
+	CL_ResourceManager *resMgr = Gfx::Stage::getResourceManager();
+
+	m_program = CL_ProgramObject(p_gc);
+
+	m_vertShader = CL_ShaderObject::load(p_gc, BATCH_VERT_NAME, resMgr);
+	m_program.attach(m_vertShader);
+
+	m_fragShader = CL_ShaderObject::load(p_gc, BATCH_FRAG_NAME, resMgr);
+	m_program.attach(m_fragShader);
+
+	m_program.bind_attribute_location(CL_PRIARR_VERTS, "Position");
+	m_program.bind_attribute_location(CL_PRIARR_COLORS, "Color0");
+	m_program.bind_attribute_location(CL_PRIARR_TEXCOORDS, "TexCoord0");
+	m_program.bind_attribute_location(PRIARR_BLUR_PARAMS, "BlurParams");
+
+	if (!m_program.link()) {
+		m_program.detach(m_vertShader);
+		m_program.detach(m_fragShader);
+
+		throw CL_Exception(
+				cl_format(
+						"error linking shader %1, %2: %3",
+						BATCH_VERT_NAME, BATCH_FRAG_NAME,
+						m_program.get_info_log()
+				)
+		);
+	}
+
+	m_frameBuffer = CL_FrameBuffer(p_gc);
+	m_layer = CL_Texture(p_gc, Stage::getWidth(), Stage::getHeight());
+
+	m_quads = CL_PrimitivesArray(p_gc);
+
+	m_initialized = true;
+}
+
+void MotionBlurBatch::destroy()
+{
+	m_impl->destroy();
+}
+
+void MotionBlurBatchImpl::destroy()
+{
+	G_ASSERT(m_initialized);
+
+	m_quads = CL_PrimitivesArray();
+	m_layer = CL_Texture();
+	m_frameBuffer = CL_FrameBuffer();
+
+	m_program.detach(m_vertShader);
+	m_program.detach(m_fragShader);
+
+	m_vertShader = CL_ShaderObject();
+	m_fragShader = CL_ShaderObject();
+
+	m_program = CL_ProgramObject();
+
+	m_initialized = false;
+}
+
+void MotionBlurBatch::begin(CL_GraphicContext &p_gc)
+{
+	m_impl->begin(p_gc);
+}
+
+void MotionBlurBatchImpl::begin(CL_GraphicContext &p_gc)
+{
+	G_ASSERT(m_initialized);
+	G_ASSERT(!m_began);
+
+	// follow window size changes
+	if (m_layer.get_width() != Stage::getWidth() || m_layer.get_height() != Stage::getHeight()) {
+		m_layer = CL_Texture(p_gc, Stage::getWidth(), Stage::getHeight());
+	}
+
+	m_frameBuffer.attach_color_buffer(0, m_layer);
+	p_gc.set_frame_buffer(m_frameBuffer);
+
+	p_gc.clear(CL_Colorf::transparent);
+
+	m_rowPos = CL_Point(AREA_MARGIN, AREA_MARGIN);
+	m_rowHeight = 0;
+
+	m_quadCount = 0;
+	m_began = true;
+}
+
+void MotionBlurBatch::beginObject(
+		CL_GraphicContext &p_gc,
+		const CL_Rect &p_boundRect,
+		int p_radius,
+		const CL_Angle &p_angle
+)
+{
+	m_impl->beginObject(p_gc, p_boundRect, p_radius, p_angle);
+}
+
+void MotionBlurBatchImpl::beginObject(
+		CL_GraphicContext &p_gc,
+		const CL_Rect &p_boundRect,
+		int p_radius,
+		const CL_Angle &p_angle
+)
+{
+	G_ASSERT(m_began);
+	G_ASSERT(!m_objectBegan);
+
+	const int radius = std::min(std::max(p_radius, 0), MAX_BLUR_RADIUS);
+
+	// blurred area is bigger than object itself
+	CL_Rect area = p_boundRect;
+	area.expand(radius);
+
+	CL_Point layerPos;
+
+	if (!allocate(area.get_size(), &layerPos)) {
+		// resolve the full layer and start again
+		end(p_gc);
+		begin(p_gc);
+
+		if (!allocate(area.get_size(), &layerPos)) {
+			// bigger than the layer, drawn in place
+			layerPos = area.get_top_left();
+		}
+	}
+
+	addQuad(area, layerPos, radius, p_angle);
+
+	// move object to its layer place, scaling taken in count
+	p_gc.push_modelview();
+
+	const CL_Mat4f &matrix = p_gc.get_modelview();
+	const float scaleX = matrix[0];
+	const float scaleY = matrix[5];
+
+	p_gc.mult_translate(
+			(layerPos.x - area.left) / scaleX,
+			(layerPos.y - area.top) / scaleY
+	);
+
+	m_objectBegan = true;
+}
+
+void MotionBlurBatch::endObject(CL_GraphicContext &p_gc)
+{
+	m_impl->endObject(p_gc);
+}
+
+void MotionBlurBatchImpl::endObject(CL_GraphicContext &p_gc)
+{
+	G_ASSERT(m_objectBegan);
+
+	p_gc.pop_modelview();
+	m_objectBegan = false;
+}
+
+bool MotionBlurBatchImpl::allocate(const CL_Size &p_size, CL_Point *p_pos)
+{
+	const int layerWidth = m_layer.get_width();
+	const int layerHeight = m_layer.get_height();
+
+	if (m_rowPos.x + p_size.width + AREA_MARGIN > layerWidth) {
+		m_rowPos.x = AREA_MARGIN;
+		m_rowPos.y += m_rowHeight + AREA_MARGIN;
+		m_rowHeight = 0;
+	}
+
+	if (
+			m_rowPos.x + p_size.width + AREA_MARGIN > layerWidth
+			|| m_rowPos.y + p_size.height + AREA_MARGIN > layerHeight
+	) {
+		return false;
+	}
+
+	*p_pos = m_rowPos;
+
+	m_rowPos.x += p_size.width + AREA_MARGIN;
+	m_rowHeight = std::max(m_rowHeight, p_size.height);
+
+	return true;
+}
+
+void MotionBlurBatchImpl::addQuad(
+		const CL_Rect &p_screenRect,
+		const CL_Point &p_layerPos,
+		int p_radius,
+		const CL_Angle &p_angle
+)
+{
+	const float w = static_cast<float>(m_layer.get_width());
+	const float h = static_cast<float>(m_layer.get_height());
+
+	// only visible part is drawn, it samples matching part of layer area
+	CL_Rect rect = p_screenRect;
+	rect.clip(CL_Rect(0, 0, m_layer.get_width(), m_layer.get_height()));
+
+	if (rect.get_width() <= 0 || rect.get_height() <= 0) {
+		return;
+	}
+
+	const CL_Vec2f shift(
+			p_layerPos.x - p_screenRect.left,
+			p_layerPos.y - p_screenRect.top
+	);
+
+	const int first = m_quadCount * 4;
+
+	if (first + 4 > static_cast<int>(m_verts.size())) {
+		m_verts.resize(first + 4);
+		m_colors.resize(first + 4, BATCH_COLOR_WHITE);
+		m_texCoords.resize(first + 4);
+		m_blurParams.resize(first + 4);
+	}
+
+	m_verts[first] = CL_Vec2f(rect.left, rect.top);
+	m_verts[first + 1] = CL_Vec2f(rect.left, rect.bottom);
+	m_verts[first + 2] = CL_Vec2f(rect.right, rect.bottom);
+	m_verts[first + 3] = CL_Vec2f(rect.right, rect.top);
+
+	const CL_Vec2f params(p_radius, p_angle.to_radians());
+
+	for (int i = first; i < first + 4; ++i) {
+		const CL_Vec2f layerVert = m_verts[i] + shift;
+
+		m_texCoords[i] = CL_Vec2f(layerVert.x / w, layerVert.y / h);
+		m_blurParams[i] = params;
+	}
+
+	++m_quadCount;
+}
+
+void MotionBlurBatch::end(CL_GraphicContext &p_gc)
+{
+	m_impl->end(p_gc);
+}
+
+void MotionBlurBatchImpl::end(CL_GraphicContext &p_gc)
+{
+	G_ASSERT(m_initialized);
+	G_ASSERT(m_began);
+	G_ASSERT(!m_objectBegan);
+
+	p_gc.reset_frame_buffer();
+	m_frameBuffer.detach_color_buffer(0, m_layer);
+
+	m_began = false;
+
+	if (m_quadCount == 0) {
+		return;
+	}
+
+	m_program.set_uniform1i("tex", 0);
+	m_program.set_uniform1i("textureWidth", m_layer.get_width());
+	m_program.set_uniform1i("textureHeight", m_layer.get_height());
+
+	// quads are in screen coordinates
+	p_gc.push_modelview();
+	p_gc.set_modelview(CL_Mat4f::identity());
+
+	m_quads.set_attributes(CL_PRIARR_VERTS, &m_verts[0]);
+	m_quads.set_attributes(CL_PRIARR_COLORS, &m_colors[0]);
+	m_quads.set_attributes(CL_PRIARR_TEXCOORDS, &m_texCoords[0]);
+	m_quads.set_attributes(PRIARR_BLUR_PARAMS, &m_blurParams[0]);
+
+	p_gc.set_texture(0, m_layer);
+	p_gc.set_program_object(m_program);
+
+	p_gc.draw_primitives(cl_quads, m_quadCount * 4, m_quads);
+
+	p_gc.reset_program_object();
+	p_gc.reset_texture(0);
+
+	p_gc.pop_modelview();
+}
+
+} // namespace
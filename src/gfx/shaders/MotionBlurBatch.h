@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <boost/utility.hpp>
+#include "clanlib/core/system.h"
+
+class CL_Angle;
+class CL_GraphicContext;
+class CL_Rect;
+
+namespace Gfx
+{
+
+class MotionBlurBatchImpl;
+
+/**
+ * Motion blur for many objects at once. Objects drawn between
+ * begin() and end() land on one screen sized layer, each in its own
+ * area, so overlapping objects do not blur each other. In end() all
+ * of them are resolved with a single shader pass. When the layer is
+ * full it is resolved earlier and filled again.
+ */
+class MotionBlurBatch : public boost::noncopyable
+{
+	public:
+		MotionBlurBatch();
+		virtual ~MotionBlurBatch();
+
+		void initialize(CL_GraphicContext &p_gc);
+		void destroy();
+
+		void begin(CL_GraphicContext &p_gc);
+		void end(CL_GraphicContext &p_gc);
+
+		/**
+		 * Starts blurred object. It should be drawn as usual until
+		 * endObject(), the modelview is moved to its layer area.
+		 *
+		 * @param p_boundRect Screen area of blurred object.
+		 * @param p_radius Blur radius in pixels.
+		 * @param p_angle Blur direction.
+		 */
+		void beginObject(
+				CL_GraphicContext &p_gc,
+				const CL_Rect &p_boundRect,
+				int p_radius,
+				const CL_Angle &p_angle
+		);
+
+		void endObject(CL_GraphicContext &p_gc);
+
+	private:
+		CL_SharedPtr<MotionBlurBatchImpl> m_impl;
+};
+
+}
+
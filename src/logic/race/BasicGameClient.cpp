@@ -28,20 +28,37 @@
 
 #include "BasicGameClient.h"
 
+#include <deque>
+#include <set>
+
+#include "common.h"
 #include "common/loglevels.h"
 #include "common/Game.h"
 #include "common/RemotePlayer.h"
 #include "logic/VoteSystem.h"
+#include "logic/race/CarStateData.h"
 #include "logic/race/GameLogic.h"
 #include "logic/race/Progress.h"
 #include "logic/race/level/Level.h"
+#include "network/CarStateCodec.h"
 #include "network/client/Client.h"
 #include "network/packets/GameState.h"
 #include "network/packets/CarState.h"
+#include "network/packets/CarStateAck.h"
+#include "network/packets/Snapshot.h"
 
 namespace Race
 {
 
+/*
+ * State is sent again after this time, so remote players have
+ * samples to interpolate and lost datagrams are healed
+ */
+const unsigned CAR_STATE_REFRESH_MS = 100;
+
+/* Local car states waiting for acknowledge, older ones are dropped */
+const unsigned PREDICTION_HISTORY_SIZE = 64;
+
 class BasicGameClientImpl
 {
 	public:
@@ -49,6 +66,8 @@ class BasicGameClientImpl
 		typedef std::map<CL_String, CL_SharedPtr<RemotePlayer> > TNamePlayerMap;
 		typedef TNamePlayerMap::iterator TNamePlayerMapItor;
 
+		typedef std::map<CL_String, Net::CarStateCodec> TNameCodecMap;
+
 		BasicGameClient *m_parent;
 		GameLogic *const m_gameLogic;
 		Net::Client &m_netClient;
@@ -56,6 +75,23 @@ class BasicGameClientImpl
 		TNamePlayerMap m_namePlayerMap;
 		CarInputState m_lastLocalCarInputState;
 
+		/** Encodes local car states */
+		Net::CarStateCodec m_localCodec;
+
+		unsigned m_lastCarStateTime;
+
+		/** Local car states sent but not acknowledged yet, oldest first */
+		std::deque<CarStateData> m_predictions;
+
+		/** Input change of local car which is already sent */
+		CarStateData m_lastInputChange;
+
+		/** Decodes remote car states */
+		TNameCodecMap m_remoteCodecs;
+
+		/** Players whose full car state was requested */
+		std::set<CL_String> m_carStateRequests;
+
 		CL_SlotContainer m_slots;
 
 
@@ -64,7 +100,11 @@ class BasicGameClientImpl
 
 		void update();
 		void updatePlayerCarRemoteState();
-		void sendCarState(const Race::Car &p_car);
+		void sendCarState(Race::Car &p_car);
+		void sendCarState(Race::Car &p_car, const CarStateData &p_state);
+
+		/** Rewinds local car to p_state and replays inputs sent since then */
+		void reconcile(Race::Car &p_car, const CarStateData &p_state);
 
 		void onPlayerJoined(const CL_String &p_name);
 		bool playerExists(const CL_String &p_name);
@@ -76,10 +116,16 @@ class BasicGameClientImpl
 		void removePlayerCarFromGame(RemotePlayer &p_remotePlayer);
 		
 		void onCarStateReceived(const Net::CarState &p_carState);
+		void onCarStateRequested(const CL_String &p_name);
+		void onCarStateAcknowledged(const Net::CarStateAck &p_ack);
+		void onSnapshotReceived(const Net::Snapshot &p_snapshot);
 
 		void applyGameState(const Net::GameState &p_gameState);
 		void positionLocalPlayerCar(const Net::CarState &p_carState);
-		void applyCarState(Race::Car &p_car, const Net::CarState &p_carState);
+		bool applyCarState(
+				Race::Car &p_car,
+				Net::CarStateCodec &p_codec,
+				const Net::CarState &p_carState);
 		
 		void onRaceStartReceived(const CL_Pointf &p_position, const CL_Angle &p_angle);
 
@@ -100,7 +146,8 @@ BasicGameClient::BasicGameClient(GameLogic *p_gameLogic) :
 BasicGameClientImpl::BasicGameClientImpl(BasicGameClient *p_parent, GameLogic *p_gameLogic) :
 		m_parent(p_parent),
 		m_gameLogic(p_gameLogic),
-		m_netClient(Game::getInstance().getNetworkConnection())
+		m_netClient(Game::getInstance().getNetworkConnection()),
+		m_lastCarStateTime(0)
 {
 	m_slots.connect(
 			m_netClient.sig_playerJoined(),
@@ -114,6 +161,18 @@ BasicGameClientImpl::BasicGameClientImpl(BasicGameClient *p_parent, GameLogic *p
 			m_netClient.sig_carStateReceived(),
 			this, &BasicGameClientImpl::onCarStateReceived);
 
+	m_slots.connect(
+			m_netClient.sig_snapshotReceived(),
+			this, &BasicGameClientImpl::onSnapshotReceived);
+
+	m_slots.connect(
+			m_netClient.sig_carStateRequested(),
+			this, &BasicGameClientImpl::onCarStateRequested);
+
+	m_slots.connect(
+			m_netClient.sig_carStateAcknowledged(),
+			this, &BasicGameClientImpl::onCarStateAcknowledged);
+
 	m_slots.connect(
 			m_netClient.sig_raceStartReceived(),
 			this, &BasicGameClientImpl::onRaceStartReceived);
@@ -148,7 +207,9 @@ void BasicGameClient::update()
 
 void BasicGameClientImpl::update()
 {
+	// inputs must be in history before acknowledges are replayed
 	updatePlayerCarRemoteState();
+	m_netClient.update();
 }
 
 void BasicGameClientImpl::updatePlayerCarRemoteState()
@@ -158,23 +219,63 @@ void BasicGameClientImpl::updatePlayerCarRemoteState()
 	Race::Car &localCar = localPlayer.getCar();
 
 	const CarInputState &currentCarState = localCar.getInputState();
-	if (m_lastLocalCarInputState != currentCarState) {
+	const CarStateData &inputChange = localCar.getInputChangeState();
+
+	// state is repeated from time to time even when input doesn't change
+	const bool refresh = CL_System::get_time() - m_lastCarStateTime >= CAR_STATE_REFRESH_MS;
+
+	if (inputChange != m_lastInputChange) {
+		// send the state from the moment of change, so the
+		// server replays each iteration with the right input
+		m_lastInputChange = inputChange;
+		sendCarState(localCar, inputChange);
+	} else if (m_lastLocalCarInputState != currentCarState || refresh) {
+		// input is set, but not used by any iteration yet
 		sendCarState(localCar);
-		m_lastLocalCarInputState = currentCarState;
 	}
+
+	m_lastLocalCarInputState = currentCarState;
 }
 
-void BasicGameClientImpl::sendCarState(const Race::Car &p_car)
+void BasicGameClientImpl::sendCarState(Race::Car &p_car)
 {
+	CarStateData state;
+	p_car.captureState(&state);
+
+	// continue from the quantized state, so the server
+	// replays physics from exactly the same values
+	p_car.applyState(state);
+
+	sendCarState(p_car, state);
+}
+
+void BasicGameClientImpl::sendCarState(Race::Car &p_car, const CarStateData &p_state)
+{
+	// keep the state until server acknowledges it
+	m_predictions.push_back(p_state);
+
+	if (m_predictions.size() > PREDICTION_HISTORY_SIZE) {
+		m_predictions.pop_front();
+	}
+
 	CL_NetGameEvent gameStateEvent("");
-	p_car.serialize(&gameStateEvent);
+
+	if (m_netClient.isDatagramChannelOpen()) {
+		// each datagram must be readable on its own
+		m_localCodec.setState(p_state);
+		gameStateEvent.add_argument(m_localCodec.encodeFull());
+	} else {
+		gameStateEvent.add_argument(m_localCodec.encode(p_state));
+	}
+
+	m_lastCarStateTime = CL_System::get_time();
 
 	const Player &carOwner = p_car.getOwnerPlayer();
 	const CL_String &carOwnerName = carOwner.getName();
 
 	Net::CarState carStatePacket;
 	carStatePacket.setSerializedData(gameStateEvent);
-	carStatePacket.setIterationId(p_car.getIterationId());
+	carStatePacket.setIterationId(p_state.get(CarStateData::F_ITERATION));
 	carStatePacket.setName(carOwnerName);
 
 	m_netClient.sendCarState(carStatePacket);
@@ -228,6 +329,9 @@ void BasicGameClientImpl::removePlayer(const CL_String &p_name)
 	CL_SharedPtr<RemotePlayer> remotePlayer = m_namePlayerMap[p_name];
 	m_namePlayerMap.erase(p_name);
 
+	m_remoteCodecs.erase(p_name);
+	m_carStateRequests.erase(p_name);
+
 	removePlayerCarFromGame(*remotePlayer);
 }
 
@@ -248,11 +352,101 @@ void BasicGameClientImpl::onCarStateReceived(const Net::CarState &p_carState)
 	if (playerExists(playerName)) {
 		RemotePlayer &remotePlayer = *m_namePlayerMap[playerName];
 		Race::Car &car = remotePlayer.getCar();
-		
-		applyCarState(car, p_carState);
+
+		if (applyCarState(car, m_remoteCodecs[playerName], p_carState)) {
+			m_carStateRequests.erase(playerName);
+		} else if (m_carStateRequests.count(playerName) == 0) {
+			// lost track of the state stream, start over from full state
+			cl_log_event(LOG_DEBUG, "requesting full car state of '%1'", playerName);
+
+			m_netClient.sendCarStateRequest(playerName);
+			m_carStateRequests.insert(playerName);
+		}
 	}
 }
 
+void BasicGameClientImpl::onSnapshotReceived(const Net::Snapshot &p_snapshot)
+{
+	// snapshot contains also local car, it is skipped as unknown player
+	const int count = p_snapshot.getCarStateCount();
+
+	for (int i = 0; i < count; ++i) {
+		onCarStateReceived(p_snapshot.getCarState(i));
+	}
+}
+
+void BasicGameClientImpl::onCarStateRequested(const CL_String &p_name)
+{
+	Game &game = Game::getInstance();
+
+	if (p_name == game.getPlayer().getName()) {
+		m_localCodec.reset();
+		sendCarState(game.getPlayerCar());
+	}
+}
+
+void BasicGameClientImpl::onCarStateAcknowledged(const Net::CarStateAck &p_ack)
+{
+	Net::CarStateCodec codec;
+	CarStateData state;
+
+	if (!codec.decode(p_ack.getData(), &state)) {
+		return;
+	}
+
+	const int32_t iterId = state.get(CarStateData::F_ITERATION);
+
+	// acknowledges can come in different order or refer to states
+	// already dropped, such ones are ignored
+	std::deque<CarStateData>::iterator itor = m_predictions.begin();
+
+	while (itor != m_predictions.end() && itor->get(CarStateData::F_ITERATION) != iterId) {
+		++itor;
+	}
+
+	if (itor == m_predictions.end()) {
+		return;
+	}
+
+	const bool predicted = *itor == state;
+	m_predictions.erase(m_predictions.begin(), itor + 1);
+
+	if (!predicted) {
+		cl_log_event(LOG_DEBUG, "local car mispredicted at iteration %1", iterId);
+		reconcile(Game::getInstance().getPlayerCar(), state);
+	}
+}
+
+void BasicGameClientImpl::reconcile(Race::Car &p_car, const CarStateData &p_state)
+{
+	const int32_t iterId = p_car.getIterationId();
+	const CarInputState input = p_car.getInputState();
+
+	try {
+		p_car.applyState(p_state);
+
+		// replay each input from the iteration it was used first,
+		// states waiting for acknowledge become corrected predictions
+		foreach (CarStateData &prediction, m_predictions) {
+			p_car.updateToIteration(prediction.get(CarStateData::F_ITERATION));
+			p_car.applyInput(prediction);
+			p_car.captureState(&prediction);
+		}
+
+		p_car.updateToIteration(iterId);
+	} catch (const CL_Exception &e) {
+		cl_log_event(LOG_WARN, "cannot replay local car: %1", e.message);
+		m_predictions.clear();
+	}
+
+	p_car.setAcceleration(input.accel);
+	p_car.setBrake(input.brake);
+	p_car.setTurn(input.turn);
+
+	// input changes made by replay are not new ones
+	m_lastInputChange = p_car.getInputChangeState();
+}
+
 void BasicGameClient::applyGameState(const Net::GameState &p_gameState)
 {
 	m_impl->applyGameState(p_gameState);
@@ -269,14 +463,21 @@ void BasicGameClientImpl::applyGameState(const Net::GameState &p_gameState)
 	for (int i = 0; i < playerCount; ++i) {
 		const CL_String &playerName = p_gameState.getPlayerName(i);
 		
+		// missing car states come with following snapshots
+		const bool hasCarState = p_gameState.hasCarState(i);
 		const Net::CarState &carState = p_gameState.getCarState(i);
 		
 		if (playerName == localPlayerName) {
-			positionLocalPlayerCar(carState);
+			if (hasCarState) {
+				positionLocalPlayerCar(carState);
+			}
 		} else {
 			RemotePlayer &remotePlayer = createNewPlayer(playerName);
-			Race::Car &remotePlayerCar = remotePlayer.getCar();
-			applyCarState(remotePlayerCar, carState);
+
+			if (hasCarState) {
+				Race::Car &remotePlayerCar = remotePlayer.getCar();
+				applyCarState(remotePlayerCar, m_remoteCodecs[playerName], carState);
+			}
 		}
 	}
 }
@@ -285,15 +486,29 @@ void BasicGameClientImpl::positionLocalPlayerCar(const Net::CarState &p_carState
 {
 	Game &game = Game::getInstance();
 	Race::Car &localPlayerCar = game.getPlayerCar();
-	
-	applyCarState(localPlayerCar, p_carState);
+
+	// server decodes next local state against its own copy, send it in full
+	Net::CarStateCodec codec;
+	applyCarState(localPlayerCar, codec, p_carState);
+
+	m_localCodec.reset();
+	m_predictions.clear();
 }
 
-void BasicGameClientImpl::applyCarState(
-Race::Car &p_car, const Net::CarState &p_carState)
+bool BasicGameClientImpl::applyCarState(
+		Race::Car &p_car,
+		Net::CarStateCodec &p_codec,
+		const Net::CarState &p_carState)
 {
-	CL_NetGameEvent serializedCarData = p_carState.getSerializedData();
-	p_car.deserialize(serializedCarData);
+	const CL_NetGameEvent data = p_carState.getSerializedData();
+	CarStateData state;
+
+	if (data.get_argument_count() != 1 || !p_codec.decode(data.get_argument(0), &state)) {
+		return false;
+	}
+
+	p_car.applyState(state);
+	return true;
 }
 
 void BasicGameClientImpl::onRaceStartReceived(const CL_Pointf &p_position, const CL_Angle &p_angle)
@@ -304,6 +519,8 @@ void BasicGameClientImpl::onRaceStartReceived(const CL_Pointf &p_position, const
 	localPlayerCar.setPosition(p_position);
 	localPlayerCar.setAngle(p_angle);
 
+	// car was moved, nothing to replay from older states
+	m_predictions.clear();
 	sendCarState(localPlayerCar);
 
 	m_gameLogic->restartRace();
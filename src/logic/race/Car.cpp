@@ -33,7 +33,9 @@
 #include "Car.h"
 
 #include "common.h"
+#include "common/BitStream.h"
 #include "common/workarounds.h"
+#include "logic/race/CarStateData.h"
 #include "gfx/Stage.h"
 #include "gfx/DebugLayer.h"
 #include "logic/race/level/Level.h"
@@ -49,6 +51,21 @@ const int CAR_WIDTH = 18;
 /* Car height in pixels */
 const int CAR_HEIGHT = 24;
 
+/* Serialized state format, bump on every layout change */
+const unsigned STATE_FORMAT_VERSION = 1;
+
+/* Position is stored with 1/256 pixel precision */
+const float POSITION_SCALE = 256.0f;
+
+/* Speeds and move vector up to +-32 pixels per iteration */
+const float SPEED_SCALE = 4096.0f;
+
+/* Turn values from -1.0 to 1.0, integers stay exact */
+const float TURN_SCALE = 2047.0f;
+
+/* Damage from 0.0 to 1.0 */
+const float DAMAGE_SCALE = 1023.0f;
+
 class CarImpl
 {
 	public:
@@ -89,6 +106,12 @@ class CarImpl
 		/** Locked state. If true then car shoudn't move. */
 		bool m_inputLocked;
 
+		/** Input used by the last iteration */
+		CarInputState m_stepInputState;
+
+		/** State from the moment when input has changed */
+		CarStateData m_inputChangeState;
+
 
 		// physics
 
@@ -120,6 +143,8 @@ class CarImpl
 			m_chocking(false),
 			m_inputState(),
 			m_inputLocked(false),
+			m_stepInputState(),
+			m_inputChangeState(),
 			m_phySpeedDelta(0.0f),
 			m_phyWheelsTurn(0.0f)
 		{ init(); }
@@ -141,9 +166,13 @@ class CarImpl
 		CL_Angle vecToAngle(const CL_Vec2f &p_vec);
 };
 
-CL_String floatToHex(float p_num);
+int quantize(float p_value, float p_scale, int p_bitCount);
 
-float hexToFloat(const CL_String &p_str);
+float dequantize(int p_value, float p_scale);
+
+unsigned quantizeAngle(const CL_Angle &p_angle);
+
+float dequantizeAngle(unsigned p_value);
 
 Car::Car(Player *p_owner) :
 		m_impl(new CarImpl(this, p_owner))
@@ -202,6 +231,10 @@ void Car::updateToIteration(int32_t p_targetIterId)
 	static const int DELTA_LIMIT = 10000;
 
 
+	if (p_targetIterId == m_impl->m_iterId) {
+		return;
+	}
+
 	// get the needed iterations count
 	int count;
 
@@ -291,6 +324,13 @@ void CarImpl::update1_60() {
 	static const float LOWER_SPEED_TURN_REDUCTION = 2.0f;
 
 
+	// remember where the input has changed, so this
+	// iteration can be replayed with exactly the same input
+	if (m_inputState != m_stepInputState) {
+		m_base->captureState(&m_inputChangeState);
+		m_stepInputState = m_inputState;
+	}
+
 	// increase the iteration id
 	// be aware of 32-bit integer limit
 	if (m_iterId != std::numeric_limits<int32_t>::max()) {
@@ -502,52 +542,125 @@ void Car::applyCollision(const CL_LineSegment2f &p_seg)
 
 }
 
-CL_String floatToHex(float p_num)
+int quantize(float p_value, float p_scale, int p_bitCount)
 {
-	G_ASSERT(sizeof(float) == sizeof(u_int32_t));
+	const int limit = (1 << (p_bitCount - 1)) - 1;
+	const int value = static_cast<int>(floor(p_value * p_scale + 0.5f));
 
-	u_int32_t num = *reinterpret_cast<u_int32_t*>(&p_num);
-	return Math::Integer::toHex(num);
+	return Math::Integer::clamp(value, -limit, limit);
 }
 
-float hexToFloat(const CL_String &p_str)
+float dequantize(int p_value, float p_scale)
 {
-	int result = Math::Integer::fromHex(p_str);
-	return *reinterpret_cast<float*>(&result);
+	return p_value / p_scale;
 }
 
-void Car::serialize(CL_NetGameEvent *p_event) const
+unsigned quantizeAngle(const CL_Angle &p_angle)
+{
+	static const float STEPS = 1 << CarStateData::ANGLE_BITS;
+
+	CL_Angle angle(p_angle);
+	Workarounds::clAngleNormalize(&angle);
+
+	const unsigned value =
+			static_cast<unsigned>(floor(angle.to_radians() / (2 * CL_PI) * STEPS + 0.5f));
+
+	return value & ((1 << CarStateData::ANGLE_BITS) - 1);
+}
+
+float dequantizeAngle(unsigned p_value)
 {
-	// save iteration counter
-	p_event->add_argument(m_impl->m_iterId);
+	static const float STEPS = 1 << CarStateData::ANGLE_BITS;
+	return p_value * (2 * CL_PI) / STEPS;
+}
+
+void Car::captureState(CarStateData *p_state) const
+{
+	const int turn = quantize(m_impl->m_inputState.turn, TURN_SCALE, CarStateData::TURN_BITS);
+
+	unsigned input = 0;
+	input |= m_impl->m_inputState.accel ? 1 : 0;
+	input |= m_impl->m_inputState.brake ? 2 : 0;
+	input |= m_impl->m_inputLocked ? 4 : 0;
+	input |= (turn & ((1 << CarStateData::INPUT_TURN_BITS) - 1)) << 3;
 
-	// save inputs
-	p_event->add_argument(CL_NetGameEventValue(m_impl->m_inputState.accel));
-	p_event->add_argument(CL_NetGameEventValue(m_impl->m_inputState.brake));
-	p_event->add_argument(floatToHex(m_impl->m_inputState.turn));
-	p_event->add_argument(CL_NetGameEventValue(m_impl->m_inputLocked));
+	p_state->set(CarStateData::F_ITERATION, m_impl->m_iterId);
+	p_state->set(CarStateData::F_INPUT, input);
 
 	// corpse state
-	p_event->add_argument(floatToHex(m_impl->m_position.x));
-	p_event->add_argument(floatToHex(m_impl->m_position.y));
-	p_event->add_argument(floatToHex(m_impl->m_rotation.to_radians()));
-	p_event->add_argument(floatToHex(m_impl->m_speed));
+	p_state->set(CarStateData::F_POSITION_X, static_cast<int>(floor(m_impl->m_position.x * POSITION_SCALE + 0.5f)));
+	p_state->set(CarStateData::F_POSITION_Y, static_cast<int>(floor(m_impl->m_position.y * POSITION_SCALE + 0.5f)));
+	p_state->set(CarStateData::F_ROTATION, quantizeAngle(m_impl->m_rotation));
+	p_state->set(CarStateData::F_SPEED, quantize(m_impl->m_speed, SPEED_SCALE, CarStateData::SPEED_BITS));
 
 	// physics parameters
-	p_event->add_argument(floatToHex(m_impl->m_phyMoveRot.to_radians()));
-	p_event->add_argument(floatToHex(m_impl->m_phyMoveVec.x));
-	p_event->add_argument(floatToHex(m_impl->m_phyMoveVec.y));
-	p_event->add_argument(floatToHex(m_impl->m_phySpeedDelta));
-	p_event->add_argument(floatToHex(m_impl->m_phyWheelsTurn));
+	p_state->set(CarStateData::F_MOVE_ROTATION, quantizeAngle(m_impl->m_phyMoveRot));
+	p_state->set(CarStateData::F_MOVE_X, quantize(m_impl->m_phyMoveVec.x, SPEED_SCALE, CarStateData::SPEED_BITS));
+	p_state->set(CarStateData::F_MOVE_Y, quantize(m_impl->m_phyMoveVec.y, SPEED_SCALE, CarStateData::SPEED_BITS));
+	p_state->set(CarStateData::F_SPEED_DELTA, quantize(m_impl->m_phySpeedDelta, SPEED_SCALE, CarStateData::SPEED_BITS));
+	p_state->set(CarStateData::F_WHEELS_TURN, quantize(m_impl->m_phyWheelsTurn, TURN_SCALE, CarStateData::TURN_BITS));
 
-	p_event->add_argument(floatToHex(m_impl->m_damage));
+	// damage is never negative, so its sign bit is not stored
+	p_state->set(CarStateData::F_DAMAGE, quantize(m_impl->m_damage, DAMAGE_SCALE, CarStateData::DAMAGE_BITS + 1));
 }
 
-void Car::deserialize(const CL_NetGameEvent &p_event)
+void Car::applyState(const CarStateData &p_state)
 {
-	static const unsigned ARGUMENT_COUNT = 15;
+	m_impl->m_iterId = p_state.get(CarStateData::F_ITERATION);
+
+	applyInput(p_state);
+
+	m_impl->m_position.x = p_state.get(CarStateData::F_POSITION_X) / POSITION_SCALE;
+	m_impl->m_position.y = p_state.get(CarStateData::F_POSITION_Y) / POSITION_SCALE;
+	m_impl->m_rotation.set_radians(dequantizeAngle(p_state.get(CarStateData::F_ROTATION)));
+	m_impl->m_speed = dequantize(p_state.get(CarStateData::F_SPEED), SPEED_SCALE);
 
-	if (p_event.get_argument_count() != ARGUMENT_COUNT) {
+	m_impl->m_phyMoveRot.set_radians(dequantizeAngle(p_state.get(CarStateData::F_MOVE_ROTATION)));
+	m_impl->m_phyMoveVec.x = dequantize(p_state.get(CarStateData::F_MOVE_X), SPEED_SCALE);
+	m_impl->m_phyMoveVec.y = dequantize(p_state.get(CarStateData::F_MOVE_Y), SPEED_SCALE);
+	m_impl->m_phySpeedDelta = dequantize(p_state.get(CarStateData::F_SPEED_DELTA), SPEED_SCALE);
+	m_impl->m_phyWheelsTurn = dequantize(p_state.get(CarStateData::F_WHEELS_TURN), TURN_SCALE);
+
+	m_impl->m_damage = dequantize(p_state.get(CarStateData::F_DAMAGE), DAMAGE_SCALE);
+}
+
+void Car::applyInput(const CarStateData &p_state)
+{
+	const unsigned input = p_state.get(CarStateData::F_INPUT);
+
+	// turn is the sign-extended upper part of input field
+	int turn = input >> 3;
+	if (turn & (1 << (CarStateData::INPUT_TURN_BITS - 1))) {
+		turn -= 1 << CarStateData::INPUT_TURN_BITS;
+	}
+
+	m_impl->m_inputState.accel = (input & 1) != 0;
+	m_impl->m_inputState.brake = (input & 2) != 0;
+	m_impl->m_inputLocked = (input & 4) != 0;
+	m_impl->m_inputState.turn = dequantize(turn, TURN_SCALE);
+}
+
+const CarStateData &Car::getInputChangeState() const
+{
+	return m_impl->m_inputChangeState;
+}
+
+void Car::serialize(CL_NetGameEvent *p_event) const
+{
+	CarStateData state;
+	captureState(&state);
+
+	BitWriter writer;
+
+	writer.writeBits(STATE_FORMAT_VERSION, 8);
+	state.write(writer);
+
+	p_event->add_argument(writer.getData());
+}
+
+void Car::deserialize(const CL_NetGameEvent &p_event)
+{
+	if (p_event.get_argument_count() != 1) {
 		// when serialize data is invalid don't do anything
 		cl_log_event(
 				LOG_DEBUG,
@@ -558,31 +671,26 @@ void Car::deserialize(const CL_NetGameEvent &p_event)
 		return;
 	}
 
-	int idx = 0;
+	const CL_String8 data = p_event.get_argument(0);
+	BitReader reader(data);
 
-	// load iteration counter
-	m_impl->m_iterId = p_event.get_argument(idx++);
+	const unsigned version = reader.readBits(8);
 
-	// saved inputs
-	m_impl->m_inputState.accel = p_event.get_argument(idx++);
-	m_impl->m_inputState.brake = p_event.get_argument(idx++);
-	m_impl->m_inputState.turn = hexToFloat(p_event.get_argument(idx++));
-	m_impl->m_inputLocked = p_event.get_argument(idx++);
+	if (version != STATE_FORMAT_VERSION) {
+		cl_log_event(LOG_DEBUG, "unsupported car state version: %1", version);
+		return;
+	}
 
-	// corpse state
-	m_impl->m_position.x = hexToFloat(p_event.get_argument(idx++));
-	m_impl->m_position.y = hexToFloat(p_event.get_argument(idx++));
-	m_impl->m_rotation.set_radians(hexToFloat(p_event.get_argument(idx++)));
-	m_impl->m_speed = hexToFloat(p_event.get_argument(idx++));
+	CarStateData state;
+	state.read(reader);
 
-	// physics parameters
-	m_impl->m_phyMoveRot.set_radians(hexToFloat(p_event.get_argument(idx++)));
-	m_impl->m_phyMoveVec.x = hexToFloat(p_event.get_argument(idx++));
-	m_impl->m_phyMoveVec.y = hexToFloat(p_event.get_argument(idx++));
-	m_impl->m_phySpeedDelta = hexToFloat(p_event.get_argument(idx++));
-	m_impl->m_phyWheelsTurn = hexToFloat(p_event.get_argument(idx++));
+	if (reader.isOverrun()) {
+		cl_log_event(LOG_DEBUG, "truncated car state: %1 bytes", data.length());
+		return;
+	}
 
-	m_impl->m_damage = hexToFloat(p_event.get_argument(idx++));
+	// apply only complete state
+	applyState(state);
 }
 
 bool CarImpl::isChoking()
@@ -51,6 +51,7 @@ namespace Gfx {
 namespace Race {
 
 class CarImpl;
+class CarStateData;
 class Bound;
 class Level;
 
@@ -106,6 +107,21 @@ class Car : boost::noncopyable
 		virtual void serialize(CL_NetGameEvent *p_data) const;
 		virtual void deserialize(const CL_NetGameEvent &p_data);
 
+		/** Stores quantized car state in p_state */
+		void captureState(CarStateData *p_state) const;
+
+		/** Sets the car to quantized state */
+		virtual void applyState(const CarStateData &p_state);
+
+		/** Sets only input part of quantized state */
+		void applyInput(const CarStateData &p_state);
+
+		/**
+		 * @return quantized state taken right before the first
+		 * iteration that used the current input
+		 */
+		const CarStateData &getInputChangeState() const;
+
 		void setAcceleration(bool p_value);
 		void setBrake(bool p_value);
 		void setLocked(bool p_locked);
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CarStateData.h"
+
+#include "common/BitStream.h"
+
+namespace Race {
+
+namespace {
+
+struct FieldFormat {
+	int m_bits;
+	bool m_signed;
+};
+
+/** Formats of all fields except the iteration which is a varint */
+const FieldFormat FIELD_FORMATS[CarStateData::FIELD_COUNT] = {
+	{ 0,  false }, // F_ITERATION
+	{ 3 + CarStateData::INPUT_TURN_BITS, false }, // F_INPUT
+	{ CarStateData::POSITION_BITS, true  }, // F_POSITION_X
+	{ CarStateData::POSITION_BITS, true  }, // F_POSITION_Y
+	{ CarStateData::ANGLE_BITS,    false }, // F_ROTATION
+	{ CarStateData::SPEED_BITS,    true  }, // F_SPEED
+	{ CarStateData::ANGLE_BITS,    false }, // F_MOVE_ROTATION
+	{ CarStateData::SPEED_BITS,    true  }, // F_MOVE_X
+	{ CarStateData::SPEED_BITS,    true  }, // F_MOVE_Y
+	{ CarStateData::SPEED_BITS,    true  }, // F_SPEED_DELTA
+	{ CarStateData::TURN_BITS,     true  }, // F_WHEELS_TURN
+	{ CarStateData::DAMAGE_BITS,   false }  // F_DAMAGE
+};
+
+unsigned fieldMask(int p_bits)
+{
+	return p_bits < 32 ? (1u << p_bits) - 1 : 0xFFFFFFFF;
+}
+
+int extendSign(unsigned p_value, int p_bits)
+{
+	if (p_bits < 32 && (p_value & (1u << (p_bits - 1)))) {
+		return static_cast<int>(p_value | ~fieldMask(p_bits));
+	}
+
+	return static_cast<int>(p_value);
+}
+
+/** Maps signed numbers to unsigned ones, so small magnitudes stay small */
+unsigned zigZag(int p_value)
+{
+	return (static_cast<unsigned>(p_value) << 1) ^ static_cast<unsigned>(p_value >> 31);
+}
+
+int unZigZag(unsigned p_value)
+{
+	return static_cast<int>(p_value >> 1) ^ -static_cast<int>(p_value & 1);
+}
+
+}
+
+CarStateData::CarStateData()
+{
+	for (int i = 0; i < FIELD_COUNT; ++i) {
+		m_fields[i] = 0;
+	}
+
+	m_fields[F_ITERATION] = -1;
+}
+
+void CarStateData::write(BitWriter &p_writer) const
+{
+	p_writer.writeVarUint(static_cast<unsigned>(m_fields[F_ITERATION] + 1));
+
+	for (int i = F_ITERATION + 1; i < FIELD_COUNT; ++i) {
+		p_writer.writeBits(m_fields[i], FIELD_FORMATS[i].m_bits);
+	}
+}
+
+void CarStateData::read(BitReader &p_reader)
+{
+	m_fields[F_ITERATION] = static_cast<int>(p_reader.readVarUint()) - 1;
+
+	for (int i = F_ITERATION + 1; i < FIELD_COUNT; ++i) {
+		const FieldFormat &format = FIELD_FORMATS[i];
+
+		if (format.m_signed) {
+			m_fields[i] = p_reader.readSigned(format.m_bits);
+		} else {
+			m_fields[i] = p_reader.readBits(format.m_bits);
+		}
+	}
+}
+
+void CarStateData::writeDelta(BitWriter &p_writer, const CarStateData &p_base) const
+{
+	unsigned changed = 0;
+
+	for (int i = 0; i < FIELD_COUNT; ++i) {
+		if (m_fields[i] != p_base.m_fields[i]) {
+			changed |= 1 << i;
+		}
+	}
+
+	p_writer.writeBits(changed, FIELD_COUNT);
+
+	if (changed & (1 << F_ITERATION)) {
+		p_writer.writeVarUint(zigZag(m_fields[F_ITERATION] - p_base.m_fields[F_ITERATION]));
+	}
+
+	// nearby values share high bits, so their XOR is a short varint
+	for (int i = F_ITERATION + 1; i < FIELD_COUNT; ++i) {
+		if (changed & (1 << i)) {
+			const unsigned diff = static_cast<unsigned>(m_fields[i] ^ p_base.m_fields[i]);
+			p_writer.writeVarUint(diff & fieldMask(FIELD_FORMATS[i].m_bits));
+		}
+	}
+}
+
+void CarStateData::readDelta(BitReader &p_reader, const CarStateData &p_base)
+{
+	const unsigned changed = p_reader.readBits(FIELD_COUNT);
+
+	*this = p_base;
+
+	if (changed & (1 << F_ITERATION)) {
+		m_fields[F_ITERATION] += unZigZag(p_reader.readVarUint());
+	}
+
+	for (int i = F_ITERATION + 1; i < FIELD_COUNT; ++i) {
+		if (changed & (1 << i)) {
+			const FieldFormat &format = FIELD_FORMATS[i];
+
+			const unsigned value =
+					(static_cast<unsigned>(p_base.m_fields[i]) ^ p_reader.readVarUint())
+					& fieldMask(format.m_bits);
+
+			m_fields[i] = format.m_signed ? extendSign(value, format.m_bits) : value;
+		}
+	}
+}
+
+bool CarStateData::operator==(const CarStateData &p_other) const
+{
+	for (int i = 0; i < FIELD_COUNT; ++i) {
+		if (m_fields[i] != p_other.m_fields[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+class BitReader;
+class BitWriter;
+
+namespace Race {
+
+/**
+ * Car state quantized for the network. Each field is an integer
+ * written on a fixed number of bits, so the state can be sent
+ * whole or only as a difference against an older state.
+ */
+class CarStateData
+{
+	public:
+
+		enum Field {
+			/** Iteration id, -1 before the first iteration */
+			F_ITERATION,
+			/** Accelerate, brake and lock bits followed by turn */
+			F_INPUT,
+			F_POSITION_X,
+			F_POSITION_Y,
+			F_ROTATION,
+			F_SPEED,
+			F_MOVE_ROTATION,
+			F_MOVE_X,
+			F_MOVE_Y,
+			F_SPEED_DELTA,
+			F_WHEELS_TURN,
+			F_DAMAGE,
+			FIELD_COUNT
+		};
+
+		static const int INPUT_TURN_BITS = 12;
+		static const int POSITION_BITS = 32;
+		static const int ANGLE_BITS = 16;
+		static const int SPEED_BITS = 18;
+		static const int TURN_BITS = 12;
+		static const int DAMAGE_BITS = 10;
+
+
+		CarStateData();
+
+
+		int get(Field p_field) const { return m_fields[p_field]; }
+
+		void set(Field p_field, int p_value) { m_fields[p_field] = p_value; }
+
+
+		void write(BitWriter &p_writer) const;
+
+		void read(BitReader &p_reader);
+
+		/**
+		 * Writes mask of fields that differ from p_base followed by
+		 * the changed fields XORed with the base values.
+		 */
+		void writeDelta(BitWriter &p_writer, const CarStateData &p_base) const;
+
+		/** Reads delta written against p_base */
+		void readDelta(BitReader &p_reader, const CarStateData &p_base);
+
+
+		bool operator==(const CarStateData &p_other) const;
+
+		bool operator!=(const CarStateData &p_other) const { return !(*this == p_other); }
+
+	private:
+
+		int m_fields[FIELD_COUNT];
+};
+
+}
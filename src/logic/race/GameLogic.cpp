@@ -30,6 +30,7 @@
 
 #include "common/gassert.h"
 #include "common/Game.h"
+#include "common/Profiler.h"
 #include "logic/VoteSystem.h"
 #include "logic/race/Car.h"
 #include "logic/race/MessageBoard.h"
@@ -148,6 +149,8 @@ void GameLogic::update(unsigned p_timeElapsedMs)
 
 void GameLogicImpl::update(unsigned p_timeElapsedMs)
 {
+	G_PROFILE("GameLogic::update");
+
 	updateCarsPhysics(p_timeElapsedMs);
 	updateCollisions();
 
@@ -166,6 +169,8 @@ void GameLogicImpl::updateCarsPhysics(unsigned p_timeElapsedMs)
 
 void GameLogicImpl::updateCollisions()
 {
+	G_PROFILE("collisions");
+
 
 	const int carCount = m_level->getCarCount();
 
@@ -28,9 +28,11 @@
 
 #include "Progress.h"
 
+#include <algorithm>
 #include <map>
 
 #include "common.h"
+#include "common/Profiler.h"
 #include "logic/race/Car.h"
 #include "logic/race/level/Checkpoint.h"
 #include "logic/race/level/Level.h"
@@ -88,6 +90,12 @@ class ProgressImpl
 		 */
 		TCheckpointDistances m_dists;
 
+		/** Distance from the first checkpoint to each checkpoint along the track */
+		TCheckpointDistances m_arcs;
+
+		/** Sum of all checkpoint distances */
+		int m_trackLength;
+
 		const Level *const m_level;
 
 		unsigned m_clock;
@@ -99,6 +107,7 @@ class ProgressImpl
 		// methods
 
 		ProgressImpl(const Level *p_level) :
+			m_trackLength(0),
 			m_level(p_level),
 			m_initd(false),
 			m_clock(0)
@@ -232,6 +241,14 @@ void Progress::initialize()
 
 	m_impl->m_dists.push_back(dist);
 
+	// arc positions for quick distance between any two checkpoints
+	m_impl->m_trackLength = 0;
+
+	foreach (int d, m_impl->m_dists) {
+		m_impl->m_arcs.push_back(m_impl->m_trackLength);
+		m_impl->m_trackLength += d;
+	}
+
 	// mark initialized
 	m_impl->m_initd = true;
 
@@ -255,6 +272,7 @@ void ProgressImpl::destroy()
 
 	m_chkpts.clear();
 	m_dists.clear();
+	m_arcs.clear();
 	m_cars.clear();
 
 	m_initd = false;
@@ -278,6 +296,8 @@ void Progress::removeCar(const Car *p_car)
 
 void Progress::update()
 {
+	G_PROFILE("Progress::update");
+
 	static const int FAR_LIMIT = 400;
 
 	// localize closest checkpoint for each car
@@ -385,6 +405,24 @@ bool ProgressImpl::startLinePassed(const Car *p_car)
 	}
 }
 
+int Progress::getTrackDistance(const Car &p_a, const Car &p_b) const
+{
+	G_ASSERT(m_impl->m_initd);
+
+	ProgressImpl::TCarProgressMap::const_iterator itorA = m_impl->m_cars.find(&p_a);
+	ProgressImpl::TCarProgressMap::const_iterator itorB = m_impl->m_cars.find(&p_b);
+
+	G_ASSERT(itorA != m_impl->m_cars.end());
+	G_ASSERT(itorB != m_impl->m_cars.end());
+
+	const int arcA = m_impl->m_arcs[itorA->second->m_cp.getIndex()];
+	const int arcB = m_impl->m_arcs[itorB->second->m_cp.getIndex()];
+
+	const int dist = abs(arcA - arcB);
+
+	return std::min(dist, m_impl->m_trackLength - dist);
+}
+
 int Progress::getLapNumber(const Car &p_car) const
 {
 	if (!m_impl->m_initd) {
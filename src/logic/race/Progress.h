@@ -68,6 +68,12 @@ class Progress
 
 		int getLapNumber(const Car &p_car) const;
 
+		/**
+		 * @return distance between cars along the track in world
+		 * units, measured the shorter way around
+		 */
+		int getTrackDistance(const Car &p_a, const Car &p_b) const;
+
 		/**
 		 * Provides lap time in milliseconds. If lap isn't
 		 * finished yet, then ongoing time is returned.
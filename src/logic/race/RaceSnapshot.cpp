@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "RaceSnapshot.h"
+
+#include "common/Game.h"
+#include "common/Player.h"
+#include "logic/race/Car.h"
+#include "logic/race/Progress.h"
+#include "logic/race/level/Level.h"
+
+namespace Race
+{
+
+void CarSnapshot::capture(const Car &p_car, int p_lap)
+{
+	m_car = &p_car;
+	m_name = p_car.getOwnerPlayer().getName();
+	m_position = p_car.getPosition();
+	m_corpseAngle = p_car.getCorpseAngle();
+	m_moveVector = p_car.getPhyMoveVector();
+	m_wheelTurn = p_car.getPhyWheelTurn();
+	m_speed = p_car.getSpeed();
+	m_speedKMS = p_car.getSpeedKMS();
+	m_drifting = p_car.isDrifting();
+	m_choking = p_car.isChoking();
+	m_lap = p_lap;
+}
+
+void RaceSnapshot::capture(const GameLogic &p_logic)
+{
+	const Level &level = p_logic.getLevel();
+	const Progress &progress = p_logic.getProgressObject();
+	const Car &playerCar = Game::getInstance().getPlayer().getCar();
+
+	const int carCount = level.getCarCount();
+
+	// resize keeps capacity, so strings are not reallocated every time
+	m_cars.resize(carCount);
+	m_playerCar = -1;
+
+	for (int i = 0; i < carCount; ++i) {
+		const Car &car = level.getCar(i);
+
+		m_cars[i].capture(car, progress.getLapNumber(car));
+
+		if (&car == &playerCar) {
+			m_playerCar = i;
+		}
+	}
+
+	m_raceGameState = p_logic.getRaceGameState();
+	m_lapCount = p_logic.getLapCount();
+	m_bestLapTime = p_logic.getBestLapTime();
+	m_lastLapTime = p_logic.getLastLapTime();
+	m_currentLapTime = p_logic.getCurrentLapTime();
+}
+
+}
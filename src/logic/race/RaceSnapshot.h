@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "clanlib/core/math.h"
+#include "clanlib/core/system.h"
+
+#include "logic/race/GameLogic.h"
+
+namespace Race
+{
+
+class Car;
+
+/** Car state as seen by graphics in one moment */
+class CarSnapshot
+{
+	public:
+
+		/** Car identity only, do not read from it outside of logic thread */
+		const Car *m_car;
+
+		CL_String m_name;
+
+		CL_Pointf m_position;
+
+		CL_Angle m_corpseAngle;
+
+		CL_Vec2f m_moveVector;
+
+		float m_wheelTurn;
+
+		float m_speed;
+
+		float m_speedKMS;
+
+		bool m_drifting;
+
+		bool m_choking;
+
+		int m_lap;
+
+
+		CarSnapshot() :
+			m_car(NULL),
+			m_wheelTurn(0.0f),
+			m_speed(0.0f),
+			m_speedKMS(0.0f),
+			m_drifting(false),
+			m_choking(false),
+			m_lap(0)
+		{ /* empty */ }
+
+		void capture(const Car &p_car, int p_lap);
+};
+
+/**
+ * Copy of race state that graphics needs for drawing a frame.
+ * It is filled by the logic and can be read without touching
+ * the logic objects, so drawing can run on other thread.
+ */
+class RaceSnapshot
+{
+	public:
+
+		/** Cars in level order */
+		std::vector<CarSnapshot> m_cars;
+
+		/** Index of local player's car, -1 if not in level */
+		int m_playerCar;
+
+		RaceGameState m_raceGameState;
+
+		int m_lapCount;
+
+		int m_bestLapTime, m_lastLapTime, m_currentLapTime;
+
+
+		RaceSnapshot() :
+			m_playerCar(-1),
+			m_raceGameState(GS_STANDBY),
+			m_lapCount(0),
+			m_bestLapTime(0),
+			m_lastLapTime(0),
+			m_currentLapTime(0)
+		{ /* empty */ }
+
+		/** Copies state of the logic. Reuses memory of previous capture. */
+		void capture(const GameLogic &p_logic);
+
+		/** @return Local player's car state or NULL */
+		const CarSnapshot *getPlayerCar() const {
+			return m_playerCar != -1 ? &m_cars[m_playerCar] : NULL;
+		}
+};
+
+}
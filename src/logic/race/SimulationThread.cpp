@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SimulationThread.h"
+
+#include <math.h>
+
+#include "common/Trace.h"
+#include "common/TripleBuffer.h"
+#include "logic/race/GameLogic.h"
+#include "logic/race/RaceSnapshot.h"
+
+namespace Race
+{
+
+/** Same step as the one used by single thread game loop */
+const float ITERATION_TIME_MS = 1000.0f / 60.0f;
+
+class SimulationThreadImpl
+{
+	public:
+
+		GameLogic *m_logic;
+
+		CL_Mutex *m_logicMutex;
+
+		CL_Event m_eventInterrupted;
+
+		TripleBuffer<RaceSnapshot> m_snapshots;
+
+
+		SimulationThreadImpl(GameLogic *p_logic, CL_Mutex *p_logicMutex) :
+			m_logic(p_logic),
+			m_logicMutex(p_logicMutex)
+		{ /* empty */ }
+};
+
+SimulationThread::SimulationThread(GameLogic *p_logic, CL_Mutex *p_logicMutex) :
+	m_impl(new SimulationThreadImpl(p_logic, p_logicMutex))
+{
+	// make sure that reader has something to read
+	m_impl->m_snapshots.getBack().capture(*p_logic);
+	m_impl->m_snapshots.publish();
+}
+
+SimulationThread::~SimulationThread()
+{
+	// empty
+}
+
+void SimulationThread::run()
+{
+	Trace::setThreadName("simulation");
+
+	unsigned lastTime = CL_System::get_time();
+
+	float timeStoreMs = 0.0f;
+	float timeBufferMs = 0.0f;
+
+	int waitMs = 0;
+
+	while (CL_Event::wait(m_impl->m_eventInterrupted, waitMs) == -1) {
+
+		const unsigned now = CL_System::get_time();
+		timeStoreMs += now - lastTime;
+		lastTime = now;
+
+		if (timeStoreMs >= ITERATION_TIME_MS) {
+
+			// owner may hold the lock while waiting for this thread to end
+			if (!m_impl->m_logicMutex->try_lock()) {
+				waitMs = 1;
+				continue;
+			}
+
+			// network and input events are processed by the main thread,
+			// which holds the same lock meanwhile (see GameWindow::update)
+			for (; timeStoreMs >= ITERATION_TIME_MS; timeStoreMs -= ITERATION_TIME_MS) {
+
+				timeBufferMs += ITERATION_TIME_MS;
+				const int timeDeltaMs = floor(timeBufferMs);
+				timeBufferMs -= timeDeltaMs;
+
+				G_TRACE("simulation step");
+
+				INVOKE_0(iterationStarted);
+				m_impl->m_logic->update(timeDeltaMs);
+			}
+
+			m_impl->m_snapshots.getBack().capture(*m_impl->m_logic);
+
+			m_impl->m_logicMutex->unlock();
+
+			m_impl->m_snapshots.publish();
+		}
+
+		// sleep until next step
+		waitMs = static_cast<int>(ITERATION_TIME_MS - timeStoreMs);
+	}
+}
+
+void SimulationThread::interrupt()
+{
+	m_impl->m_eventInterrupted.set();
+}
+
+const RaceSnapshot &SimulationThread::readSnapshot()
+{
+	return m_impl->m_snapshots.read();
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/system.h"
+
+#include "common.h"
+
+namespace Race
+{
+
+class GameLogic;
+class RaceSnapshot;
+
+class SimulationThreadImpl;
+
+/**
+ * Runs game logic at fixed rate on its own thread.
+ * <p>
+ * After each step the race state is copied to a snapshot that the
+ * drawing thread reads without locking. Anything else that needs
+ * logic objects from other thread must hold the logic mutex. Network
+ * and input events stay on the main thread that created the client,
+ * it processes them with the logic mutex held.
+ */
+class SimulationThread : public CL_Runnable
+{
+		/** Invoked on simulation thread before each logic step, with mutex held */
+		SIGNAL_0(iterationStarted);
+
+	public:
+
+		SimulationThread(GameLogic *p_logic, CL_Mutex *p_logicMutex);
+
+		virtual ~SimulationThread();
+
+
+		virtual void run();
+
+		void interrupt();
+
+
+		/**
+		 * Newest published race state. Returned value is valid until
+		 * next call of this method.
+		 */
+		const RaceSnapshot &readSnapshot();
+
+	private:
+
+		CL_SharedPtr<SimulationThreadImpl> m_impl;
+};
+
+}
@@ -28,7 +28,6 @@
 
 #include "Float.h"
 
-#include <map>
 #include <math.h>
 
 #include "common.h"
@@ -69,78 +68,24 @@ float Float::reduce(float p_val, float p_min, float p_max)
 	return p_val;
 }
 
-class Animation {
-
-	public:
-
-		float m_from, m_to;
-
-		unsigned m_stime, m_etime;
-
-		unsigned m_dur;
-
-		const Easing *m_easing;
-};
-
-class FloatImpl
-{
-	public:
-
-		typedef std::map<size_t, Animation*> TAnimationMap;
-
-
-		/** Current value container */
-		float m_value;
-
-		/** Time registered from the beginning object life */
-		size_t m_timeFromStart;
-
-		/** Animations to do in time. Key is the start time. */
-		TAnimationMap m_animMap;
-
-		/** Currently running animation */
-		Animation *m_currAnim;
-
-
-		FloatImpl(float p_val) :
-			m_value(p_val),
-			m_timeFromStart(0),
-			m_currAnim(NULL)
-		{ /* empty */ }
-
-
-		void setCurrentAnimation(Animation *p_animation);
-
-		void update(unsigned p_timeElapsed);
-};
-
 Float::Float() :
-	m_impl(new FloatImpl(0.0f))
+	m_value(0.0f),
+	m_timeFromStart(0),
+	m_running(false),
+	m_pendingCount(0)
 {
 	// empty
 }
 
 Float::Float(float p_val) :
-	m_impl(new FloatImpl(p_val))
+	m_value(p_val),
+	m_timeFromStart(0),
+	m_running(false),
+	m_pendingCount(0)
 {
 	// empty
 }
 
-Float::~Float()
-{
-	// empty
-}
-
-float Float::get() const
-{
-	return m_impl->m_value;
-}
-
-void Float::set(float p_value)
-{
-	m_impl->m_value = p_value;
-}
-
 void Float::animate(
 		float p_startValue, float p_endValue,
 		unsigned p_duration,
@@ -148,82 +93,94 @@ void Float::animate(
 		unsigned p_delay
 )
 {
-	const unsigned startTime = m_impl->m_timeFromStart + p_delay;
+	const unsigned startTime = m_timeFromStart + p_delay;
+
+	// find place keeping start time order
+	int idx = 0;
+	while (idx < m_pendingCount && m_pending[idx].m_stime < startTime) {
+		++idx;
+	}
+
+	const bool replace =
+			idx < m_pendingCount && m_pending[idx].m_stime == startTime;
+
+	if (!replace) {
+		if (m_pendingCount == MAX_PENDING) {
+			// no more place, the latest animation has to go
+			--m_pendingCount;
+
+			if (idx > m_pendingCount) {
+				idx = m_pendingCount;
+			}
+		}
 
-	Animation *animation = new Animation();
-	animation->m_from = p_startValue;
-	animation->m_to = p_endValue;
-	animation->m_stime = startTime;
-	animation->m_etime = startTime + p_duration;
-	animation->m_easing = &p_easing;
+		for (int i = m_pendingCount; i > idx; --i) {
+			m_pending[i] = m_pending[i - 1];
+		}
 
-	m_impl->m_animMap[startTime] = animation;
+		++m_pendingCount;
+	}
+
+	Animation &animation = m_pending[idx];
+	animation.m_from = p_startValue;
+	animation.m_to = p_endValue;
+	animation.m_stime = startTime;
+	animation.m_etime = startTime + p_duration;
+	animation.m_easing = &p_easing;
 
 	// set start value if animation should start now
 	if (p_delay == 0) {
-		m_impl->m_value = p_startValue;
+		m_value = p_startValue;
 	}
 }
 
 void Float::update(unsigned p_timeElapsed)
-{
-	m_impl->update(p_timeElapsed);
-}
-
-void FloatImpl::update(unsigned p_timeElapsed)
 {
 	m_timeFromStart += p_timeElapsed;
 
 	// look for the next animation
-	if (!m_animMap.empty()) {
-		FloatImpl::TAnimationMap::iterator itor;
-		for (itor = m_animMap.begin(); itor != m_animMap.end();) {
-			if (itor->first <= m_timeFromStart) {
-				setCurrentAnimation(itor->second);
-				m_animMap.erase(itor++);
-			} else {
-				++itor;
-			}
-		}
+	int started = 0;
+	while (
+			started < m_pendingCount
+			&& m_pending[started].m_stime <= m_timeFromStart
+	) {
+		++started;
 	}
 
-	if (m_currAnim != NULL) {
-
-		if (m_currAnim->m_etime <= m_timeFromStart) {
-			// animation should end now
-			m_value = m_currAnim->m_to;
+	if (started > 0) {
+		// the latest started animation wins
+		m_current = m_pending[started - 1];
+		m_running = true;
 
-			delete m_currAnim;
-			m_currAnim = NULL;
-
-		} else {
+		m_pendingCount -= started;
+		for (int i = 0; i < m_pendingCount; ++i) {
+			m_pending[i] = m_pending[i + started];
+		}
+	}
 
-			// make progress
-			const float progress =
-					(m_timeFromStart - m_currAnim->m_stime) /
-					static_cast<float> (
-							m_currAnim->m_etime - m_currAnim->m_stime
-					);
+	if (!m_running) {
+		return;
+	}
 
-			// this should be value between 0.0 and 1.0
-			G_ASSERT(progress >= 0.0f && progress <= 1.0f);
+	if (m_current.m_etime <= m_timeFromStart) {
+		// animation should end now
+		m_value = m_current.m_to;
+		m_running = false;
+	} else {
 
-			m_value = m_currAnim->m_easing->ease(
-					m_currAnim->m_from, m_currAnim->m_to,
-					progress
-			);
+		// make progress
+		const float progress =
+				(m_timeFromStart - m_current.m_stime) /
+				static_cast<float> (m_current.m_etime - m_current.m_stime);
 
-		}
-	}
-}
+		// this should be value between 0.0 and 1.0
+		G_ASSERT(progress >= 0.0f && progress <= 1.0f);
 
-void FloatImpl::setCurrentAnimation(Animation *p_animation)
-{
-	if (m_currAnim != NULL) {
-		delete m_currAnim;
+		m_value = m_current.m_easing->ease(
+				m_current.m_from, m_current.m_to,
+				progress
+		);
 	}
-
-	m_currAnim = p_animation;
 }
 
 } // namespace
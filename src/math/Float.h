@@ -32,18 +32,24 @@
 
 #include "Easing.h"
 
-//#include "boost/utility.hpp"
-
 namespace Math {
 
 class Easing;
 
-class FloatImpl;
-
+/**
+ * Float value that can be animated in time.
+ * <p>
+ * This is a plain value type. Animations are kept in a small fixed
+ * array inside the object, so animating doesn't allocate any memory.
+ */
 class Float {
 
 	public:
 
+		/** How many animations can wait for their start at once */
+		static const int MAX_PENDING = 4;
+
+
 		static float clamp(float p_val, float p_min, float p_max);
 
 		static bool cmp(float p_a, float p_b, float p_precision);
@@ -55,12 +61,18 @@ class Float {
 
 		Float(float p_val);
 
-		virtual ~Float();
 
+		float get() const { return m_value; }
 
-		float get() const;
+		/** @return true if there is running or waiting animation */
+		bool isAnimating() const { return m_running || m_pendingCount > 0; }
 
 
+		/**
+		 * Schedules new animation. Animation that starts at the same
+		 * time as already scheduled one replaces it. When there is
+		 * no place for new animation, then the latest one is replaced.
+		 */
 		void animate(
 				float p_startValue, float p_endValue,
 				unsigned p_duration,
@@ -68,7 +80,7 @@ class Float {
 				unsigned p_delay = 0
 		);
 
-		void set(float p_value);
+		void set(float p_value) { m_value = p_value; }
 
 		/**
 		 * Changes the object state by next <code>p_timeElapsed</code> time.
@@ -82,7 +94,33 @@ class Float {
 
 	private:
 
-		CL_SharedPtr<FloatImpl> m_impl;
+		struct Animation {
+
+			float m_from, m_to;
+
+			unsigned m_stime, m_etime;
+
+			const Easing *m_easing;
+		};
+
+
+		/** Current value container */
+		float m_value;
+
+		/** Time registered from the beginning object life */
+		unsigned m_timeFromStart;
+
+		/** Currently running animation */
+		Animation m_current;
+
+		/** If m_current is valid */
+		bool m_running;
+
+		/** Animations to do in time sorted by start time */
+		Animation m_pending[MAX_PENDING];
+
+		/** Count of valid m_pending entries */
+		int m_pendingCount;
 
 };
 
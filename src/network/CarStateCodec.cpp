@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CarStateCodec.h"
+
+#include "common.h"
+#include "common/BitStream.h"
+
+namespace Net {
+
+/* Codec data format, bump on every layout change */
+const unsigned CODEC_VERSION = 1;
+
+const int SEQUENCE_BITS = 8;
+const unsigned SEQUENCE_MASK = (1 << SEQUENCE_BITS) - 1;
+
+CarStateCodec::CarStateCodec() :
+	m_hasState(false),
+	m_sequence(0)
+{
+	// empty
+}
+
+CL_String8 CarStateCodec::encode(const Race::CarStateData &p_state)
+{
+	const bool full = !m_hasState;
+
+	m_sequence = (m_sequence + 1) & SEQUENCE_MASK;
+
+	BitWriter writer;
+
+	writer.writeBits(CODEC_VERSION, 8);
+	writer.writeBool(full);
+	writer.writeBits(m_sequence, SEQUENCE_BITS);
+
+	if (full) {
+		p_state.write(writer);
+	} else {
+		p_state.writeDelta(writer, m_state);
+	}
+
+	m_state = p_state;
+	m_hasState = true;
+
+	return writer.getData();
+}
+
+CL_String8 CarStateCodec::encodeFull() const
+{
+	BitWriter writer;
+
+	writer.writeBits(CODEC_VERSION, 8);
+	writer.writeBool(true);
+	writer.writeBits(m_sequence, SEQUENCE_BITS);
+
+	m_state.write(writer);
+
+	return writer.getData();
+}
+
+bool CarStateCodec::decode(const CL_String8 &p_data, Race::CarStateData *p_state)
+{
+	BitReader reader(p_data);
+
+	const unsigned version = reader.readBits(8);
+
+	if (version != CODEC_VERSION) {
+		cl_log_event(LOG_DEBUG, "unsupported car state codec version: %1", version);
+		return false;
+	}
+
+	const bool full = reader.readBool();
+	const unsigned sequence = reader.readBits(SEQUENCE_BITS);
+
+	Race::CarStateData state;
+
+	if (full) {
+		state.read(reader);
+	} else {
+		if (!m_hasState || sequence != ((m_sequence + 1) & SEQUENCE_MASK)) {
+			return false;
+		}
+
+		state.readDelta(reader, m_state);
+	}
+
+	if (reader.isOverrun()) {
+		cl_log_event(LOG_DEBUG, "truncated car state: %1 bytes", p_data.length());
+		return false;
+	}
+
+	m_state = state;
+	m_hasState = true;
+	m_sequence = sequence;
+
+	*p_state = state;
+
+	return true;
+}
+
+void CarStateCodec::reset()
+{
+	m_hasState = false;
+}
+
+void CarStateCodec::setState(const Race::CarStateData &p_state)
+{
+	m_state = p_state;
+	m_hasState = true;
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/text.h"
+
+#include "logic/race/CarStateData.h"
+
+namespace Net {
+
+/**
+ * Encodes one car state stream. Each state is sent as a difference
+ * against the previous one, which the receiver already has because
+ * states travel over an ordered connection. When the receiver loses
+ * track of the stream it asks for a full state and both sides
+ * start over from it.
+ */
+class CarStateCodec
+{
+	public:
+
+		CarStateCodec();
+
+
+		/**
+		 * Encodes the next state of the stream. First state and
+		 * the state after reset() are encoded in full.
+		 */
+		CL_String8 encode(const Race::CarStateData &p_state);
+
+		/** Encodes the last known state in full without advancing the stream */
+		CL_String8 encodeFull() const;
+
+		/**
+		 * Decodes state encoded by the other side of the stream.
+		 *
+		 * @return false when data is invalid or is a difference
+		 * against a state that this codec doesn't have
+		 */
+		bool decode(const CL_String8 &p_data, Race::CarStateData *p_state);
+
+		/** Makes next encoded state a full one */
+		void reset();
+
+		/** Sets the last known state without encoding it */
+		void setState(const Race::CarStateData &p_state);
+
+
+		bool hasState() const { return m_hasState; }
+
+		const Race::CarStateData &getState() const { return m_state; }
+
+	private:
+
+		/** Last encoded or decoded state */
+		Race::CarStateData m_state;
+
+		bool m_hasState;
+
+		/** Sequence number of m_state, wraps at 256 */
+		unsigned m_sequence;
+};
+
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "DatagramChannel.h"
+
+#include "common/BitStream.h"
+#include "common/gassert.h"
+
+namespace Net {
+
+/* Marks datagrams of this game */
+const unsigned DATAGRAM_MAGIC = 0x47;
+
+/* Magic, token, sequence and part */
+const unsigned HEADER_SIZE = 8;
+
+const int SEQUENCE_BITS = 16;
+const unsigned SEQUENCE_MASK = (1 << SEQUENCE_BITS) - 1;
+
+const int PART_BITS = 8;
+
+const unsigned DatagramChannel::MAX_MESSAGE_SIZE;
+const unsigned DatagramChannel::MAX_PARTS;
+
+DatagramChannel::DatagramChannel(const CL_SharedPtr<DatagramSocket> &p_socket) :
+	m_socket(p_socket),
+	m_droppedCount(0)
+{
+	// empty
+}
+
+void DatagramChannel::send(unsigned p_token, const CL_String8 &p_message, const CL_SocketName &p_to)
+{
+	unsigned &sequence = m_sentSequences[p_token];
+	sequence = (sequence + 1) & SEQUENCE_MASK;
+
+	sendPart(p_token, sequence, 0, p_message, p_to);
+}
+
+void DatagramChannel::sendParts(
+		unsigned p_token,
+		const std::vector<CL_String8> &p_parts,
+		const CL_SocketName &p_to
+)
+{
+	G_ASSERT(p_parts.size() <= MAX_PARTS);
+
+	unsigned &sequence = m_sentSequences[p_token];
+	sequence = (sequence + 1) & SEQUENCE_MASK;
+
+	const unsigned count = p_parts.size();
+
+	for (unsigned i = 0; i < count; ++i) {
+		sendPart(p_token, sequence, i, p_parts[i], p_to);
+	}
+}
+
+void DatagramChannel::sendPart(
+		unsigned p_token,
+		unsigned p_sequence,
+		unsigned p_part,
+		const CL_String8 &p_message,
+		const CL_SocketName &p_to
+)
+{
+	BitWriter writer;
+
+	writer.writeBits(DATAGRAM_MAGIC, 8);
+	writer.writeBits(p_token, 32);
+	writer.writeBits(p_sequence, SEQUENCE_BITS);
+	writer.writeBits(p_part, PART_BITS);
+
+	CL_String8 datagram(writer.getData());
+	datagram.append(p_message);
+
+	m_socket->send(datagram, p_to);
+}
+
+bool DatagramChannel::receive(unsigned *p_token, CL_String8 *p_message, CL_SocketName *p_from)
+{
+	CL_String8 datagram;
+
+	while (m_socket->receive(&datagram, p_from)) {
+		BitReader reader(datagram);
+
+		const unsigned magic = reader.readBits(8);
+		const unsigned token = reader.readBits(32);
+		const unsigned sequence = reader.readBits(SEQUENCE_BITS);
+		const unsigned part = reader.readBits(PART_BITS);
+
+		if (reader.isOverrun() || magic != DATAGRAM_MAGIC || part >= MAX_PARTS) {
+			++m_droppedCount;
+			continue;
+		}
+
+		TTokenAddressMap::const_iterator bound = m_boundAddresses.find(token);
+
+		if (bound != m_boundAddresses.end() && bound->second != p_from->get_address()) {
+			++m_droppedCount;
+			continue;
+		}
+
+		const unsigned partBit = 1u << part;
+
+		TTokenMessageMap::iterator last = m_receivedMessages.find(token);
+
+		if (last != m_receivedMessages.end()) {
+			ReceivedMessage &received = last->second;
+
+			// newer sequences are less than half of the range ahead
+			const unsigned ahead = (sequence - received.m_sequence) & SEQUENCE_MASK;
+
+			if (ahead == 0) {
+				// other part of the newest message
+				if (received.m_parts & partBit) {
+					++m_droppedCount;
+					continue;
+				}
+
+				received.m_parts |= partBit;
+			} else if (ahead > SEQUENCE_MASK / 2) {
+				++m_droppedCount;
+				continue;
+			} else {
+				received.m_sequence = sequence;
+				received.m_parts = partBit;
+			}
+		} else {
+			ReceivedMessage &received = m_receivedMessages[token];
+
+			received.m_sequence = sequence;
+			received.m_parts = partBit;
+		}
+
+		*p_token = token;
+		*p_message = datagram.substr(HEADER_SIZE);
+
+		return true;
+	}
+
+	return false;
+}
+
+void DatagramChannel::bind(unsigned p_token, const CL_String &p_address)
+{
+	m_boundAddresses[p_token] = p_address;
+}
+
+void DatagramChannel::forget(unsigned p_token)
+{
+	m_sentSequences.erase(p_token);
+	m_receivedMessages.erase(p_token);
+	m_boundAddresses.erase(p_token);
+}
+
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "network/DatagramSocket.h"
+
+namespace Net {
+
+/**
+ * Sequenced unreliable messages over a datagram socket. Each peer
+ * is identified by a token that the server hands out over the
+ * reliable connection. Messages may be lost, but a message older
+ * than one already received from the same peer is never delivered.
+ * A message may be split into parts sent with one sequence, each
+ * part is delivered on its own.
+ */
+class DatagramChannel
+{
+	public:
+
+		/** Largest message that fits into one datagram on common networks */
+		static const unsigned MAX_MESSAGE_SIZE = 1200;
+
+		/** Most parts of one message */
+		static const unsigned MAX_PARTS = 32;
+
+
+		explicit DatagramChannel(const CL_SharedPtr<DatagramSocket> &p_socket);
+
+
+		/** Sends message in stream of peer p_token */
+		void send(unsigned p_token, const CL_String8 &p_message, const CL_SocketName &p_to);
+
+		/**
+		 * Sends parts of one message in stream of peer p_token. Parts
+		 * share a sequence, so they are not stale to each other when
+		 * they arrive out of order.
+		 */
+		void sendParts(
+				unsigned p_token,
+				const std::vector<CL_String8> &p_parts,
+				const CL_SocketName &p_to
+		);
+
+		/**
+		 * Reads next message that is newer than any other message
+		 * received in the stream of its peer, or next part of the
+		 * newest message.
+		 *
+		 * @return false when there are no more messages to read
+		 */
+		bool receive(unsigned *p_token, CL_String8 *p_message, CL_SocketName *p_from);
+
+		/**
+		 * Accepts datagrams of peer p_token only from host p_address.
+		 * Datagrams from other hosts are dropped before they can
+		 * move the stream of the peer ahead.
+		 */
+		void bind(unsigned p_token, const CL_String &p_address);
+
+		/** Forgets sequences and bound host of peer p_token */
+		void forget(unsigned p_token);
+
+		/** @return event set while a datagram waits to be received */
+		CL_Event getReadEvent() { return m_socket->getReadEvent(); }
+
+
+		/** @return number of stale, duplicated or invalid datagrams */
+		int getDroppedCount() const { return m_droppedCount; }
+
+	private:
+
+		typedef std::map<unsigned, unsigned> TTokenSequenceMap;
+
+		typedef std::map<unsigned, CL_String> TTokenAddressMap;
+
+		/** Newest delivered message of a peer stream */
+		struct ReceivedMessage {
+
+			unsigned m_sequence;
+
+			/** Delivered parts, one bit each */
+			unsigned m_parts;
+		};
+
+		typedef std::map<unsigned, ReceivedMessage> TTokenMessageMap;
+
+		CL_SharedPtr<DatagramSocket> m_socket;
+
+		/** Last sent sequence of each peer stream */
+		TTokenSequenceMap m_sentSequences;
+
+		/** Last delivered message of each peer stream */
+		TTokenMessageMap m_receivedMessages;
+
+		/** Only host allowed to send in stream of the peer */
+		TTokenAddressMap m_boundAddresses;
+
+		int m_droppedCount;
+
+
+		void sendPart(
+				unsigned p_token,
+				unsigned p_sequence,
+				unsigned p_part,
+				const CL_String8 &p_message,
+				const CL_SocketName &p_to
+		);
+};
+
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "InterpolationBuffer.h"
+
+#include <math.h>
+
+#include "common/gassert.h"
+
+namespace Net {
+
+/* Weight of a new measurement is one of this */
+const double SMOOTHING = 16.0;
+
+/* Expected time between samples before any is measured */
+const double DEFAULT_INTERVAL_MS = 100.0;
+
+/* Remote time going back by more than this means new timeline */
+const double RESET_MS = 1000.0;
+
+const int InterpolationBuffer::CAPACITY;
+const unsigned InterpolationBuffer::MIN_DELAY_MS;
+const unsigned InterpolationBuffer::MAX_DELAY_MS;
+const unsigned InterpolationBuffer::MAX_EXTRAPOLATION_MS;
+
+namespace {
+
+double clamp(double p_value, double p_min, double p_max)
+{
+	return p_value < p_min ? p_min : (p_value > p_max ? p_max : p_value);
+}
+
+/** @return p_from rotated by p_ratio of the shorter way to p_to */
+CL_Angle interpolateAngle(const CL_Angle &p_from, const CL_Angle &p_to, float p_ratio)
+{
+	float delta = fmod(p_to.to_radians() - p_from.to_radians(), 2 * CL_PI);
+
+	if (delta > CL_PI) {
+		delta -= 2 * CL_PI;
+	} else if (delta < -CL_PI) {
+		delta += 2 * CL_PI;
+	}
+
+	return CL_Angle(p_from.to_radians() + delta * p_ratio, cl_radians);
+}
+
+}
+
+InterpolationBuffer::InterpolationBuffer()
+{
+	clear();
+}
+
+void InterpolationBuffer::clear()
+{
+	m_first = 0;
+	m_count = 0;
+	m_offset = 0.0;
+	m_jitter = 0.0;
+	m_interval = DEFAULT_INTERVAL_MS;
+	m_delay = clamp(DEFAULT_INTERVAL_MS, MIN_DELAY_MS, MAX_DELAY_MS);
+}
+
+bool InterpolationBuffer::add(const Sample &p_sample, double p_localTime)
+{
+	const double offset = p_sample.m_time - p_localTime;
+
+	if (m_count == 0) {
+		m_offset = offset;
+	} else {
+		const double sinceNewest = p_sample.m_time - getNewest().m_time;
+
+		if (sinceNewest <= 0.0) {
+			if (sinceNewest > -RESET_MS) {
+				return false;
+			}
+
+			// remote car started over
+			clear();
+			m_offset = offset;
+		} else {
+			// late samples lower the offset, early ones raise it
+			const double deviation = offset - m_offset;
+
+			m_offset += deviation / SMOOTHING;
+			m_jitter += (fabs(deviation) - m_jitter) / SMOOTHING;
+			m_interval += (sinceNewest - m_interval) / SMOOTHING;
+		}
+	}
+
+	// wait long enough to have a sample on both sides of shown time
+	const double delay = clamp(m_interval + 2.0 * m_jitter, MIN_DELAY_MS, MAX_DELAY_MS);
+	m_delay += (delay - m_delay) / SMOOTHING;
+
+	if (m_count < CAPACITY) {
+		m_samples[(m_first + m_count) % CAPACITY] = p_sample;
+		++m_count;
+	} else {
+		m_samples[m_first] = p_sample;
+		m_first = (m_first + 1) % CAPACITY;
+	}
+
+	return true;
+}
+
+const InterpolationBuffer::Sample &InterpolationBuffer::at(int p_index) const
+{
+	G_ASSERT(p_index >= 0 && p_index < m_count);
+	return m_samples[(m_first + p_index) % CAPACITY];
+}
+
+const InterpolationBuffer::Sample &InterpolationBuffer::getNewest() const
+{
+	return at(m_count - 1);
+}
+
+double InterpolationBuffer::getRenderTime(double p_localTime) const
+{
+	return p_localTime + m_offset - m_delay;
+}
+
+void InterpolationBuffer::sample(double p_time, Sample *p_result) const
+{
+	G_ASSERT(m_count > 0);
+
+	if (p_time <= at(0).m_time) {
+		*p_result = at(0);
+		p_result->m_time = p_time;
+		return;
+	}
+
+	const Sample &newest = getNewest();
+
+	if (p_time >= newest.m_time) {
+		const float elapsed = static_cast<float>(
+				clamp(p_time - newest.m_time, 0.0, MAX_EXTRAPOLATION_MS)
+		);
+
+		*p_result = newest;
+		p_result->m_time = p_time;
+		p_result->m_position += newest.m_velocity * elapsed;
+
+		return;
+	}
+
+	// samples are few, so linear search is fine
+	int next = 1;
+
+	while (at(next).m_time <= p_time) {
+		++next;
+	}
+
+	const Sample &a = at(next - 1);
+	const Sample &b = at(next);
+
+	const float duration = static_cast<float>(b.m_time - a.m_time);
+	const float s = static_cast<float>((p_time - a.m_time) / (b.m_time - a.m_time));
+	const float s2 = s * s;
+	const float s3 = s2 * s;
+
+	// Hermite basis functions
+	const float h00 = 2 * s3 - 3 * s2 + 1;
+	const float h10 = s3 - 2 * s2 + s;
+	const float h01 = -2 * s3 + 3 * s2;
+	const float h11 = s3 - s2;
+
+	const CL_Vec2f position =
+			CL_Vec2f(a.m_position) * h00
+			+ a.m_velocity * (h10 * duration)
+			+ CL_Vec2f(b.m_position) * h01
+			+ b.m_velocity * (h11 * duration);
+
+	p_result->m_time = p_time;
+	p_result->m_position = CL_Pointf(position.x, position.y);
+	p_result->m_velocity = a.m_velocity * (1.0f - s) + b.m_velocity * s;
+	p_result->m_angle = interpolateAngle(a.m_angle, b.m_angle, s);
+}
+
+}
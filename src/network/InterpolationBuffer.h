@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/math.h"
+
+namespace Net {
+
+/**
+ * Timestamped states of a remote car. The car is shown a little in
+ * the past, so there are usually two states around the shown time
+ * and the path between them is a cubic Hermite curve built from
+ * positions and velocities. The delay adapts to the rate and the
+ * jitter of incoming states.
+ */
+class InterpolationBuffer
+{
+	public:
+
+		struct Sample {
+
+			/** Remote time in milliseconds */
+			double m_time;
+
+			CL_Pointf m_position;
+
+			/** Movement in one millisecond */
+			CL_Vec2f m_velocity;
+
+			CL_Angle m_angle;
+
+			Sample() : m_time(0.0) {}
+		};
+
+
+		/** Number of kept samples */
+		static const int CAPACITY = 32;
+
+		static const unsigned MIN_DELAY_MS = 50;
+
+		static const unsigned MAX_DELAY_MS = 300;
+
+		/** How far the path continues past the newest sample */
+		static const unsigned MAX_EXTRAPOLATION_MS = 250;
+
+
+		InterpolationBuffer();
+
+
+		/**
+		 * Adds sample received at local time p_localTime. Samples
+		 * not newer than the newest one are ignored.
+		 *
+		 * @return false when the sample was ignored
+		 */
+		bool add(const Sample &p_sample, double p_localTime);
+
+		void clear();
+
+
+		bool isEmpty() const { return m_count == 0; }
+
+		/** @return current interpolation delay in milliseconds */
+		double getDelay() const { return m_delay; }
+
+		const Sample &getNewest() const;
+
+		/** @return remote time that should be shown at p_localTime */
+		double getRenderTime(double p_localTime) const;
+
+		/**
+		 * Samples the path at remote time p_time. Times before the
+		 * oldest sample give the oldest one, times after the newest
+		 * continue in the newest direction for a limited time.
+		 */
+		void sample(double p_time, Sample *p_result) const;
+
+	private:
+
+		/** Ring of samples, m_first is the oldest one */
+		Sample m_samples[CAPACITY];
+
+		int m_first;
+
+		int m_count;
+
+		/** Smoothed difference between remote and local time */
+		double m_offset;
+
+		/** Smoothed deviation of arrival times */
+		double m_jitter;
+
+		/** Smoothed remote time between samples */
+		double m_interval;
+
+		double m_delay;
+
+
+		const Sample &at(int p_index) const;
+};
+
+}
+
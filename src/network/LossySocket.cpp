@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LossySocket.h"
+
+namespace Net {
+
+LossySocket::LossySocket(
+		const CL_SharedPtr<DatagramSocket> &p_socket,
+		int p_lossPercent,
+		unsigned p_latencyMs,
+		unsigned p_jitterMs
+) :
+	m_socket(p_socket),
+	m_lossPercent(p_lossPercent),
+	m_latencyMs(p_latencyMs),
+	m_jitterMs(p_jitterMs),
+	m_random(1),
+	m_droppedCount(0)
+{
+	// empty
+}
+
+LossySocket::~LossySocket()
+{
+	// empty
+}
+
+void LossySocket::send(const CL_String8 &p_data, const CL_SocketName &p_to)
+{
+	if (static_cast<int>(nextRandom() % 100) < m_lossPercent) {
+		++m_droppedCount;
+		return;
+	}
+
+	Delayed delayed;
+
+	delayed.m_data = p_data;
+	delayed.m_to = p_to;
+	delayed.m_sendTime = CL_System::get_time() + m_latencyMs + nextRandom() % (m_jitterMs + 1);
+
+	m_queue.push_back(delayed);
+
+	flush();
+}
+
+bool LossySocket::receive(CL_String8 *p_data, CL_SocketName *p_from)
+{
+	flush();
+	return m_socket->receive(p_data, p_from);
+}
+
+void LossySocket::flush()
+{
+	const unsigned now = CL_System::get_time();
+
+	std::list<Delayed>::iterator itor = m_queue.begin();
+
+	while (itor != m_queue.end()) {
+		if (static_cast<int>(now - itor->m_sendTime) >= 0) {
+			m_socket->send(itor->m_data, itor->m_to);
+			itor = m_queue.erase(itor);
+		} else {
+			++itor;
+		}
+	}
+}
+
+unsigned LossySocket::nextRandom()
+{
+	// deterministic sequence makes test runs repeatable
+	m_random = m_random * 1103515245 + 12345;
+	return (m_random >> 16) & 0x7FFF;
+}
+
+}
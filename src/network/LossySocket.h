@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <list>
+
+#include "clanlib/core/system.h"
+
+#include "network/DatagramSocket.h"
+
+namespace Net {
+
+/**
+ * Testing shim that drops and delays outgoing datagrams of
+ * another socket, to reproduce bad networks on loopback.
+ */
+class LossySocket : public DatagramSocket
+{
+	public:
+
+		/**
+		 * @param p_lossPercent Chance to drop each datagram
+		 * @param p_latencyMs Delay of each datagram
+		 * @param p_jitterMs Random extra delay, reorders datagrams
+		 */
+		LossySocket(
+				const CL_SharedPtr<DatagramSocket> &p_socket,
+				int p_lossPercent,
+				unsigned p_latencyMs,
+				unsigned p_jitterMs = 0
+		);
+
+		virtual ~LossySocket();
+
+
+		virtual void send(const CL_String8 &p_data, const CL_SocketName &p_to);
+
+		virtual bool receive(CL_String8 *p_data, CL_SocketName *p_from);
+
+		/** Only outgoing datagrams are delayed, so it is the one of wrapped socket */
+		virtual CL_Event getReadEvent() { return m_socket->getReadEvent(); }
+
+
+		int getDroppedCount() const { return m_droppedCount; }
+
+	private:
+
+		struct Delayed {
+			CL_String8 m_data;
+			CL_SocketName m_to;
+			unsigned m_sendTime;
+		};
+
+		CL_SharedPtr<DatagramSocket> m_socket;
+
+		const int m_lossPercent;
+
+		const unsigned m_latencyMs;
+
+		const unsigned m_jitterMs;
+
+		std::list<Delayed> m_queue;
+
+		unsigned m_random;
+
+		int m_droppedCount;
+
+
+		/** Sends delayed datagrams which time has come */
+		void flush();
+
+		unsigned nextRandom();
+};
+
+}
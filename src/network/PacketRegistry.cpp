@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PacketRegistry.h"
+
+#include <algorithm>
+#include <map>
+
+#include "common/gassert.h"
+#include "network/events.h"
+
+namespace Net {
+
+/* Opcode names are single characters starting from this one */
+const char OPCODE_CHAR_BASE = '!';
+
+const int PacketRegistry::MAX_OPCODES;
+
+namespace {
+
+/** Event names in opcode order */
+const char *const NAMES[OPCODE_COUNT] = {
+	EVENT_CLIENT_INFO,
+	EVENT_GAME_MODE,
+	EVENT_GAME_STATE,
+	EVENT_GOODBYE,
+	EVENT_OPCODE_TABLE,
+
+	EVENT_INFO_REQUEST,
+	EVENT_INFO_RESPONSE,
+
+	EVENT_PLAYER_JOINED,
+	EVENT_PLAYER_LEFT,
+
+	EVENT_CAR_STATE,
+	EVENT_CAR_STATE_REQUEST,
+	EVENT_CAR_STATE_ACK,
+	EVENT_RACE_START,
+	EVENT_SNAPSHOT,
+	EVENT_DATAGRAM_TOKEN,
+	EVENT_DATAGRAM_OPEN,
+
+	EVENT_VOTE_START,
+	EVENT_VOTE_END,
+	EVENT_VOTE_TICK,
+
+	EVENT_RANKING_FIND,
+	EVENT_RANKING_ENTRIES,
+	EVENT_RANKING_REQUEST,
+	EVENT_RANKING_ADVANCE
+};
+
+/** Opcodes by name, built before main() so threads can share it */
+class NameIndex
+{
+	public:
+
+		std::map<CL_String, int> m_opcodes;
+
+		NameIndex()
+		{
+			for (int i = 0; i < OPCODE_COUNT; ++i) {
+				m_opcodes[NAMES[i]] = i;
+			}
+		}
+};
+
+const NameIndex NAME_INDEX;
+
+bool isOpcodeName(const CL_String &p_name)
+{
+	return p_name.length() == 1;
+}
+
+}
+
+int PacketRegistry::getOpcode(const CL_String &p_name)
+{
+	const std::map<CL_String, int>::const_iterator itor = NAME_INDEX.m_opcodes.find(p_name);
+	return itor != NAME_INDEX.m_opcodes.end() ? itor->second : OP_UNKNOWN;
+}
+
+CL_String PacketRegistry::getName(int p_opcode)
+{
+	G_ASSERT(p_opcode >= 0 && p_opcode < OPCODE_COUNT);
+	return NAMES[p_opcode];
+}
+
+std::vector<CL_String> PacketRegistry::getNames()
+{
+	return std::vector<CL_String>(NAMES, NAMES + OPCODE_COUNT);
+}
+
+PacketRegistry::PacketRegistry() :
+	m_peerKnown(false)
+{
+	// empty
+}
+
+void PacketRegistry::setPeerNames(const std::vector<CL_String> &p_names)
+{
+	const int count = std::min(static_cast<int>(p_names.size()), MAX_OPCODES);
+
+	m_fromPeer.assign(count, OP_UNKNOWN);
+	m_toPeer.assign(OPCODE_COUNT, OP_UNKNOWN);
+
+	for (int i = 0; i < count; ++i) {
+		const int opcode = getOpcode(p_names[i]);
+
+		if (opcode != OP_UNKNOWN) {
+			m_fromPeer[i] = opcode;
+			m_toPeer[opcode] = i;
+		}
+	}
+
+	m_peerKnown = true;
+}
+
+void PacketRegistry::clearPeerNames()
+{
+	m_fromPeer.clear();
+	m_toPeer.clear();
+
+	m_peerKnown = false;
+}
+
+int PacketRegistry::decode(const CL_NetGameEvent &p_event) const
+{
+	const CL_String name = p_event.get_name();
+
+	if (!isOpcodeName(name)) {
+		return getOpcode(name);
+	}
+
+	const int peerOpcode = name[0] - OPCODE_CHAR_BASE;
+
+	if (peerOpcode < 0 || peerOpcode >= static_cast<int>(m_fromPeer.size())) {
+		return OP_UNKNOWN;
+	}
+
+	return m_fromPeer[peerOpcode];
+}
+
+CL_NetGameEvent PacketRegistry::restore(const CL_NetGameEvent &p_event, int p_opcode) const
+{
+	if (!isOpcodeName(p_event.get_name())) {
+		return p_event;
+	}
+
+	CL_NetGameEvent event(getName(p_opcode));
+
+	const int argCount = static_cast<signed>(p_event.get_argument_count());
+
+	for (int i = 0; i < argCount; ++i) {
+		event.add_argument(p_event.get_argument(i));
+	}
+
+	return event;
+}
+
+CL_NetGameEvent PacketRegistry::encode(const CL_NetGameEvent &p_event) const
+{
+	if (!m_peerKnown) {
+		return p_event;
+	}
+
+	const int opcode = getOpcode(p_event.get_name());
+
+	if (opcode == OP_UNKNOWN || m_toPeer[opcode] == OP_UNKNOWN) {
+		return p_event;
+	}
+
+	CL_String name;
+	name.push_back(static_cast<char>(OPCODE_CHAR_BASE + m_toPeer[opcode]));
+
+	CL_NetGameEvent event(name);
+
+	const int argCount = static_cast<signed>(p_event.get_argument_count());
+
+	for (int i = 0; i < argCount; ++i) {
+		event.add_argument(p_event.get_argument(i));
+	}
+
+	return event;
+}
+
+}
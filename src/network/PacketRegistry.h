@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "clanlib/network/netgame.h"
+
+namespace Net {
+
+/** Opcodes of events, in the order of names in PacketRegistry */
+enum Opcode {
+	OP_UNKNOWN = -1,
+
+	// connect / disconnect procedure
+	OP_CLIENT_INFO,
+	OP_GAME_MODE,
+	OP_GAME_STATE,
+	OP_GOODBYE,
+	OP_OPCODE_TABLE,
+
+	// server query events
+	OP_INFO_REQUEST,
+	OP_INFO_RESPONSE,
+
+	// player events
+	OP_PLAYER_JOINED,
+	OP_PLAYER_LEFT,
+
+	// race events
+	OP_CAR_STATE,
+	OP_CAR_STATE_REQUEST,
+	OP_CAR_STATE_ACK,
+	OP_RACE_START,
+	OP_SNAPSHOT,
+	OP_DATAGRAM_TOKEN,
+	OP_DATAGRAM_OPEN,
+
+	// voting events
+	OP_VOTE_START,
+	OP_VOTE_END,
+	OP_VOTE_TICK,
+
+	// ranking events
+	OP_RANKING_FIND,
+	OP_RANKING_ENTRIES,
+	OP_RANKING_REQUEST,
+	OP_RANKING_ADVANCE,
+
+	OPCODE_COUNT
+};
+
+/**
+ * Maps event names to small opcodes. Once the peer knows them,
+ * events are sent with one character name holding the opcode instead
+ * of the full name, and receivers dispatch them through tables indexed
+ * by opcode. Server sends names in its opcode order at handshake and
+ * client translates between server opcodes and its own ones.
+ */
+class PacketRegistry
+{
+	public:
+
+		/** Largest number of opcodes that fit into one character name */
+		static const int MAX_OPCODES = 94;
+
+
+		/** @return opcode of event named p_name, OP_UNKNOWN when there is none */
+		static int getOpcode(const CL_String &p_name);
+
+		static CL_String getName(int p_opcode);
+
+		/** @return names of all events in opcode order */
+		static std::vector<CL_String> getNames();
+
+
+		/** Registry of peer that doesn't know opcodes yet */
+		PacketRegistry();
+
+
+		/** Uses opcodes of peer whose events are p_names in opcode order */
+		void setPeerNames(const std::vector<CL_String> &p_names);
+
+		void clearPeerNames();
+
+		bool hasPeerNames() const { return m_peerKnown; }
+
+
+		/** @return own opcode of event received by name or peer opcode */
+		int decode(const CL_NetGameEvent &p_event) const;
+
+		/** @return p_event with opcode p_opcode under its full name */
+		CL_NetGameEvent restore(const CL_NetGameEvent &p_event, int p_opcode) const;
+
+		/** @return p_event named with peer opcode, unchanged when peer doesn't know it */
+		CL_NetGameEvent encode(const CL_NetGameEvent &p_event) const;
+
+	private:
+
+		bool m_peerKnown;
+
+		/** Own opcode of each peer opcode */
+		std::vector<int> m_fromPeer;
+
+		/** Peer opcode of each own opcode, OP_UNKNOWN when peer doesn't know it */
+		std::vector<int> m_toPeer;
+};
+
+}
+
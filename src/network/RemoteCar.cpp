@@ -28,48 +28,46 @@
 
 #include "RemoteCar.h"
 
-#include "common/workarounds.h"
 #include "common/Player.h"
-#include "math/Float.h"
+#include "logic/race/CarStateData.h"
+#include "network/InterpolationBuffer.h"
 
 namespace Net
 {
 
-const int PASS_TIME = 250;
+/* Duration of one car iteration */
+const double ITERATION_MS = 1000.0 / 60.0;
 
 class RemoteCarImpl
 {
 	public:
 
-		// To preserve lags, there are two car instances: phantom and current.
-		// The phantom is car physics situated when car position didn't change.
-		// The current is car physics forced by remote player.
-		//
-		// When new packet is received only the current is positioned at new
-		// place and moving from one position to another is made step by step
-		// to make things smooth.
-
-		Race::Car m_phantomCar;
-
-		// Smooth pass float
-		// 0.0 is old car, 1.0 is new car
-		Math::Float m_passFloat;
-		mutable CL_Pointf m_pos;
-		mutable CL_Angle m_rot;
-		
-		RemoteCarImpl(Player *p_owner);
-		
+		// Remote car is not simulated. Received states are kept in
+		// the buffer with iteration time and the car is shown on the
+		// path between them, a little in the past. Car physics holds
+		// the newest state, so speed, drift and collisions use it.
+
+		InterpolationBuffer m_buffer;
+
+		/** Local time counted by updates */
+		double m_time;
+
+		CL_Pointf m_pos;
+		CL_Angle m_rot;
+
+		RemoteCarImpl();
+
 };
 
 RemoteCar::RemoteCar(Player *p_owner) :
 	Car(p_owner),
-	m_impl(new RemoteCarImpl(p_owner))
+	m_impl(new RemoteCarImpl())
 {
 	// empty
 }
 
-RemoteCarImpl::RemoteCarImpl(Player *p_owner) :
-	m_phantomCar(p_owner)
+RemoteCarImpl::RemoteCarImpl() :
+	m_time(0.0)
 {
 }
 
@@ -80,80 +78,60 @@ RemoteCar::~RemoteCar()
 
 void RemoteCar::update(unsigned int p_elapsedMS)
 {
-	Car::update(p_elapsedMS);
-	m_impl->m_phantomCar.update(p_elapsedMS);
-	m_impl->m_passFloat.update(p_elapsedMS);
-}
-
-void RemoteCar::deserialize(const CL_NetGameEvent &p_data)
-{
-	// clone this car properties to phantom
-	m_impl->m_phantomCar.clone(*this);
+	m_impl->m_time += p_elapsedMS;
 
-	// deserialize incoming data to current
-	Car::deserialize(p_data);
+	if (m_impl->m_buffer.isEmpty()) {
+		return;
+	}
 
-	// set new inputs also to phantom
-	const Race::CarInputState &inputState = getInputState();
+	InterpolationBuffer::Sample sample;
 
-	m_impl->m_phantomCar.setAcceleration(inputState.accel);
-	m_impl->m_phantomCar.setBrake(inputState.brake);
-	m_impl->m_phantomCar.setTurn(inputState.turn);
+	m_impl->m_buffer.sample(
+			m_impl->m_buffer.getRenderTime(m_impl->m_time),
+			&sample
+	);
 
-	// start passing
-	m_impl->m_passFloat.animate(0.0f, 1.0f, PASS_TIME);
+	m_impl->m_pos = sample.m_position;
+	m_impl->m_rot = sample.m_angle;
 }
 
-const CL_Pointf& RemoteCar::getPosition() const
+void RemoteCar::applyState(const Race::CarStateData &p_state)
 {
-	const CL_Pointf &thisPos = Car::getPosition();
+	Car::applyState(p_state);
 
-	// when passing phantom to current calculate the position
-	// based on current passing ratio
+	InterpolationBuffer::Sample sample;
 
-	const float newCarRatio = m_impl->m_passFloat.get();
+	sample.m_time = p_state.get(Race::CarStateData::F_ITERATION) * ITERATION_MS;
+	sample.m_position = Car::getPosition();
+	sample.m_velocity = getPhyMoveVector() / static_cast<float>(ITERATION_MS);
+	sample.m_angle = Car::getCorpseAngle();
 
-	if (fabs(newCarRatio - 1.0f) > 0.01) {
-		const CL_Pointf &phanPos = m_impl->m_phantomCar.getPosition();
+	const bool first = m_impl->m_buffer.isEmpty();
+	m_impl->m_buffer.add(sample, m_impl->m_time);
 
-		const CL_Vec2f delta = (thisPos - phanPos) * newCarRatio;
-		m_impl->m_pos = phanPos + delta;
+	// nothing to interpolate from yet
+	if (first) {
+		m_impl->m_pos = sample.m_position;
+		m_impl->m_rot = sample.m_angle;
+	}
+}
 
-		return m_impl->m_pos;
+const CL_Pointf& RemoteCar::getPosition() const
+{
+	if (m_impl->m_buffer.isEmpty()) {
+		return Car::getPosition();
 	}
 
-	return thisPos;
+	return m_impl->m_pos;
 }
 
 const CL_Angle &RemoteCar::getCorpseAngle() const
 {
-	const CL_Angle &thisAngle = Car::getCorpseAngle();
-
-	// when passing phantom to current calculate the rotation
-	// based on current passing ratio
-
-	const float newCarRatio = m_impl->m_passFloat.get();
-
-	if (fabs(newCarRatio - 1.0f) > 0.01) {
-		const CL_Angle &phanAngle = m_impl->m_phantomCar.getCorpseAngle();
-
-		CL_Angle delta = thisAngle - phanAngle;
-
-		// make the angle the lowest value to rotate
-		Workarounds::clAngleNormalize(&delta);
-
-		if (delta.to_radians() > CL_PI) {
-			delta.set_radians(delta.to_radians() - 2 * CL_PI);
-		}
-
-		delta.set_radians(delta.to_radians() * newCarRatio);
-
-		m_impl->m_rot = phanAngle + delta;
-
-		return m_impl->m_rot;
+	if (m_impl->m_buffer.isEmpty()) {
+		return Car::getCorpseAngle();
 	}
 
-	return thisAngle;
+	return m_impl->m_rot;
 }
 
 }
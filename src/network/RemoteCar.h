@@ -51,7 +51,7 @@ class RemoteCar : public Race::Car
 		virtual const CL_Pointf& getPosition() const;
 		virtual const CL_Angle &getCorpseAngle() const;
 
-		virtual void deserialize(const CL_NetGameEvent &p_data);
+		virtual void applyState(const Race::CarStateData &p_state);
 		virtual void update(unsigned int p_elapsedMS);
 
 	private:
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "UdpSocket.h"
+
+#include "common.h"
+#include "common/Properties.h"
+#include "network/LossySocket.h"
+
+namespace Net {
+
+/* Largest datagram accepted */
+const int RECEIVE_BUFFER_SIZE = 2048;
+
+UdpSocket::UdpSocket(const CL_String &p_port) :
+	m_socket(CL_SocketName(p_port))
+{
+	// empty
+}
+
+UdpSocket::~UdpSocket()
+{
+	// empty
+}
+
+CL_SharedPtr<DatagramSocket> UdpSocket::open(const CL_String &p_port)
+{
+	CL_SharedPtr<DatagramSocket> socket(new UdpSocket(p_port));
+
+	const int loss = Properties::getInt(DBG_NET_LOSS, 0);
+	const int latency = Properties::getInt(DBG_NET_LATENCY, 0);
+	const int jitter = Properties::getInt(DBG_NET_JITTER, 0);
+
+	if (loss > 0 || latency > 0 || jitter > 0) {
+		cl_log_event(
+				LOG_WARN,
+				"simulating datagram loss %1 percent, latency %2 ms, jitter %3 ms",
+				loss, latency, jitter
+		);
+
+		socket = CL_SharedPtr<DatagramSocket>(new LossySocket(socket, loss, latency, jitter));
+	}
+
+	return socket;
+}
+
+void UdpSocket::send(const CL_String8 &p_data, const CL_SocketName &p_to)
+{
+	try {
+		m_socket.send(p_data.data(), p_data.length(), p_to);
+	} catch (const CL_Exception &e) {
+		// datagrams may be lost anyway
+		cl_log_event(LOG_DEBUG, "datagram not sent: %1", e.message);
+	}
+}
+
+bool UdpSocket::receive(CL_String8 *p_data, CL_SocketName *p_from)
+{
+	if (!m_socket.get_read_event().wait(0)) {
+		return false;
+	}
+
+	char buffer[RECEIVE_BUFFER_SIZE];
+
+	try {
+		const int size = m_socket.receive(buffer, RECEIVE_BUFFER_SIZE, *p_from);
+
+		if (size <= 0) {
+			return false;
+		}
+
+		*p_data = CL_String8(buffer, size);
+		return true;
+
+	} catch (const CL_Exception &e) {
+		cl_log_event(LOG_DEBUG, "datagram not received: %1", e.message);
+		return false;
+	}
+}
+
+}
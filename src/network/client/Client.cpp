@@ -28,29 +28,71 @@
 
 #include "Client.h"
 
+#include "common/BitStream.h"
 #include "common/Game.h"
 #include "common.h"
+#include "network/DatagramChannel.h"
+#include "network/UdpSocket.h"
+#include "network/PacketRegistry.h"
 #include "network/events.h"
 #include "network/packets/Goodbye.h"
 #include "network/packets/ClientInfo.h"
+#include "network/packets/DatagramOpen.h"
+#include "network/packets/DatagramToken.h"
 #include "network/packets/GameMode.h"
 #include "network/packets/GameState.h"
+#include "network/packets/OpcodeTable.h"
 #include "network/packets/CarState.h"
+#include "network/packets/CarStateAck.h"
+#include "network/packets/CarStateRequest.h"
 #include "network/packets/VoteStart.h"
 #include "network/packets/VoteEnd.h"
 #include "network/packets/VoteTick.h"
 #include "network/packets/RaceStart.h"
+#include "network/packets/Snapshot.h"
 
 namespace Net {
 
 Client::Client() :
 	m_port(DEFAULT_PORT),
 	m_connected(false),
-	m_rankingClient(this)
+	m_rankingClient(this),
+	m_datagramToken(0),
+	m_datagramChallenge(0),
+	m_datagramConfirmed(false),
+	m_lastHelloTime(0)
 {
 	m_slots.connect(m_gameClient.sig_connected(), this, &Client::onConnected);
 	m_slots.connect(m_gameClient.sig_disconnected(), this, &Client::onDisconnected);
 	m_slots.connect(m_gameClient.sig_event_received(), this, &Client::onEventReceived);
+
+	for (int i = 0; i < OPCODE_COUNT; ++i) {
+		m_handlers[i] = NULL;
+	}
+
+	// connect / disconnect procedure
+	m_handlers[OP_GOODBYE] = &Client::onGoodbye;
+	m_handlers[OP_GAME_MODE] = &Client::onGameMode;
+	m_handlers[OP_GAME_STATE] = &Client::onGameState;
+	m_handlers[OP_OPCODE_TABLE] = &Client::onOpcodeTable;
+
+	// player events
+	m_handlers[OP_PLAYER_JOINED] = &Client::onPlayerJoined;
+	m_handlers[OP_PLAYER_LEFT] = &Client::onPlayerLeaved;
+
+	// race events
+	m_handlers[OP_CAR_STATE] = &Client::onCarState;
+	m_handlers[OP_CAR_STATE_REQUEST] = &Client::onCarStateRequest;
+	m_handlers[OP_CAR_STATE_ACK] = &Client::onCarStateAck;
+	m_handlers[OP_SNAPSHOT] = &Client::onSnapshot;
+	m_handlers[OP_DATAGRAM_TOKEN] = &Client::onDatagramToken;
+	m_handlers[OP_RACE_START] = &Client::onRaceStart;
+	m_handlers[OP_VOTE_START] = &Client::onVoteStart;
+	m_handlers[OP_VOTE_END] = &Client::onVoteEnd;
+	m_handlers[OP_VOTE_TICK] = &Client::onVoteTick;
+
+	// ranking events
+	m_handlers[OP_RANKING_ENTRIES] = &Client::onRankingEvent;
 }
 
 Client::~Client() {
@@ -94,12 +136,67 @@ bool Client::isConnected() const
 void Client::send(const CL_NetGameEvent &p_event)
 {
 	cl_log_event("network", "sending event: %1", p_event.to_string());
-	m_gameClient.send_event(p_event);
+	m_gameClient.send_event(m_registry.encode(p_event));
 }
 
 void Client::sendCarState(const Net::CarState &p_state)
 {
-	send(p_state.buildEvent());
+	if (m_datagramConfirmed) {
+		BitWriter writer;
+		p_state.write(writer);
+
+		sendDatagram(DATAGRAM_CAR_STATE, writer.getData());
+	} else {
+		send(p_state.buildEvent());
+	}
+}
+
+void Client::sendDatagram(unsigned p_type, const CL_String8 &p_payload)
+{
+	CL_String8 message;
+
+	message.push_back(static_cast<char>(p_type));
+	message.append(p_payload);
+
+	m_datagramChannel->send(m_datagramToken, message, m_datagramServer);
+}
+
+void Client::update()
+{
+	if (!m_datagramChannel) {
+		return;
+	}
+
+	// say hello until server knows this client address
+	static const unsigned HELLO_INTERVAL_MS = 250;
+
+	const unsigned now = CL_System::get_time();
+
+	if (!m_datagramConfirmed && now - m_lastHelloTime >= HELLO_INTERVAL_MS) {
+		BitWriter writer;
+		writer.writeBits(m_datagramChallenge, 32);
+
+		sendDatagram(DATAGRAM_HELLO, writer.getData());
+		m_lastHelloTime = now;
+	}
+
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	while (m_datagramChannel->receive(&token, &message, &from)) {
+		if (token == m_datagramToken && !message.empty()) {
+			onDatagram(message);
+		}
+	}
+}
+
+void Client::sendCarStateRequest(const CL_String &p_name)
+{
+	CarStateRequest request;
+	request.setName(p_name);
+
+	send(request.buildEvent());
 }
 
 void Client::onConnected()
@@ -110,7 +207,11 @@ void Client::onConnected()
 	// Sending player info
 	ClientInfo playerInfo;
 
-	playerInfo.setName(Game::getInstance().getPlayer().getName());
+	if (m_playerName.empty()) {
+		playerInfo.setName(Game::getInstance().getPlayer().getName());
+	} else {
+		playerInfo.setName(m_playerName);
+	}
 	cl_log_event("network", "Introducing myself as %1", playerInfo.getName());
 
 	send(playerInfo.buildEvent());
@@ -124,6 +225,12 @@ void Client::onDisconnected()
 
 	m_connected = false;
 
+	// next server may number events differently
+	m_registry.clearPeerNames();
+
+	m_datagramChannel = CL_SharedPtr<DatagramChannel>();
+	m_datagramConfirmed = false;
+
 	INVOKE_0(disconnected);
 }
 
@@ -132,53 +239,12 @@ void Client::onEventReceived(const CL_NetGameEvent &p_event)
 	cl_log_event("event", "event arrived: %1", p_event.to_string());
 
 	try {
-		const CL_String eventName = p_event.get_name();
-		bool unhandled = false;
-
-		// connect / disconnect procedure
-
-		if (eventName == EVENT_GOODBYE) {
-			onGoodbye(p_event);
-		} else if (eventName == EVENT_GAME_MODE) {
-			onGameMode(p_event);
-		} else if (eventName == EVENT_GAME_STATE) {
-			onGameState(p_event);
-		}
-
-		// player events
-
-		else if (eventName == EVENT_PLAYER_JOINED) {
-			onPlayerJoined(p_event);
-		} else if (eventName == EVENT_PLAYER_LEFT) {
-			onPlayerLeaved(p_event);
-		}
-
-		// race events
-
-		else if (eventName == EVENT_CAR_STATE) {
-			onCarState(p_event);
-		} else if (eventName == EVENT_RACE_START) {
-			onRaceStart(p_event);
-		} else if (eventName == EVENT_VOTE_START) {
-			onVoteStart(p_event);
-		} else if (eventName == EVENT_VOTE_END) {
-			onVoteEnd(p_event);
-		} else if (eventName == EVENT_VOTE_TICK) {
-			onVoteTick(p_event);
-		}
-
-		// ranking events
-		else if (isRankingEvent(p_event)) {
-			m_rankingClient.parseEvent(p_event);
-		}
+		const int opcode = m_registry.decode(p_event);
+		const TEventHandler handler = opcode != OP_UNKNOWN ? m_handlers[opcode] : NULL;
 
-		// unknown events remain unhandled
-
-		else {
-			unhandled = true;
-		}
-
-		if (unhandled) {
+		if (handler != NULL) {
+			(this->*handler)(m_registry.restore(p_event, opcode));
+		} else {
 			cl_log_event("error", "Event %1 remains unhandled", p_event.to_string());
 		}
 
@@ -199,6 +265,15 @@ void Client::onGoodbye(const CL_NetGameEvent &p_event)
 	INVOKE_2(goodbyeReceived, goodbye.getGoodbyeReason(), goodbye.getStringMessage());
 }
 
+void Client::onOpcodeTable(const CL_NetGameEvent &p_event)
+{
+	OpcodeTable opcodeTable;
+	opcodeTable.parseEvent(p_event);
+
+	// events are sent by opcode from now on
+	m_registry.setPeerNames(opcodeTable.getNames());
+}
+
 void Client::onGameMode(const CL_NetGameEvent &p_gameState)
 {
 	GameMode gameModePacket;
@@ -242,6 +317,100 @@ void Client::onCarState(const CL_NetGameEvent &p_event)
 	INVOKE_1(carStateReceived, state);
 }
 
+void Client::onCarStateRequest(const CL_NetGameEvent &p_event)
+{
+	CarStateRequest request;
+	request.parseEvent(p_event);
+
+	INVOKE_1(carStateRequested, request.getName());
+}
+
+void Client::onCarStateAck(const CL_NetGameEvent &p_event)
+{
+	CarStateAck ack;
+	ack.parseEvent(p_event);
+
+	INVOKE_1(carStateAcknowledged, ack);
+}
+
+void Client::onSnapshot(const CL_NetGameEvent &p_event)
+{
+	Snapshot snapshot;
+	snapshot.parseEvent(p_event);
+
+	INVOKE_1(snapshotReceived, snapshot);
+}
+
+void Client::onDatagramToken(const CL_NetGameEvent &p_event)
+{
+	DatagramToken datagramToken;
+	datagramToken.parseEvent(p_event);
+
+	m_datagramChallenge = datagramToken.getChallenge();
+	m_datagramConfirmed = false;
+	m_lastHelloTime = 0;
+
+	// new challenge for the same channel, answered from the same socket
+	if (m_datagramChannel && datagramToken.getToken() == m_datagramToken) {
+		return;
+	}
+
+	try {
+		m_datagramChannel = CL_SharedPtr<DatagramChannel>(new DatagramChannel(UdpSocket::open()));
+
+		m_datagramServer = CL_SocketName(m_addr, CL_StringHelp::int_to_local8(datagramToken.getPort()));
+		m_datagramToken = datagramToken.getToken();
+	} catch (const CL_Exception &e) {
+		// car states will go through the reliable connection
+		cl_log_event("error", "Cannot open datagram channel: %1", e.message);
+		m_datagramChannel = CL_SharedPtr<DatagramChannel>();
+	}
+}
+
+void Client::onDatagram(const CL_String8 &p_message)
+{
+	const unsigned type = static_cast<unsigned char>(p_message[0]);
+	const CL_String8 payload = p_message.substr(1);
+
+	try {
+		switch (type) {
+			case DATAGRAM_HELLO:
+				if (!m_datagramConfirmed) {
+					cl_log_event("network", "Datagram channel is open");
+					m_datagramConfirmed = true;
+
+					// until now server sends everything through reliable connection
+					DatagramOpen datagramOpen;
+					datagramOpen.setChallenge(m_datagramChallenge);
+
+					send(datagramOpen.buildEvent());
+				}
+				break;
+
+			case DATAGRAM_SNAPSHOT: {
+				Snapshot snapshot;
+				snapshot.unpack(payload);
+
+				INVOKE_1(snapshotReceived, snapshot);
+				break;
+			}
+
+			case DATAGRAM_CAR_STATE_ACK: {
+				CarStateAck ack;
+				ack.setData(payload);
+
+				INVOKE_1(carStateAcknowledged, ack);
+				break;
+			}
+
+			default:
+				cl_log_event("error", "Unknown datagram type %1", type);
+		}
+	} catch (CL_Exception e) {
+		cl_log_event("exception", e.message);
+	}
+}
+
 void Client::onRaceStart(const CL_NetGameEvent &p_event)
 {
 	RaceStart raceStart;
@@ -303,6 +472,11 @@ void Client::vote(bool p_yes)
 	send(tick.buildEvent());
 }
 
+void Client::onRankingEvent(const CL_NetGameEvent &p_event)
+{
+	m_rankingClient.parseEvent(m_registry.decode(p_event), p_event);
+}
+
 RankingClient &Client::getRankingClient()
 {
 	return m_rankingClient;
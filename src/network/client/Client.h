@@ -30,6 +30,7 @@
 
 #include "clanlib/core/signals.h"
 #include "clanlib/network/netgame.h"
+#include "clanlib/network/socket.h"
 
 #include "common.h"
 #include "common/types.h"
@@ -37,12 +38,16 @@
 #include "common/Player.h"
 #include "logic/race/Car.h"
 #include "logic/race/level/Level.h"
+#include "network/PacketRegistry.h"
 #include "network/client/RankingClient.h"
 
 namespace Net {
 
 class CarState;
+class CarStateAck;
+class DatagramChannel;
 class GameState;
+class Snapshot;
 
 class Client {
 
@@ -72,6 +77,15 @@ class Client {
 		/** Got new car state */
 		SIGNAL_1(carStateReceived, const Net::CarState&);
 
+		/** Got car states changed since the previous snapshot */
+		SIGNAL_1(snapshotReceived, const Net::Snapshot&);
+
+		/** Server asks for full state of named player car */
+		SIGNAL_1(carStateRequested, const CL_String&);
+
+		/** Server validated local car state */
+		SIGNAL_1(carStateAcknowledged, const Net::CarStateAck&);
+
 		/** Should start the race */
 		SIGNAL_2(raceStartReceived, const CL_Pointf&, const CL_Angle&);
 
@@ -93,6 +107,9 @@ class Client {
 
 		bool isConnected() const;
 
+		/** @return true when car states go through the datagram channel */
+		bool isDatagramChannelOpen() const { return m_datagramConfirmed; }
+
 
 		const CL_String& getServerAddr() const { return m_addr; }
 
@@ -105,6 +122,9 @@ class Client {
 
 		void setServerPort(int p_port) { m_port = p_port; }
 
+		/** Name introduced to the server, local player name when empty */
+		void setPlayerName(const CL_String &p_name) { m_playerName = p_name; }
+
 
 		void callAVote(VoteType p_type, const CL_String& subject="");
 
@@ -112,19 +132,34 @@ class Client {
 
 		void disconnect();
 
+		/**
+		 * Sends car state through the datagram channel when it is open.
+		 * Such states may be lost, so they should be full ones.
+		 */
 		void sendCarState(const Net::CarState &p_state);
 
+		/** Asks for full state of named player car */
+		void sendCarStateRequest(const CL_String &p_name);
+
 		void voteNo();
 
 		void voteYes();
 
+		/** Reads datagrams and keeps the datagram channel open */
+		void update();
+
 
 	private:
 
+		typedef void (Client::*TEventHandler)(const CL_NetGameEvent&);
+
+
 		CL_String m_addr;
 
 		int m_port;
 
+		CL_String m_playerName;
+
 		volatile bool m_connected;
 
 		CL_NetGameClient m_gameClient;
@@ -133,6 +168,28 @@ class Client {
 
 		CL_SlotContainer m_slots;
 
+		/** Opcodes of the server, known after its opcode table arrives */
+		PacketRegistry m_registry;
+
+		/** Handlers by opcode, NULL for events not handled here */
+		TEventHandler m_handlers[OPCODE_COUNT];
+
+
+		/** Unreliable channel, set when server sends the token */
+		CL_SharedPtr<DatagramChannel> m_datagramChannel;
+
+		CL_SocketName m_datagramServer;
+
+		unsigned m_datagramToken;
+
+		/** Sent back in hello, so server trusts the datagram address */
+		unsigned m_datagramChallenge;
+
+		/** Server received datagrams from this client */
+		bool m_datagramConfirmed;
+
+		unsigned m_lastHelloTime;
+
 
 		//
 		// helpers
@@ -140,6 +197,8 @@ class Client {
 
 		void send(const CL_NetGameEvent &p_event);
 
+		void sendDatagram(unsigned p_type, const CL_String8 &p_payload);
+
 		void vote(bool p_yes);
 
 		//
@@ -161,6 +220,8 @@ class Client {
 
 		void onGoodbye(const CL_NetGameEvent &p_event);
 
+		void onOpcodeTable(const CL_NetGameEvent &p_event);
+
 		void onGameMode(const CL_NetGameEvent &p_gameState);
 
 		void onGameState(const CL_NetGameEvent &p_gameState);
@@ -171,6 +232,16 @@ class Client {
 
 		void onCarState(const CL_NetGameEvent &p_event);
 
+		void onCarStateRequest(const CL_NetGameEvent &p_event);
+
+		void onCarStateAck(const CL_NetGameEvent &p_event);
+
+		void onSnapshot(const CL_NetGameEvent &p_event);
+
+		void onDatagramToken(const CL_NetGameEvent &p_event);
+
+		void onDatagram(const CL_String8 &p_message);
+
 		void onRaceStart(const CL_NetGameEvent &p_event);
 
 		void onVoteStart(const CL_NetGameEvent &p_event);
@@ -179,6 +250,8 @@ class Client {
 
 		void onVoteTick(const CL_NetGameEvent &p_event);
 
+		void onRankingEvent(const CL_NetGameEvent &p_event);
+
 
 		friend class RankingClient;
 		friend class RankingClientImpl;
@@ -29,6 +29,7 @@
 #include "RankingClient.h"
 
 #include "network/events.h"
+#include "network/PacketRegistry.h"
 #include "common/Game.h"
 #include "network/client/Client.h"
 #include "network/packets/RankingAdvance.h"
@@ -51,7 +52,7 @@ class RankingClientImpl
 			m_client(p_client)
 		{ /* empty */ }
 
-		void parseEvent(const CL_NetGameEvent &p_event);
+		void parseEvent(int p_opcode, const CL_NetGameEvent &p_event);
 		void parseEntriesEvent(const CL_NetGameEvent &p_event);
 
 		int findEntry(const CL_String &p_playerId);
@@ -119,19 +120,20 @@ int RankingClientImpl::findEntry(const CL_String &p_playerId)
 	return packet.getToken();
 }
 
-void RankingClient::parseEvent(const CL_NetGameEvent &p_event)
+void RankingClient::parseEvent(int p_opcode, const CL_NetGameEvent &p_event)
 {
-	m_impl->parseEvent(p_event);
+	m_impl->parseEvent(p_opcode, p_event);
 }
 
-void RankingClientImpl::parseEvent(const CL_NetGameEvent &p_event)
+void RankingClientImpl::parseEvent(int p_opcode, const CL_NetGameEvent &p_event)
 {
-	const CL_String eventName = p_event.get_name();
+	switch (p_opcode) {
+		case OP_RANKING_ENTRIES:
+			parseEntriesEvent(p_event);
+			break;
 
-	if (eventName == EVENT_RANKING_ENTRIES) {
-		parseEntriesEvent(p_event);
-	} else {
-		cl_log_event(LOG_ERROR, "event remains unhandled: %1", p_event.to_string());
+		default:
+			cl_log_event(LOG_ERROR, "event remains unhandled: %1", p_event.to_string());
 	}
 }
 
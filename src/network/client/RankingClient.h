@@ -61,7 +61,7 @@ class RankingClient : boost::noncopyable
 
 		CL_SharedPtr<RankingClientImpl> m_impl;
 
-		void parseEvent(const CL_NetGameEvent &p_event);
+		void parseEvent(int p_opcode, const CL_NetGameEvent &p_event);
 
 		friend class Client;
 };
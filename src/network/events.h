@@ -37,6 +37,7 @@
 #define EVENT_GAME_MODE     "game_mode"
 #define EVENT_GAME_STATE 	"game_state"
 #define EVENT_GOODBYE		"goodbye"
+#define EVENT_OPCODE_TABLE	"opcode_table"
 
 // server query events
 
@@ -51,7 +52,22 @@
 // race events
 
 #define EVENT_CAR_STATE		"car_state"
+#define EVENT_CAR_STATE_REQUEST	"car_state_request"
+#define EVENT_CAR_STATE_ACK	"car_state_ack"
 #define EVENT_RACE_START	"race_start"
+#define EVENT_SNAPSHOT		"snapshot"
+
+// datagram channel
+
+#define EVENT_DATAGRAM_TOKEN	"datagram_token"
+#define EVENT_DATAGRAM_OPEN	"datagram_open"
+
+// datagram message types, the first byte of each message
+
+#define DATAGRAM_HELLO		0
+#define DATAGRAM_CAR_STATE	1
+#define DATAGRAM_SNAPSHOT	2
+#define DATAGRAM_CAR_STATE_ACK	3
 
 // voting event
 
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BotSwarm.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "clanlib/core/io.h"
+
+#include "common.h"
+#include "common/loglevels.h"
+#include "common/Properties.h"
+#include "logic/race/level/Level.h"
+#include "network/loadbot/LoadBot.h"
+#include "network/loadbot/LoadStats.h"
+
+namespace Net {
+
+/* Defaults of swarm settings */
+const int DEFAULT_BOTS = 100;
+const int DEFAULT_RAMP_STEP = 10;
+const int DEFAULT_RAMP_INTERVAL_MS = 5000;
+const int DEFAULT_REPORT_INTERVAL_MS = 5000;
+
+class BotSwarmImpl
+{
+	public:
+
+		typedef std::map<CL_String, CL_SharedPtr<Race::Level> > TLevelMap;
+
+
+		BotSwarm *m_parent;
+
+		CL_String m_addr;
+
+		int m_port;
+
+		CL_String m_namePrefix;
+
+		LoadBot::DrivingMode m_drivingMode;
+
+		int m_targetBotCount;
+
+		int m_rampStep;
+
+		unsigned m_rampInterval;
+
+		unsigned m_reportInterval;
+
+
+		std::vector<CL_SharedPtr<LoadBot> > m_bots;
+
+		TLevelMap m_levels;
+
+		LoadStats m_stats;
+
+		unsigned m_startTime;
+
+		unsigned m_lastRampTime;
+
+		unsigned m_lastReportTime;
+
+
+		explicit BotSwarmImpl(BotSwarm *p_parent);
+
+		void addBots(int p_count);
+
+		void report(unsigned p_now);
+};
+
+BotSwarm::BotSwarm() :
+		m_impl(new BotSwarmImpl(this))
+{
+	// empty
+}
+
+BotSwarmImpl::BotSwarmImpl(BotSwarm *p_parent) :
+		m_parent(p_parent),
+		m_addr(Properties::getString(LB_SERVER, "localhost")),
+		m_port(Properties::getInt(LB_PORT, DEFAULT_PORT)),
+		m_namePrefix(Properties::getString(LB_NAME_PREFIX, "bot")),
+		m_drivingMode(LoadBot::DM_TRACK),
+		m_targetBotCount(std::max(0, Properties::getInt(LB_BOTS, DEFAULT_BOTS))),
+		m_rampStep(std::max(1, Properties::getInt(LB_RAMP_STEP, DEFAULT_RAMP_STEP))),
+		m_rampInterval(std::max(0, Properties::getInt(LB_RAMP_INTERVAL, DEFAULT_RAMP_INTERVAL_MS))),
+		m_reportInterval(std::max(1, Properties::getInt(LB_REPORT_INTERVAL, DEFAULT_REPORT_INTERVAL_MS))),
+		m_startTime(CL_System::get_time()),
+		m_lastRampTime(0),
+		m_lastReportTime(m_startTime)
+{
+	const CL_String driving = Properties::getString(LB_DRIVING, LB_DRIVING_TRACK);
+
+	if (driving == LB_DRIVING_RANDOM) {
+		m_drivingMode = LoadBot::DM_RANDOM;
+	} else if (driving != LB_DRIVING_TRACK) {
+		throw CL_Exception("unknown driving mode: " + driving);
+	}
+
+	cl_log_event(
+			LOG_INFO,
+			"ramping up %1 bots against %2:%3",
+			m_targetBotCount,
+			m_addr,
+			m_port
+	);
+}
+
+BotSwarm::~BotSwarm()
+{
+	// empty
+}
+
+void BotSwarm::update(unsigned p_timeElapsedMs)
+{
+	const unsigned now = CL_System::get_time();
+	const int botCount = m_impl->m_bots.size();
+
+	if (
+			botCount < m_impl->m_targetBotCount
+			&& (botCount == 0 || now - m_impl->m_lastRampTime >= m_impl->m_rampInterval)
+	) {
+		m_impl->addBots(std::min(m_impl->m_rampStep, m_impl->m_targetBotCount - botCount));
+		m_impl->m_lastRampTime = now;
+	}
+
+	foreach (const CL_SharedPtr<LoadBot> &bot, m_impl->m_bots) {
+		bot->update(p_timeElapsedMs);
+	}
+
+	if (now - m_impl->m_lastReportTime >= m_impl->m_reportInterval) {
+		m_impl->report(now);
+		m_impl->m_lastReportTime = now;
+	}
+}
+
+void BotSwarmImpl::addBots(int p_count)
+{
+	for (int i = 0; i < p_count; ++i) {
+		const CL_String name = cl_format("%1%2", m_namePrefix, static_cast<int>(m_bots.size()));
+		CL_SharedPtr<LoadBot> bot(new LoadBot(name, m_drivingMode, *m_parent));
+
+		if (!bot->connect(m_addr, m_port)) {
+			cl_log_event(LOG_ERROR, "bot '%1' cannot connect", name);
+		}
+
+		m_bots.push_back(bot);
+	}
+}
+
+void BotSwarmImpl::report(unsigned p_now)
+{
+	const unsigned elapsed = p_now - m_lastReportTime;
+
+	int joined = 0;
+	int dropped = 0;
+
+	foreach (const CL_SharedPtr<LoadBot> &bot, m_bots) {
+		if (bot->isJoined()) {
+			++joined;
+		} else if (bot->isDisconnected()) {
+			++dropped;
+		}
+	}
+
+	const LatencyStats &roundTrip = m_stats.getRoundTrip();
+	const LatencyStats &relay = m_stats.getRelay();
+	const LatencyStats &join = m_stats.getJoin();
+
+	CL_Console::write_line(
+			"[%1 s] bots: %2 joined, %3 dropped, %4 started",
+			(p_now - m_startTime) / 1000,
+			joined,
+			dropped,
+			static_cast<int>(m_bots.size())
+	);
+
+	CL_Console::write_line(
+			"  sent: %1 states/s, %2 B/s; relayed: %3 states/s",
+			m_stats.getSentCount() * 1000 / elapsed,
+			m_stats.getSentBytes() * 1000 / elapsed,
+			m_stats.getRelayedCount() * 1000 / elapsed
+	);
+
+	CL_Console::write_line(
+			"  ack rtt ms: avg %1, p95 %2, max %3; corrected %4",
+			roundTrip.getAverage(),
+			roundTrip.getPercentile(95),
+			roundTrip.getMax(),
+			m_stats.getCorrectedCount()
+	);
+
+	CL_Console::write_line(
+			"  relay ms: avg %1, p95 %2, max %3",
+			relay.getAverage(),
+			relay.getPercentile(95),
+			relay.getMax()
+	);
+
+	if (join.getCount() > 0) {
+		CL_Console::write_line(
+				"  join ms: avg %1, max %2 over %3 bots",
+				join.getAverage(),
+				join.getMax(),
+				join.getCount()
+		);
+	}
+
+	m_stats.clear();
+}
+
+const Race::Level &BotSwarm::getLevel(const CL_String &p_path)
+{
+	BotSwarmImpl::TLevelMap::iterator itor = m_impl->m_levels.find(p_path);
+
+	if (itor != m_impl->m_levels.end()) {
+		return *itor->second;
+	}
+
+	// level file is shared with the local server,
+	// without it bots drive at random
+	CL_SharedPtr<Race::Level> level(new Race::Level());
+
+	if (CL_FileHelp::file_exists(p_path)) {
+		level->load(p_path);
+	} else {
+		cl_log_event(LOG_WARN, "level %1 not found, driving at random", p_path);
+	}
+
+	m_impl->m_levels[p_path] = level;
+	return *level;
+}
+
+LoadStats &BotSwarm::getStats()
+{
+	return m_impl->m_stats;
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/system.h"
+#include "clanlib/core/text.h"
+
+namespace Race {
+	class Level;
+}
+
+namespace Net {
+
+class BotSwarmImpl;
+class LoadStats;
+
+/**
+ * Many load bots in one process connected to the same server. Bots
+ * are added step by step as set in properties, all of them are
+ * updated by the thread that processes their network events.
+ * Statistics are written to console after each report interval.
+ */
+class BotSwarm
+{
+	public:
+
+		BotSwarm();
+
+		virtual ~BotSwarm();
+
+
+		/** Adds bots due by ramp schedule, drives them and reports */
+		void update(unsigned p_timeElapsedMs);
+
+
+		/** Level of a room, loaded once for all bots */
+		const Race::Level &getLevel(const CL_String &p_path);
+
+		LoadStats &getStats();
+
+	private:
+
+		CL_SharedPtr<BotSwarmImpl> m_impl;
+};
+
+}
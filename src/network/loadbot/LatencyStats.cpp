@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LatencyStats.h"
+
+#include <algorithm>
+
+namespace Net {
+
+LatencyStats::LatencyStats() :
+	m_sorted(true),
+	m_sum(0),
+	m_max(0)
+{
+	// empty
+}
+
+void LatencyStats::add(unsigned p_ms)
+{
+	m_samples.push_back(p_ms);
+	m_sorted = false;
+
+	m_sum += p_ms;
+	m_max = std::max(m_max, p_ms);
+}
+
+void LatencyStats::clear()
+{
+	m_samples.clear();
+	m_sorted = true;
+
+	m_sum = 0;
+	m_max = 0;
+}
+
+unsigned LatencyStats::getAverage() const
+{
+	if (m_samples.empty()) {
+		return 0;
+	}
+
+	return static_cast<unsigned>(m_sum / m_samples.size());
+}
+
+unsigned LatencyStats::getMax() const
+{
+	return m_max;
+}
+
+unsigned LatencyStats::getPercentile(unsigned p_percent) const
+{
+	if (m_samples.empty()) {
+		return 0;
+	}
+
+	if (!m_sorted) {
+		std::sort(m_samples.begin(), m_samples.end());
+		m_sorted = true;
+	}
+
+	// nearest rank
+	const unsigned count = m_samples.size();
+	const unsigned rank = std::max(1u, (std::min(p_percent, 100u) * count + 99) / 100);
+
+	return m_samples[rank - 1];
+}
+
+}
@@ -0,0 +1,541 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LoadBot.h"
+
+#include <deque>
+#include <map>
+#include <math.h>
+
+#include "common.h"
+#include "common/loglevels.h"
+#include "common/Player.h"
+#include "logic/race/Car.h"
+#include "logic/race/CarStateData.h"
+#include "logic/race/level/Level.h"
+#include "logic/race/level/Track.h"
+#include "logic/race/level/TrackPoint.h"
+#include "network/CarStateCodec.h"
+#include "network/client/Client.h"
+#include "network/loadbot/BotSwarm.h"
+#include "network/loadbot/LoadStats.h"
+#include "network/packets/CarState.h"
+#include "network/packets/CarStateAck.h"
+#include "network/packets/GameState.h"
+#include "network/packets/Snapshot.h"
+
+namespace Net {
+
+/* State is sent again after this time, like the game client does */
+const unsigned CAR_STATE_REFRESH_MS = 100;
+
+/* Car states waiting for acknowledge, older ones are dropped */
+const unsigned PENDING_ACK_HISTORY = 64;
+
+/* Track point is passed when the car gets this close to it */
+const float WAYPOINT_DISTANCE = 100.0f;
+
+/* Car goes straight when target is within this angle */
+const float STRAIGHT_ANGLE_DEG = 10.0f;
+
+/* Car stops accelerating when target is behind it */
+const float ACCELERATE_ANGLE_DEG = 90.0f;
+
+/* Random driving keeps each input this long */
+const unsigned RANDOM_INPUT_MIN_MS = 300;
+const unsigned RANDOM_INPUT_MAX_MS = 1500;
+
+/* Part of random inputs with the pedal down */
+const float RANDOM_ACCELERATION = 0.8f;
+
+class LoadBotImpl
+{
+	public:
+
+		/** Sent car state and time it was sent */
+		typedef std::pair<Race::CarStateData, unsigned> TSentState;
+
+
+		BotSwarm &m_swarm;
+
+		const LoadBot::DrivingMode m_mode;
+
+		Player m_player;
+
+		Client m_client;
+
+		CL_SlotContainer m_slots;
+
+		/** Level of joined room, NULL before game state arrives */
+		const Race::Level *m_level;
+
+		bool m_joined;
+
+		bool m_disconnected;
+
+		unsigned m_connectTime;
+
+		/** Encodes car states of this bot */
+		CarStateCodec m_codec;
+
+		Race::CarInputState m_lastInput;
+
+		Race::CarStateData m_lastInputChange;
+
+		unsigned m_lastCarStateTime;
+
+		/** Car states not acknowledged yet, oldest first */
+		std::deque<TSentState> m_pendingAcks;
+
+		/** Newest iteration of each remote car, repeated states are not timed */
+		std::map<CL_String, int32_t> m_relayedIterations;
+
+		/** Track point the car drives to */
+		int m_waypoint;
+
+		unsigned m_nextRandomInputTime;
+
+		unsigned m_seed;
+
+
+		LoadBotImpl(const CL_String &p_name, LoadBot::DrivingMode p_mode, BotSwarm &p_swarm);
+
+		void drive();
+
+		void followTrack(const Race::Track &p_track);
+
+		void driveRandomly();
+
+		int findNearestWaypoint(const Race::Track &p_track) const;
+
+		void updateCarState();
+
+		void sendCarState();
+
+		void sendCarState(const Race::CarStateData &p_state);
+
+		/** @return pseudo random number in [0, 1) */
+		float random();
+
+		void onDisconnected();
+
+		void onGoodbye(GoodbyeReason p_reason, const CL_String &p_message);
+
+		void onGameState(const Net::GameState &p_gameState);
+
+		void onCarStateReceived(const Net::CarState &p_carState);
+
+		void onSnapshotReceived(const Net::Snapshot &p_snapshot);
+
+		void onCarStateRequested(const CL_String &p_name);
+
+		void onCarStateAcknowledged(const Net::CarStateAck &p_ack);
+
+		void onRaceStart(const CL_Pointf &p_position, const CL_Angle &p_angle);
+};
+
+LoadBot::LoadBot(const CL_String &p_name, DrivingMode p_mode, BotSwarm &p_swarm) :
+		m_impl(new LoadBotImpl(p_name, p_mode, p_swarm))
+{
+	// empty
+}
+
+LoadBotImpl::LoadBotImpl(const CL_String &p_name, LoadBot::DrivingMode p_mode, BotSwarm &p_swarm) :
+		m_swarm(p_swarm),
+		m_mode(p_mode),
+		m_player(p_name),
+		m_level(NULL),
+		m_joined(false),
+		m_disconnected(false),
+		m_connectTime(0),
+		m_lastCarStateTime(0),
+		m_waypoint(0),
+		m_nextRandomInputTime(0),
+		m_seed(0x9E3779B9)
+{
+	// bots should not drive in lockstep
+	for (CL_String::const_iterator itor = p_name.begin(); itor != p_name.end(); ++itor) {
+		m_seed = m_seed * 31 + *itor;
+	}
+
+	m_client.setPlayerName(p_name);
+
+	m_slots.connect(m_client.sig_disconnected(), this, &LoadBotImpl::onDisconnected);
+	m_slots.connect(m_client.sig_goodbyeReceived(), this, &LoadBotImpl::onGoodbye);
+	m_slots.connect(m_client.sig_gameStateReceived(), this, &LoadBotImpl::onGameState);
+	m_slots.connect(m_client.sig_carStateReceived(), this, &LoadBotImpl::onCarStateReceived);
+	m_slots.connect(m_client.sig_snapshotReceived(), this, &LoadBotImpl::onSnapshotReceived);
+	m_slots.connect(m_client.sig_carStateRequested(), this, &LoadBotImpl::onCarStateRequested);
+	m_slots.connect(m_client.sig_carStateAcknowledged(), this, &LoadBotImpl::onCarStateAcknowledged);
+	m_slots.connect(m_client.sig_raceStartReceived(), this, &LoadBotImpl::onRaceStart);
+}
+
+LoadBot::~LoadBot()
+{
+	// empty
+}
+
+bool LoadBot::connect(const CL_String &p_addr, int p_port)
+{
+	m_impl->m_client.setServerAddr(p_addr);
+	m_impl->m_client.setServerPort(p_port);
+
+	m_impl->m_connectTime = CL_System::get_time();
+
+	return m_impl->m_client.connect();
+}
+
+void LoadBot::update(unsigned p_timeElapsedMs)
+{
+	if (m_impl->m_joined) {
+		m_impl->drive();
+		m_impl->m_player.getCar().update(p_timeElapsedMs);
+		m_impl->updateCarState();
+	}
+
+	m_impl->m_client.update();
+}
+
+const CL_String &LoadBot::getName() const
+{
+	return m_impl->m_player.getName();
+}
+
+bool LoadBot::isJoined() const
+{
+	return m_impl->m_joined;
+}
+
+bool LoadBot::isDisconnected() const
+{
+	return m_impl->m_disconnected;
+}
+
+void LoadBotImpl::drive()
+{
+	if (m_mode == LoadBot::DM_TRACK && m_level && m_level->getTrack().getPointCount() > 0) {
+		followTrack(m_level->getTrack());
+	} else {
+		driveRandomly();
+	}
+}
+
+void LoadBotImpl::followTrack(const Race::Track &p_track)
+{
+	Race::Car &car = m_player.getCar();
+	const CL_Pointf &position = car.getPosition();
+
+	CL_Pointf target = p_track.getPoint(m_waypoint).getPosition();
+
+	if (position.distance(target) < WAYPOINT_DISTANCE) {
+		m_waypoint = (m_waypoint + 1) % p_track.getPointCount();
+		target = p_track.getPoint(m_waypoint).getPosition();
+	}
+
+	// both angles go clockwise from positive X axis
+	const float targetDeg = atan2f(target.y - position.y, target.x - position.x) * 180.0f / M_PI;
+	float deltaDeg = fmodf(targetDeg - car.getCorpseAngle().to_degrees(), 360.0f);
+
+	if (deltaDeg > 180.0f) {
+		deltaDeg -= 360.0f;
+	} else if (deltaDeg < -180.0f) {
+		deltaDeg += 360.0f;
+	}
+
+	// steer like a keyboard player, so input changes at the same rate
+	if (deltaDeg > STRAIGHT_ANGLE_DEG) {
+		car.setTurn(1.0f);
+	} else if (deltaDeg < -STRAIGHT_ANGLE_DEG) {
+		car.setTurn(-1.0f);
+	} else {
+		car.setTurn(0.0f);
+	}
+
+	car.setAcceleration(fabsf(deltaDeg) < ACCELERATE_ANGLE_DEG);
+	car.setBrake(false);
+}
+
+void LoadBotImpl::driveRandomly()
+{
+	const unsigned now = CL_System::get_time();
+
+	if (static_cast<int>(now - m_nextRandomInputTime) < 0) {
+		return;
+	}
+
+	Race::Car &car = m_player.getCar();
+
+	car.setTurn(static_cast<int>(random() * 3.0f) - 1.0f);
+	car.setAcceleration(random() < RANDOM_ACCELERATION);
+	car.setBrake(false);
+
+	m_nextRandomInputTime = now + RANDOM_INPUT_MIN_MS
+			+ static_cast<unsigned>(random() * (RANDOM_INPUT_MAX_MS - RANDOM_INPUT_MIN_MS));
+}
+
+int LoadBotImpl::findNearestWaypoint(const Race::Track &p_track) const
+{
+	const CL_Pointf &position = m_player.getCar().getPosition();
+	const int count = p_track.getPointCount();
+
+	int nearest = 0;
+	float nearestDistance = 0.0f;
+
+	for (int i = 0; i < count; ++i) {
+		const float distance = position.distance(p_track.getPoint(i).getPosition());
+
+		if (i == 0 || distance < nearestDistance) {
+			nearest = i;
+			nearestDistance = distance;
+		}
+	}
+
+	return nearest;
+}
+
+void LoadBotImpl::updateCarState()
+{
+	Race::Car &car = m_player.getCar();
+
+	const Race::CarInputState &input = car.getInputState();
+	const Race::CarStateData &inputChange = car.getInputChangeState();
+
+	const bool refresh = CL_System::get_time() - m_lastCarStateTime >= CAR_STATE_REFRESH_MS;
+
+	// same rules as the game client
+	if (inputChange != m_lastInputChange) {
+		m_lastInputChange = inputChange;
+		sendCarState(inputChange);
+	} else if (m_lastInput != input || refresh) {
+		sendCarState();
+	}
+
+	m_lastInput = input;
+}
+
+void LoadBotImpl::sendCarState()
+{
+	Race::Car &car = m_player.getCar();
+
+	Race::CarStateData state;
+	car.captureState(&state);
+	car.applyState(state);
+
+	sendCarState(state);
+}
+
+void LoadBotImpl::sendCarState(const Race::CarStateData &p_state)
+{
+	const unsigned now = CL_System::get_time();
+
+	m_pendingAcks.push_back(TSentState(p_state, now));
+
+	if (m_pendingAcks.size() > PENDING_ACK_HISTORY) {
+		m_pendingAcks.pop_front();
+	}
+
+	CL_String8 data;
+
+	if (m_client.isDatagramChannelOpen()) {
+		m_codec.setState(p_state);
+		data = m_codec.encodeFull();
+	} else {
+		data = m_codec.encode(p_state);
+	}
+
+	CL_NetGameEvent serializedData("");
+	serializedData.add_argument(data);
+
+	const int32_t iterId = p_state.get(Race::CarStateData::F_ITERATION);
+
+	CarState carState;
+	carState.setSerializedData(serializedData);
+	carState.setIterationId(iterId);
+	carState.setName(m_player.getName());
+
+	m_client.sendCarState(carState);
+
+	m_lastCarStateTime = now;
+	m_swarm.getStats().carStateSent(m_player.getName(), iterId, data.length(), now);
+}
+
+float LoadBotImpl::random()
+{
+	m_seed = m_seed * 1664525 + 1013904223;
+	return (m_seed >> 8) / static_cast<float>(1 << 24);
+}
+
+void LoadBotImpl::onDisconnected()
+{
+	if (m_joined) {
+		m_swarm.getStats().disconnected();
+	}
+
+	m_joined = false;
+	m_disconnected = true;
+}
+
+void LoadBotImpl::onGoodbye(GoodbyeReason, const CL_String &p_message)
+{
+	cl_log_event(LOG_WARN, "bot '%1' dropped by server: %2", m_player.getName(), p_message);
+}
+
+void LoadBotImpl::onGameState(const Net::GameState &p_gameState)
+{
+	m_level = &m_swarm.getLevel(p_gameState.getLevel());
+
+	const int playerCount = p_gameState.getPlayerCount();
+
+	for (int i = 0; i < playerCount; ++i) {
+		if (p_gameState.getPlayerName(i) != m_player.getName() || !p_gameState.hasCarState(i)) {
+			continue;
+		}
+
+		const CL_NetGameEvent data = p_gameState.getCarState(i).getSerializedData();
+
+		CarStateCodec codec;
+		Race::CarStateData state;
+
+		if (data.get_argument_count() == 1 && codec.decode(data.get_argument(0), &state)) {
+			m_player.getCar().applyState(state);
+		}
+	}
+
+	// server decodes the next state against its own copy, send it in full
+	m_codec.reset();
+	m_pendingAcks.clear();
+
+	m_waypoint = findNearestWaypoint(m_level->getTrack());
+
+	m_joined = true;
+	m_swarm.getStats().joined(CL_System::get_time() - m_connectTime);
+}
+
+void LoadBotImpl::onCarStateReceived(const Net::CarState &p_carState)
+{
+	const CL_String &name = p_carState.getName();
+
+	if (name == m_player.getName()) {
+		return;
+	}
+
+	const int32_t iterId = p_carState.getIterationId();
+	std::map<CL_String, int32_t>::iterator itor = m_relayedIterations.find(name);
+
+	if (itor != m_relayedIterations.end() && iterId <= itor->second) {
+		return;
+	}
+
+	m_relayedIterations[name] = iterId;
+	m_swarm.getStats().carStateRelayed(name, iterId, CL_System::get_time());
+}
+
+void LoadBotImpl::onSnapshotReceived(const Net::Snapshot &p_snapshot)
+{
+	const int count = p_snapshot.getCarStateCount();
+
+	for (int i = 0; i < count; ++i) {
+		onCarStateReceived(p_snapshot.getCarState(i));
+	}
+}
+
+void LoadBotImpl::onCarStateRequested(const CL_String &p_name)
+{
+	if (p_name == m_player.getName()) {
+		m_codec.reset();
+		sendCarState();
+	}
+}
+
+void LoadBotImpl::onCarStateAcknowledged(const Net::CarStateAck &p_ack)
+{
+	CarStateCodec codec;
+	Race::CarStateData state;
+
+	if (!codec.decode(p_ack.getData(), &state)) {
+		return;
+	}
+
+	const int32_t iterId = state.get(Race::CarStateData::F_ITERATION);
+	std::deque<TSentState>::iterator itor = m_pendingAcks.begin();
+
+	while (itor != m_pendingAcks.end() && itor->first.get(Race::CarStateData::F_ITERATION) != iterId) {
+		++itor;
+	}
+
+	if (itor == m_pendingAcks.end()) {
+		return;
+	}
+
+	const bool corrected = itor->first != state;
+	m_swarm.getStats().carStateAcknowledged(CL_System::get_time() - itor->second, corrected);
+
+	m_pendingAcks.erase(m_pendingAcks.begin(), itor + 1);
+
+	if (!corrected) {
+		return;
+	}
+
+	// bots do not keep input history, server state is
+	// simply advanced with the input it carries
+	Race::Car &car = m_player.getCar();
+
+	const int32_t currentIterId = car.getIterationId();
+	const Race::CarInputState input = car.getInputState();
+
+	try {
+		car.applyState(state);
+		car.updateToIteration(currentIterId);
+	} catch (const CL_Exception &e) {
+		cl_log_event(LOG_WARN, "bot '%1' cannot replay its car: %2", m_player.getName(), e.message);
+	}
+
+	car.setAcceleration(input.accel);
+	car.setBrake(input.brake);
+	car.setTurn(input.turn);
+
+	m_lastInputChange = car.getInputChangeState();
+	m_pendingAcks.clear();
+}
+
+void LoadBotImpl::onRaceStart(const CL_Pointf &p_position, const CL_Angle &p_angle)
+{
+	Race::Car &car = m_player.getCar();
+
+	car.setPosition(p_position);
+	car.setAngle(p_angle);
+
+	m_pendingAcks.clear();
+	sendCarState();
+
+	if (m_level) {
+		m_waypoint = findNearestWaypoint(m_level->getTrack());
+	}
+}
+
+}
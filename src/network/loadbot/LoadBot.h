@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/system.h"
+#include "clanlib/core/text.h"
+
+namespace Net {
+
+class BotSwarm;
+class LoadBotImpl;
+
+/**
+ * Headless player for load tests. Connects like the game client,
+ * drives its car with generated input and sends the states the same
+ * way the game does. What it measures goes to the swarm statistics.
+ */
+class LoadBot
+{
+	public:
+
+		enum DrivingMode {
+			/** Follows track center line */
+			DM_TRACK,
+
+			/** Changes input at random moments */
+			DM_RANDOM
+		};
+
+
+		LoadBot(const CL_String &p_name, DrivingMode p_mode, BotSwarm &p_swarm);
+
+		virtual ~LoadBot();
+
+
+		/** @return false when connection could not be started */
+		bool connect(const CL_String &p_addr, int p_port);
+
+		/** Drives the car and exchanges car states with server */
+		void update(unsigned p_timeElapsedMs);
+
+
+		const CL_String &getName() const;
+
+		/** @return true after game state arrived */
+		bool isJoined() const;
+
+		/** @return true when server closed the connection */
+		bool isDisconnected() const;
+
+	private:
+
+		CL_SharedPtr<LoadBotImpl> m_impl;
+};
+
+}
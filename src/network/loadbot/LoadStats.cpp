@@ -26,85 +26,84 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "Smoke.h"
+#include "LoadStats.h"
 
-#include <stdlib.h>
+namespace Net {
 
-#include "clanlib/core/text.h"
+/** Sent states remembered per bot, older ones are not timed when relayed */
+const unsigned SENT_STATE_HISTORY = 64;
 
-#include "common.h"
-
-#include "gfx/Stage.h"
-#include "math/Easing.h"
-
-namespace Gfx {
-
-const int SMOKE_SPRITES_COUNT = 3;
-
-CL_Sprite Smoke::m_smokeSprites[SMOKE_SPRITES_COUNT];
-
-Smoke::Smoke(const CL_Pointf &p_position) :
-		m_position(p_position)
-{
-	m_spriteIdx = rand() % SMOKE_SPRITES_COUNT;
-}
-
-Smoke::~Smoke()
+LoadStats::LoadStats() :
+	m_sentCount(0),
+	m_sentBytes(0),
+	m_relayedCount(0),
+	m_correctedCount(0),
+	m_disconnectedCount(0)
 {
 	// empty
 }
 
-void Smoke::start()
+void LoadStats::carStateSent(const CL_String &p_name, int32_t p_iterId, unsigned p_bytes, unsigned p_time)
 {
-	Animation::start();
+	std::deque<TSentState> &sent = m_sentStates[p_name];
+	sent.push_back(TSentState(p_iterId, p_time));
 
-	m_alpha.animate(0.1f, 0.3f, 250, Math::Easing::NONE, 0);
-	m_alpha.animate(0.3f, 0.0f, 5500, Math::Easing::NONE, 500);
+	if (sent.size() > SENT_STATE_HISTORY) {
+		sent.pop_front();
+	}
 
-	m_size.animate(0.1f, 0.5f, 6000, Math::Easing::REGULAR_OUT);
+	++m_sentCount;
+	m_sentBytes += p_bytes;
 }
 
-void Smoke::update(unsigned p_timeElapsed)
+void LoadStats::carStateAcknowledged(unsigned p_roundTripMs, bool p_corrected)
 {
-	Animation::update(p_timeElapsed);
+	m_roundTrip.add(p_roundTripMs);
 
-	m_alpha.update(p_timeElapsed);
-	m_size.update(p_timeElapsed);
+	if (p_corrected) {
+		++m_correctedCount;
+	}
 }
 
-void Smoke::draw(CL_GraphicContext &p_gc)
+void LoadStats::carStateRelayed(const CL_String &p_name, int32_t p_iterId, unsigned p_time)
 {
-	G_ASSERT(!m_smokeSprites[0].is_null());
+	++m_relayedCount;
 
-	static const unsigned ANIMATION_END = 6000;
+	const TSentStateMap::const_iterator itor = m_sentStates.find(p_name);
 
-	const unsigned now = getTimeFromStart();
-
-	if (now < ANIMATION_END) {
-
-		m_smokeSprites[m_spriteIdx].set_alpha(m_alpha.get());
-		m_smokeSprites[m_spriteIdx].set_scale(m_size.get(), m_size.get());
+	if (itor == m_sentStates.end()) {
+		return;
+	}
 
-		m_smokeSprites[m_spriteIdx].draw(p_gc, m_position.x, m_position.y);
-	} else {
-		setFinished(true);
+	foreach (const TSentState &sent, itor->second) {
+		if (sent.first == p_iterId) {
+			m_relay.add(p_time - sent.second);
+			break;
+		}
 	}
+}
 
+void LoadStats::joined(unsigned p_joinMs)
+{
+	m_join.add(p_joinMs);
 }
 
-void Smoke::load(CL_GraphicContext &p_gc)
+void LoadStats::disconnected()
 {
-	if (m_smokeSprites[0].is_null()) {
-		for (int i = 0; i <= SMOKE_SPRITES_COUNT - 1; ++i) {
-			m_smokeSprites[i] =
-					CL_Sprite(
-							p_gc,
-							cl_format("race/smoke%1", i + 1),
-							Stage::getResourceManager()
-					);
-		}
-	}
+	++m_disconnectedCount;
+}
 
+void LoadStats::clear()
+{
+	m_roundTrip.clear();
+	m_relay.clear();
+	m_join.clear();
+
+	m_sentCount = 0;
+	m_sentBytes = 0;
+	m_relayedCount = 0;
+	m_correctedCount = 0;
+	m_disconnectedCount = 0;
 }
 
 }
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <sys/types.h>
+
+#include "clanlib/core/text.h"
+
+#include "common.h"
+#include "network/loadbot/LatencyStats.h"
+
+namespace Net {
+
+/**
+ * Measurements of all bots of the swarm. Bots run in one process, so
+ * the time a car state was sent by one bot is known when another bot
+ * gets it relayed by the server.
+ */
+class LoadStats
+{
+	public:
+
+		LoadStats();
+
+
+		void carStateSent(const CL_String &p_name, int32_t p_iterId, unsigned p_bytes, unsigned p_time);
+
+		/** Server acknowledged car state sent p_roundTripMs ago */
+		void carStateAcknowledged(unsigned p_roundTripMs, bool p_corrected);
+
+		/** Bot got car state of another bot, unknown states are not timed */
+		void carStateRelayed(const CL_String &p_name, int32_t p_iterId, unsigned p_time);
+
+		/** Bot got game state p_joinMs after it started to connect */
+		void joined(unsigned p_joinMs);
+
+		void disconnected();
+
+		/** Clears measurements of the report interval */
+		void clear();
+
+
+		const LatencyStats &getRoundTrip() const { return m_roundTrip; }
+
+		const LatencyStats &getRelay() const { return m_relay; }
+
+		const LatencyStats &getJoin() const { return m_join; }
+
+		unsigned getSentCount() const { return m_sentCount; }
+
+		unsigned getSentBytes() const { return m_sentBytes; }
+
+		unsigned getRelayedCount() const { return m_relayedCount; }
+
+		unsigned getCorrectedCount() const { return m_correctedCount; }
+
+		unsigned getDisconnectedCount() const { return m_disconnectedCount; }
+
+	private:
+
+		/** Iteration and time of a sent car state */
+		typedef std::pair<int32_t, unsigned> TSentState;
+
+		typedef std::map<CL_String, std::deque<TSentState> > TSentStateMap;
+
+
+		/** Recent states of each bot, survive clear() */
+		TSentStateMap m_sentStates;
+
+		LatencyStats m_roundTrip;
+
+		LatencyStats m_relay;
+
+		LatencyStats m_join;
+
+		unsigned m_sentCount;
+
+		unsigned m_sentBytes;
+
+		unsigned m_relayedCount;
+
+		unsigned m_correctedCount;
+
+		unsigned m_disconnectedCount;
+};
+
+}
@@ -28,6 +28,7 @@
 
 #include "CarState.h"
 
+#include "common/BitStream.h"
 #include "common/gassert.h"
 #include "network/events.h"
 
@@ -84,6 +85,26 @@ void CarState::parseEvent(const CL_NetGameEvent &p_event)
 	}
 }
 
+void CarState::write(BitWriter &p_writer) const
+{
+	G_ASSERT(m_serialData.get_argument_count() == 1);
+
+	p_writer.writeString(m_name);
+	p_writer.writeVarUint(static_cast<unsigned>(m_iterId + 1));
+	p_writer.writeBool(m_afterCollision);
+	p_writer.writeString(m_serialData.get_argument(0));
+}
+
+void CarState::read(BitReader &p_reader)
+{
+	m_name = p_reader.readString();
+	m_iterId = static_cast<int32_t>(p_reader.readVarUint()) - 1;
+	m_afterCollision = p_reader.readBool();
+
+	m_serialData = CL_NetGameEvent("");
+	m_serialData.add_argument(p_reader.readString());
+}
+
 int32_t CarState::getIterationId() const
 {
 	return m_iterId;
@@ -32,6 +32,9 @@
 
 #include "Packet.h"
 
+class BitReader;
+class BitWriter;
+
 namespace Net {
 
 class CarState : public Net::Packet {
@@ -44,6 +47,11 @@ class CarState : public Net::Packet {
 		virtual CL_NetGameEvent buildEvent() const;
 		virtual void parseEvent(const CL_NetGameEvent &p_event);
 
+		/** Writes packed state for snapshots and datagrams */
+		void write(BitWriter &p_writer) const;
+
+		void read(BitReader &p_reader);
+
 		bool isAfterCollision() const;
 		int32_t getIterationId() const;
 		const CL_String &getName() const;
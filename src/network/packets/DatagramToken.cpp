@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "DatagramToken.h"
+
+#include <assert.h>
+
+#include "network/events.h"
+
+namespace Net {
+
+DatagramToken::DatagramToken() :
+	m_token(0),
+	m_port(0),
+	m_challenge(0)
+{
+}
+
+DatagramToken::~DatagramToken()
+{
+}
+
+CL_NetGameEvent DatagramToken::buildEvent() const
+{
+	CL_NetGameEvent event(EVENT_DATAGRAM_TOKEN);
+	event.add_argument(static_cast<int>(m_token));
+	event.add_argument(m_port);
+	event.add_argument(static_cast<int>(m_challenge));
+
+	return event;
+}
+
+void DatagramToken::parseEvent(const CL_NetGameEvent &p_event)
+{
+	assert(p_event.get_name() == EVENT_DATAGRAM_TOKEN);
+	m_token = static_cast<int>(p_event.get_argument(0));
+	m_port = p_event.get_argument(1);
+
+	// servers older than challenges accept any hello
+	m_challenge = p_event.get_argument_count() > 2 ? static_cast<int>(p_event.get_argument(2)) : 0;
+}
+
+}
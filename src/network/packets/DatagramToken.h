@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Packet.h"
+
+namespace Net {
+
+/**
+ * Opens the datagram channel. Client sends its datagrams with the token
+ * to the server port, so server knows who they come from. Hello
+ * datagrams carry the challenge back, so server takes only an address
+ * the player really receives at. Sent again with new challenge when
+ * the player address changes.
+ */
+class DatagramToken : public Net::Packet {
+
+	public:
+
+		DatagramToken();
+
+		virtual ~DatagramToken();
+
+
+		virtual CL_NetGameEvent buildEvent() const;
+
+		virtual void parseEvent(const CL_NetGameEvent &p_event);
+
+
+		unsigned getToken() const { return m_token; }
+
+		int getPort() const { return m_port; }
+
+		unsigned getChallenge() const { return m_challenge; }
+
+
+		void setToken(unsigned p_token) { m_token = p_token; }
+
+		void setPort(int p_port) { m_port = p_port; }
+
+		void setChallenge(unsigned p_challenge) { m_challenge = p_challenge; }
+
+	private:
+
+		unsigned m_token;
+
+		int m_port;
+
+		unsigned m_challenge;
+};
+
+}
+
@@ -28,8 +28,8 @@
 
 #include "GameState.h"
 
-#include <assert.h>
-
+#include "common/BitStream.h"
+#include "common/gassert.h"
 #include "network/events.h"
 
 namespace Net {
@@ -50,10 +50,37 @@ CL_NetGameEvent GameState::buildEvent() const
 
 	event.add_argument(m_level);
 
+	BitWriter writer;
+
+	const int playerCount = m_names.size();
+	writer.writeVarUint(playerCount);
+
+	for (int i = 0; i < playerCount; ++i) {
+		writer.writeString(m_names[i]);
+		writer.writeBool(m_included[i]);
+
+		if (m_included[i]) {
+			m_carStates[i].write(writer);
+		}
+	}
+
+	event.add_argument(writer.getData());
+
+	return event;
+}
+
+CL_NetGameEvent GameState::buildInlineEvent() const
+{
+	CL_NetGameEvent event(EVENT_GAME_STATE);
+
+	event.add_argument(m_level);
+
 	const int playerCount = m_names.size();
 	event.add_argument(playerCount);
 
 	for (int i = 0; i < playerCount; ++i) {
+		G_ASSERT(m_included[i]);
+
 		event.add_argument(m_names[i]);
 
 		// inline car state event arguments
@@ -73,32 +100,39 @@ CL_NetGameEvent GameState::buildEvent() const
 
 void GameState::parseEvent(const CL_NetGameEvent &p_event)
 {
-	assert(p_event.get_name() == EVENT_GAME_STATE);
+	G_ASSERT(p_event.get_name() == EVENT_GAME_STATE);
+
+	m_level = p_event.get_argument(0);
 
-	unsigned arg = 0;
-	m_level = p_event.get_argument(arg++);
+	const CL_String8 packed = p_event.get_argument(1);
+	BitReader reader(packed);
 
-	const int playerCount = p_event.get_argument(arg++);
+	const unsigned playerCount = reader.readVarUint();
 
 	m_names.clear();
 	m_carStates.clear();
+	m_included.clear();
 
-	for (int i = 0; i < playerCount; ++i) {
-		m_names.push_back(p_event.get_argument(arg++));
+	for (unsigned i = 0; i < playerCount && !reader.isOverrun(); ++i) {
+		m_names.push_back(reader.readString());
+		m_included.push_back(reader.readBool());
 
-		// read inline car state event
-		const int argumentCount = p_event.get_argument(arg++);
-		CL_NetGameEvent carStateEvent(EVENT_CAR_STATE);
+		CarState carState;
 
-		for (int j = 0; j < argumentCount; ++j) {
-			carStateEvent.add_argument(p_event.get_argument(arg++));
+		if (m_included.back()) {
+			carState.read(reader);
 		}
 
-		CarState carState;
-		carState.parseEvent(carStateEvent);
-
 		m_carStates.push_back(carState);
 	}
+
+	if (reader.isOverrun()) {
+		m_names.clear();
+		m_carStates.clear();
+		m_included.clear();
+
+		throw CL_Exception("truncated game state");
+	}
 }
 
 const CL_String &GameState::getLevel() const
@@ -116,6 +150,11 @@ const CL_String &GameState::getPlayerName(int p_index) const
 	return m_names[p_index];
 }
 
+bool GameState::hasCarState(int p_index) const
+{
+	return m_included[p_index];
+}
+
 const CarState &GameState::getCarState(int p_index) const
 {
 	return m_carStates[p_index];
@@ -125,6 +164,14 @@ void GameState::addPlayer(const CL_String &p_name, const CarState &p_carState)
 {
 	m_names.push_back(p_name);
 	m_carStates.push_back(p_carState);
+	m_included.push_back(true);
+}
+
+void GameState::addPlayer(const CL_String &p_name)
+{
+	m_names.push_back(p_name);
+	m_carStates.push_back(CarState());
+	m_included.push_back(false);
 }
 
 void GameState::setLevel(const CL_String &p_level)
@@ -33,6 +33,12 @@
 
 namespace Net {
 
+/**
+ * Race joined by the player: level and names of players in it. Only
+ * some car states are included, usually the one of joining player.
+ * Other cars follow in snapshots, so joining a big room does not stall
+ * on one huge event.
+ */
 class GameState : public Packet {
 
 	public:
@@ -40,16 +46,32 @@ class GameState : public Packet {
 		GameState();
 		virtual ~GameState();
 
+		/** Builds compact header with states packed like in snapshots */
 		virtual CL_NetGameEvent buildEvent() const;
 		virtual void parseEvent(const CL_NetGameEvent &p_event);
 
+		/**
+		 * Builds event with all car states inlined as arguments,
+		 * understood by clients older than protocol 6.3.
+		 * Every player must have the car state.
+		 */
+		CL_NetGameEvent buildInlineEvent() const;
+
 		const CL_String &getLevel() const;
 		int getPlayerCount() const;
 		const CL_String &getPlayerName(int p_index) const;
+
+		/** @return false when the car state comes later in a snapshot */
+		bool hasCarState(int p_index) const;
+
 		const CarState &getCarState(int p_index) const;
 
 
 		void addPlayer(const CL_String &p_name, const CarState &p_carState);
+
+		/** Adds player without car state */
+		void addPlayer(const CL_String &p_name);
+
 		void setLevel(const CL_String &p_level);
 
 
@@ -58,6 +80,9 @@ class GameState : public Packet {
 		CL_String m_level;
 		std::vector<CL_String> m_names;
 		std::vector<CarState> m_carStates;
+
+		/** Car state of player is included */
+		std::vector<bool> m_included;
 };
 
 }
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Snapshot.h"
+
+#include "common/BitStream.h"
+#include "common/gassert.h"
+#include "network/events.h"
+
+namespace Net {
+
+Snapshot::Snapshot()
+{
+	// nothing
+}
+
+Snapshot::~Snapshot()
+{
+	// nothing
+}
+
+CL_NetGameEvent Snapshot::buildEvent() const
+{
+	// all states are packed into one argument, so the event
+	// is cheap to copy and encode for every receiver
+	CL_NetGameEvent event(EVENT_SNAPSHOT);
+	event.add_argument(pack());
+
+	return event;
+}
+
+void Snapshot::parseEvent(const CL_NetGameEvent &p_event)
+{
+	G_ASSERT(p_event.get_name() == EVENT_SNAPSHOT);
+
+	const CL_String8 packed = p_event.get_argument(0);
+	unpack(packed);
+}
+
+CL_String8 Snapshot::pack() const
+{
+	BitWriter writer;
+
+	const int carCount = m_carStates.size();
+	writer.writeVarUint(carCount);
+
+	for (int i = 0; i < carCount; ++i) {
+		m_carStates[i].write(writer);
+	}
+
+	return writer.getData();
+}
+
+void Snapshot::unpack(const CL_String8 &p_data)
+{
+	BitReader reader(p_data);
+
+	const unsigned carCount = reader.readVarUint();
+
+	m_carStates.clear();
+
+	for (unsigned i = 0; i < carCount && !reader.isOverrun(); ++i) {
+		CarState carState;
+		carState.read(reader);
+
+		m_carStates.push_back(carState);
+	}
+
+	if (reader.isOverrun()) {
+		m_carStates.clear();
+		throw CL_Exception("truncated snapshot");
+	}
+}
+
+int Snapshot::getCarStateCount() const
+{
+	return static_cast<int>(m_carStates.size());
+}
+
+const CarState &Snapshot::getCarState(int p_index) const
+{
+	return m_carStates[p_index];
+}
+
+void Snapshot::addCarState(const CarState &p_carState)
+{
+	m_carStates.push_back(p_carState);
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Packet.h"
+#include "CarState.h"
+
+namespace Net {
+
+/**
+ * Car states of all players that changed since the previous
+ * server tick.
+ */
+class Snapshot : public Packet {
+
+	public:
+
+		Snapshot();
+		virtual ~Snapshot();
+
+		virtual CL_NetGameEvent buildEvent() const;
+		virtual void parseEvent(const CL_NetGameEvent &p_event);
+
+		/** @return all car states packed into one string */
+		CL_String8 pack() const;
+
+		/** Reads states written by pack(), throws on invalid data */
+		void unpack(const CL_String8 &p_data);
+
+		int getCarStateCount() const;
+		const CarState &getCarState(int p_index) const;
+
+		bool isEmpty() const { return m_carStates.empty(); }
+
+
+		void addCarState(const CarState &p_carState);
+
+
+	private:
+
+		std::vector<CarState> m_carStates;
+};
+
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CarValidation.h"
+
+#include "common.h"
+#include "common/Trace.h"
+#include "logic/race/Car.h"
+#include "math/Float.h"
+
+namespace Net {
+
+/** Allowed difference of client and server positions */
+const float POSITION_PRECISION = 0.5f;
+
+void CarValidationResults::add(const CarValidationResult &p_result)
+{
+	CL_MutexSection lock(&m_mutex);
+	m_results.push_back(p_result);
+}
+
+void CarValidationResults::take(std::vector<CarValidationResult> *p_results)
+{
+	CL_MutexSection lock(&m_mutex);
+
+	p_results->clear();
+	p_results->swap(m_results);
+}
+
+CarValidation::CarValidation(
+		const CL_SharedPtr<Race::Car> &p_car,
+		const Race::CarStateData &p_clientState,
+		int p_iterationId,
+		bool p_afterCollision,
+		bool p_check,
+		const CL_SharedPtr<CarValidationResults> &p_results
+) :
+	m_car(p_car),
+	m_hasBaseState(false),
+	m_clientState(p_clientState),
+	m_iterationId(p_iterationId),
+	m_afterCollision(p_afterCollision),
+	m_check(p_check),
+	m_results(p_results)
+{
+	// empty
+}
+
+void CarValidation::setBaseState(const Race::CarStateData &p_state)
+{
+	m_baseState = p_state;
+	m_hasBaseState = true;
+}
+
+void CarValidation::run()
+{
+	G_TRACE("CarValidation::run");
+
+	CarValidationResult result;
+	result.m_car = m_car;
+
+	if (m_hasBaseState) {
+		m_car->applyState(m_baseState);
+	}
+
+	// validate client physics calculations
+	// and correct player when his state differs from server one
+	if (m_check && m_car->getIterationId() != -1) {
+
+		const cl_ubyte64 startUs = CL_System::get_microseconds();
+		result.m_checked = true;
+
+		Race::CarStateData startState;
+		m_car->captureState(&startState);
+
+		try {
+			Race::CarStateData serverState;
+
+			{
+				G_TRACE("replay");
+				m_car->updateToIteration(m_iterationId);
+			}
+
+			G_TRACE("compare");
+
+			// this is position calculated by server
+			m_car->captureState(&serverState);
+			result.m_serverPosition = m_car->getPosition();
+
+			// apply client data and retrieve his position
+			m_car->applyState(m_clientState);
+			result.m_clientPosition = m_car->getPosition();
+
+			const CL_Pointf &servPos = result.m_serverPosition;
+			const CL_Pointf &cliPos = result.m_clientPosition;
+
+			if (
+					!m_afterCollision
+					&& (
+							!Math::Float::cmp(servPos.x, cliPos.x, POSITION_PRECISION)
+							|| !Math::Float::cmp(servPos.y, cliPos.y, POSITION_PRECISION)
+					)
+			) {
+				// server state stays, only the input is taken from
+				// client, who will replay it with acknowledge
+				serverState.set(
+						Race::CarStateData::F_INPUT,
+						m_clientState.get(Race::CarStateData::F_INPUT)
+				);
+
+				m_car->applyState(serverState);
+				result.m_mismatch = true;
+			}
+
+		} catch (CL_Exception &e) {
+			// something went wrong while comparing states
+			// this also may be a cheater doing
+			result.m_error = e.message;
+
+			m_car->applyState(m_clientState);
+			result.m_clientPosition = m_car->getPosition();
+
+			// client state cannot be reached from server one, so it
+			// stays like on mismatch and only the input is taken
+			startState.set(
+					Race::CarStateData::F_INPUT,
+					m_clientState.get(Race::CarStateData::F_INPUT)
+			);
+
+			m_car->applyState(startState);
+			result.m_serverPosition = m_car->getPosition();
+			result.m_mismatch = true;
+		}
+
+		result.m_replayUs = static_cast<unsigned>(CL_System::get_microseconds() - startUs);
+
+	} else {
+		// this is first iteration or not sampled one,
+		// read data without checking it
+		m_car->applyState(m_clientState);
+	}
+
+	m_car->captureState(&result.m_state);
+	m_results->add(result);
+}
+
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "clanlib/core/math.h"
+#include "clanlib/core/system.h"
+#include "clanlib/core/text.h"
+
+#include "common/WorkerPool.h"
+#include "logic/race/CarStateData.h"
+
+namespace Race {
+class Car;
+}
+
+namespace Net {
+
+/** Outcome of one car state validation */
+struct CarValidationResult {
+
+	/** Validated car, identifies the player */
+	CL_SharedPtr<Race::Car> m_car;
+
+	/** State after validation, server one when client disagrees */
+	Race::CarStateData m_state;
+
+	/** State was replayed, otherwise it was taken as sent */
+	bool m_checked;
+
+	/** Client position differs from the replayed one or replay failed */
+	bool m_mismatch;
+
+	CL_Pointf m_clientPosition, m_serverPosition;
+
+	/** Replay failed with this message, empty on success */
+	CL_String m_error;
+
+	/** Time the replay took */
+	unsigned m_replayUs;
+
+	CarValidationResult() :
+		m_checked(false),
+		m_mismatch(false),
+		m_replayUs(0)
+	{}
+};
+
+/** Finished validations waiting for the room thread, thread safe */
+class CarValidationResults
+{
+	public:
+
+		void add(const CarValidationResult &p_result);
+
+		/** Moves all finished results to p_results */
+		void take(std::vector<CarValidationResult> *p_results);
+
+	private:
+
+		CL_Mutex m_mutex;
+
+		std::vector<CarValidationResult> m_results;
+};
+
+/**
+ * Replays player car up to the state sent by client and checks if
+ * both agree. Runs on worker thread. Validations of the same car must
+ * run one after another, nothing else may use the car meanwhile.
+ */
+class CarValidation : public WorkerJob
+{
+	public:
+
+		CarValidation(
+				const CL_SharedPtr<Race::Car> &p_car,
+				const Race::CarStateData &p_clientState,
+				int p_iterationId,
+				bool p_afterCollision,
+				bool p_check,
+				const CL_SharedPtr<CarValidationResults> &p_results
+		);
+
+		virtual void run();
+
+		/**
+		 * Applies p_state without checking it before this validation.
+		 * Keeps input of a skipped validation, so replay does not
+		 * continue past it with older input.
+		 */
+		void setBaseState(const Race::CarStateData &p_state);
+
+		const Race::CarStateData &getClientState() const { return m_clientState; }
+
+	private:
+
+		CL_SharedPtr<Race::Car> m_car;
+
+		/** State of a skipped validation, see setBaseState() */
+		Race::CarStateData m_baseState;
+
+		bool m_hasBaseState;
+
+		Race::CarStateData m_clientState;
+
+		int m_iterationId;
+
+		/** Collisions are not simulated by server, such states are not checked */
+		bool m_afterCollision;
+
+		/** Replay the car, otherwise only follow client state */
+		bool m_check;
+
+		CL_SharedPtr<CarValidationResults> m_results;
+};
+
+}
@@ -29,7 +29,7 @@
 #include "MasterServerRegistrant.h"
 
 #include "common.h"
-#include "common/Properties.h"
+#include "common/Trace.h"
 #include "network/masterserver/MasterServer.h"
 
 namespace Net
@@ -37,7 +37,8 @@ namespace Net
 
 const int REGISTER_PERDIOD_MS = 50000;
 
-MasterServerRegistrant::MasterServerRegistrant()
+MasterServerRegistrant::MasterServerRegistrant(const std::vector<int> &p_ports) :
+	m_ports(p_ports)
 {
 	// empty
 }
@@ -50,34 +51,41 @@ MasterServerRegistrant::~MasterServerRegistrant()
 void MasterServerRegistrant::run()
 {
 	MasterServer masterServer;
-	bool registered = false;
-	const int serverPort = Properties::getInt(SRV_PORT, DEFAULT_PORT);
+	std::vector<bool> registered(m_ports.size(), false);
+
+	Trace::setThreadName("master server registrant");
 
 	do {
-		try {
-			if (!registered) {
-				cl_log_event(LOG_DEBUG, "registering game server");
-				const bool registerSucceed = masterServer.registerGameServer(serverPort);
+		G_TRACE("MasterServerRegistrant::run");
 
-				if (registerSucceed) {
-					cl_log_event(LOG_INFO, "game server registered to MS");
-					registered = true;
-				} else {
-					cl_log_event(LOG_WARN, "game server registration failed");
-				}
-			} else {
-				cl_log_event(LOG_DEBUG, "keeping alive game server");
-				const bool keepAliveSucceed = masterServer.keepAliveGameServer(serverPort);
+		for (unsigned i = 0; i < m_ports.size(); ++i) {
+			const int serverPort = m_ports[i];
 
-				if (keepAliveSucceed) {
-					cl_log_event(LOG_INFO, "game server kept alive (MS)");
+			try {
+				if (!registered[i]) {
+					cl_log_event(LOG_DEBUG, "registering game server on port %1", serverPort);
+					const bool registerSucceed = masterServer.registerGameServer(serverPort);
+
+					if (registerSucceed) {
+						cl_log_event(LOG_INFO, "game server on port %1 registered to MS", serverPort);
+						registered[i] = true;
+					} else {
+						cl_log_event(LOG_WARN, "game server registration failed on port %1", serverPort);
+					}
 				} else {
-					cl_log_event(LOG_INFO, "game server keep alive failed (MS)");
-					registered = false;
+					cl_log_event(LOG_DEBUG, "keeping alive game server on port %1", serverPort);
+					const bool keepAliveSucceed = masterServer.keepAliveGameServer(serverPort);
+
+					if (keepAliveSucceed) {
+						cl_log_event(LOG_INFO, "game server on port %1 kept alive (MS)", serverPort);
+					} else {
+						cl_log_event(LOG_INFO, "game server keep alive failed on port %1 (MS)", serverPort);
+						registered[i] = false;
+					}
 				}
+			} catch (CL_Exception &e) {
+				cl_log_event(LOG_WARN, "fatal while registering/keeping alive: " + e.message);
 			}
-		} catch (CL_Exception &e) {
-			cl_log_event(LOG_WARN, "fatal while registering/keeping alive: " + e.message);
 		}
 	} while (CL_Event::wait(m_eventInterrupted, REGISTER_PERDIOD_MS) != 0);
 }
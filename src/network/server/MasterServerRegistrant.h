@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "clanlib/core/system.h"
 
 namespace Net
@@ -37,7 +39,8 @@ class MasterServerRegistrant : public CL_Runnable
 {
 	public:
 
-		MasterServerRegistrant();
+		/** Keeps game servers on p_ports registered, one per room */
+		explicit MasterServerRegistrant(const std::vector<int> &p_ports);
 
 		virtual ~MasterServerRegistrant();
 
@@ -50,6 +53,8 @@ class MasterServerRegistrant : public CL_Runnable
 
 	private:
 
+		std::vector<int> m_ports;
+
 		CL_Event m_eventInterrupted;
 };
 
@@ -31,7 +31,8 @@
 #include <string>
 
 #include "common/loglevels.h"
-#include "network/events.h"
+#include "common/Trace.h"
+#include "network/PacketRegistry.h"
 #include "network/packets/RankingAdvance.h"
 #include "network/packets/RankingEntries.h"
 #include "network/packets/RankingFind.h"
@@ -47,7 +48,7 @@ class RankingServiceImpl
 
 		LocalRanking m_localRanking;
 
-		void parseEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
+		void parseEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event);
 		void parseRankingFindEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
 		void parseRankingAdvanceEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
 		void parseRankingRequestEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
@@ -69,27 +70,38 @@ RankingService::~RankingService()
 	// empty
 }
 
-void RankingService::parseEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
+void RankingService::parseEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event)
 {
-	m_impl->parseEvent(p_conn, p_event);
+	m_impl->parseEvent(p_conn, p_opcode, p_event);
 }
 
-void RankingServiceImpl::parseEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
+void RankingServiceImpl::parseEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event)
 {
-	const CL_String eventName = p_event.get_name();
-
-	if (eventName == EVENT_RANKING_FIND) {
-		parseRankingFindEvent(p_conn, p_event);
-	} else if (eventName == EVENT_RANKING_ADVANCE) {
-		parseRankingAdvanceEvent(p_conn, p_event);
-	} else if (eventName == EVENT_RANKING_REQUEST) {
-		parseRankingRequestEvent(p_conn, p_event);
+	G_TRACE("RankingService::parseEvent");
+
+	switch (p_opcode) {
+		case OP_RANKING_FIND:
+			parseRankingFindEvent(p_conn, p_event);
+			break;
+
+		case OP_RANKING_ADVANCE:
+			parseRankingAdvanceEvent(p_conn, p_event);
+			break;
+
+		case OP_RANKING_REQUEST:
+			parseRankingRequestEvent(p_conn, p_event);
+			break;
+
+		default:
+			break;
 	}
 }
 
 void RankingServiceImpl::parseRankingFindEvent(
 		CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event
 ) {
+	G_TRACE("ranking find");
+
 	RankingFind rankingFindPacket;
 	rankingFindPacket.parseEvent(p_event);
 
@@ -118,6 +130,8 @@ void RankingServiceImpl::parseRankingAdvanceEvent(
 		CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event
 )
 {
+	G_TRACE("ranking advance");
+
 	RankingAdvance rankingAdvancePacket;
 	rankingAdvancePacket.parseEvent(p_event);
 
@@ -131,6 +145,8 @@ void RankingServiceImpl::parseRankingRequestEvent(
 {
 	static const int ENTRY_COUNT_LIMIT = 20;
 
+	G_TRACE("ranking request");
+
 	RankingRequest rankingRequestPacket;
 	rankingRequestPacket.parseEvent(p_event);
 
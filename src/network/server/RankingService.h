@@ -42,7 +42,8 @@ class RankingService
 		RankingService();
 		virtual ~RankingService();
 
-		void parseEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_rankingEvent);
+		/** Handles ranking event with opcode p_opcode */
+		void parseEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_rankingEvent);
 
 
 	private:
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "RoomManager.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "clanlib/core/io.h"
+
+#include "common.h"
+#include "common/Properties.h"
+#include "common/Trace.h"
+#include "common/WorkerPool.h"
+#include "logic/race/level/Level.h"
+#include "network/server/MasterServerRegistrant.h"
+#include "network/server/Server.h"
+#include "network/server/ServerConfiguration.h"
+#include "network/server/TimeTrailServer.h"
+
+namespace Net {
+
+/** Room updates per second when not set in properties */
+const int DEFAULT_TICK_RATE = 60;
+
+/** Runs its rooms on own thread at fixed rate */
+class RoomWorker : public CL_Runnable
+{
+	public:
+
+		RoomWorker(int p_index, WorkerPool &p_validationPool);
+
+		void addRoom(const ServerConfiguration &p_config, const Race::Level *p_level);
+
+		void start();
+
+		/** Stops rooms of this worker and waits for them */
+		void stop();
+
+		virtual void run();
+
+	private:
+
+		int m_index;
+
+		WorkerPool &m_validationPool;
+
+		std::vector<ServerConfiguration> m_configs;
+
+		std::vector<const Race::Level*> m_levels;
+
+		CL_Thread m_thread;
+
+		CL_Event m_eventInterrupted;
+
+
+		/** Updates p_servers at fixed rate until interrupted */
+		void runRooms(const std::vector<CL_SharedPtr<Server> > &p_servers);
+};
+
+class RoomManagerImpl
+{
+	public:
+
+		typedef std::map<CL_String, CL_SharedPtr<Race::Level> > TLevelMap;
+
+
+		std::vector<ServerConfiguration> m_configs;
+
+		/** Levels by path, loaded once for all rooms */
+		TLevelMap m_levels;
+
+		std::vector<CL_SharedPtr<RoomWorker> > m_workers;
+
+		/** Validates car states of all rooms */
+		CL_SharedPtr<WorkerPool> m_validationPool;
+
+		CL_SharedPtr<MasterServerRegistrant> m_serverRegistrant;
+
+		CL_Thread m_masterServerThread;
+
+
+		const Race::Level &loadLevel(const CL_String &p_path);
+};
+
+Server *createServer(const ServerConfiguration &p_config, const Race::Level &p_level, WorkerPool &p_validationPool)
+{
+	const CL_String &gameMode = p_config.getGameMode();
+
+	if (gameMode == SRV_GAME_MODE_ARCADE) {
+		cl_log_event(LOG_INFO, "starting ARCADE room on port %1", p_config.getPort());
+		return new Server(p_config, p_level, p_validationPool);
+	} else if (gameMode == SRV_GAME_MODE_TIMETRAIL) {
+		cl_log_event(LOG_INFO, "starting TIME TRAIL room on port %1", p_config.getPort());
+		return new TimeTrailServer(p_config, p_level, p_validationPool);
+	} else {
+		throw CL_Exception("unknown game mode: " + gameMode);
+	}
+}
+
+RoomWorker::RoomWorker(int p_index, WorkerPool &p_validationPool) :
+		m_index(p_index),
+		m_validationPool(p_validationPool)
+{
+	// empty
+}
+
+void RoomWorker::addRoom(const ServerConfiguration &p_config, const Race::Level *p_level)
+{
+	m_configs.push_back(p_config);
+	m_levels.push_back(p_level);
+}
+
+void RoomWorker::start()
+{
+	m_thread.start(this);
+}
+
+void RoomWorker::stop()
+{
+	m_eventInterrupted.set();
+	m_thread.join();
+}
+
+void RoomWorker::run()
+{
+	const CL_String8 threadName = cl_format("rooms %1", m_index);
+	Trace::setThreadName(threadName.c_str());
+
+	try {
+		// created here, so network events of rooms are processed by this thread
+		std::vector<CL_SharedPtr<Server> > servers;
+
+		for (unsigned i = 0; i < m_configs.size(); ++i) {
+			servers.push_back(CL_SharedPtr<Server>(createServer(m_configs[i], *m_levels[i], m_validationPool)));
+			servers.back()->start();
+		}
+
+		runRooms(servers);
+
+	} catch (const CL_Exception &e) {
+		cl_log_event(LOG_ERROR, "room worker %1 failed: %2", m_index, e.message);
+	}
+}
+
+void RoomWorker::runRooms(const std::vector<CL_SharedPtr<Server> > &p_servers)
+{
+	const int tickRate = Properties::getInt(SRV_TICK_RATE, DEFAULT_TICK_RATE);
+	const unsigned tickMs = 1000 / std::max(1, std::min(tickRate, 1000));
+
+	unsigned nextTick = CL_System::get_time();
+
+	while (CL_Event::wait(m_eventInterrupted, 0) == -1) {
+		const unsigned now = CL_System::get_time();
+
+		if (static_cast<int>(now - nextTick) >= 0) {
+			G_TRACE("RoomWorker::tick");
+
+			foreach (const CL_SharedPtr<Server> &server, p_servers) {
+				server->update();
+			}
+
+			nextTick += tickMs;
+
+			// do not try to catch up ticks missed by a long stall
+			if (static_cast<int>(now - nextTick) >= 0) {
+				nextTick = now + tickMs;
+			}
+		}
+
+		// sleep until network events or datagrams arrive or next tick
+		// is due, negative timeout would wait forever
+		const int waitMs = static_cast<int>(nextTick - CL_System::get_time());
+		CL_KeepAlive::process(std::max(0, waitMs));
+	}
+}
+
+RoomManager::RoomManager() :
+		m_impl(new RoomManagerImpl())
+{
+	// empty
+}
+
+RoomManager::~RoomManager()
+{
+	if (!m_impl->m_workers.empty()) {
+		stop();
+	}
+}
+
+void RoomManager::start()
+{
+	G_ASSERT(m_impl->m_workers.empty());
+
+	const int roomCount = std::max(1, Properties::getInt(SRV_ROOMS, 1));
+	std::vector<int> ports;
+
+	m_impl->m_configs.clear();
+
+	for (int i = 0; i < roomCount; ++i) {
+		const ServerConfiguration config = ServerConfiguration::fromProperties(i);
+
+		if (config.getLevel().empty()) {
+			throw CL_Exception(cl_format("level of room %1 is not set", i));
+		}
+
+		if (config.getGameMode() != SRV_GAME_MODE_ARCADE
+				&& config.getGameMode() != SRV_GAME_MODE_TIMETRAIL) {
+			throw CL_Exception("unknown game mode: " + config.getGameMode());
+		}
+
+		if (std::find(ports.begin(), ports.end(), config.getPort()) != ports.end()) {
+			throw CL_Exception(cl_format("port %1 is used by two rooms", config.getPort()));
+		}
+
+		// loaded before any room starts, read only after that
+		m_impl->loadLevel(config.getLevelPath());
+
+		m_impl->m_configs.push_back(config);
+		ports.push_back(config.getPort());
+	}
+
+	const int cores = CL_System::get_num_cores();
+	const int workerCount = std::min(roomCount, std::max(1, Properties::getInt(SRV_WORKERS, cores)));
+
+	const int validationThreads = std::max(1, Properties::getInt(SRV_VALIDATION_THREADS, cores));
+	m_impl->m_validationPool = CL_SharedPtr<WorkerPool>(new WorkerPool(validationThreads));
+
+	for (int i = 0; i < workerCount; ++i) {
+		m_impl->m_workers.push_back(
+				CL_SharedPtr<RoomWorker>(new RoomWorker(i, *m_impl->m_validationPool))
+		);
+	}
+
+	for (int i = 0; i < roomCount; ++i) {
+		const ServerConfiguration &config = m_impl->m_configs[i];
+		const Race::Level &level = *m_impl->m_levels[config.getLevelPath()];
+
+		m_impl->m_workers[i % workerCount]->addRoom(config, &level);
+	}
+
+	cl_log_event(
+			LOG_INFO,
+			"hosting %1 rooms on %2 threads, %3 levels loaded",
+			roomCount, workerCount, static_cast<int>(m_impl->m_levels.size())
+	);
+
+	foreach (const CL_SharedPtr<RoomWorker> &worker, m_impl->m_workers) {
+		worker->start();
+	}
+
+	cl_log_event(LOG_DEBUG, "launching game server register thread");
+
+	m_impl->m_serverRegistrant = CL_SharedPtr<MasterServerRegistrant>(new MasterServerRegistrant(ports));
+	m_impl->m_masterServerThread.start(m_impl->m_serverRegistrant.get());
+}
+
+void RoomManager::stop()
+{
+	G_ASSERT(!m_impl->m_workers.empty());
+
+	cl_log_event(LOG_DEBUG, "stopping game server register thread");
+	m_impl->m_serverRegistrant->interrupt();
+	m_impl->m_masterServerThread.join();
+
+	foreach (const CL_SharedPtr<RoomWorker> &worker, m_impl->m_workers) {
+		worker->stop();
+	}
+
+	m_impl->m_workers.clear();
+
+	// rooms are gone, jobs still running only touch their own data
+	m_impl->m_validationPool = CL_SharedPtr<WorkerPool>();
+}
+
+int RoomManager::getRoomCount() const
+{
+	return static_cast<int>(m_impl->m_configs.size());
+}
+
+const Race::Level &RoomManagerImpl::loadLevel(const CL_String &p_path)
+{
+	TLevelMap::const_iterator itor = m_levels.find(p_path);
+
+	if (itor != m_levels.end()) {
+		return *itor->second;
+	}
+
+	if (!CL_FileHelp::file_exists(p_path)) {
+		throw CL_Exception(cl_format("level %1 doesn't exists", p_path));
+	}
+
+	CL_SharedPtr<Race::Level> level(new Race::Level());
+	level->load(p_path);
+
+	if (!level->isUsable()) {
+		throw CL_Exception(cl_format("level %1 is not usable", p_path));
+	}
+
+	m_levels[p_path] = level;
+	return *level;
+}
+
+}
@@ -28,36 +28,104 @@
 
 #include "Server.h"
 
+#include <algorithm>
+#include <deque>
+
 #include "clanlib/core/io.h"
+#include "clanlib/network/socket.h"
 
 #include "common.h"
+#include "common/BitStream.h"
 #include "common/Player.h"
 #include "common/Properties.h"
+#include "common/Trace.h"
+#include "common/WorkerPool.h"
 #include "logic/VoteSystem.h"
 #include "logic/race/Car.h"
+#include "logic/race/CarStateData.h"
+#include "logic/race/Progress.h"
 #include "logic/race/level/Level.h"
-#include "math/Float.h"
 #include "network/events.h"
 #include "network/version.h"
+#include "network/CarStateCodec.h"
+#include "network/DatagramChannel.h"
+#include "network/PacketRegistry.h"
+#include "network/UdpSocket.h"
 #include "network/packets/CarState.h"
+#include "network/packets/CarStateAck.h"
+#include "network/packets/CarStateRequest.h"
 #include "network/packets/ClientInfo.h"
+#include "network/packets/DatagramOpen.h"
+#include "network/packets/DatagramToken.h"
 #include "network/packets/Goodbye.h"
 #include "network/packets/GameMode.h"
 #include "network/packets/GameState.h"
+#include "network/packets/OpcodeTable.h"
 #include "network/packets/PlayerJoined.h"
 #include "network/packets/PlayerLeft.h"
 #include "network/packets/RaceStart.h"
+#include "network/packets/Snapshot.h"
 #include "network/packets/ServerInfoRequest.h"
 #include "network/packets/ServerInfoResponse.h"
 #include "network/packets/VoteStart.h"
 #include "network/packets/VoteEnd.h"
 #include "network/packets/VoteTick.h"
-#include "network/server/MasterServerRegistrant.h"
+#include "network/server/CarValidation.h"
+#include "network/server/ServerConfiguration.h"
+#include "network/server/SnapshotInterest.h"
+#include "network/server/ValidationScheduler.h"
 
 namespace Net {
 
 const int VOTE_TIME_LIMIT_SEC = 30;
 
+const int DEFAULT_SNAPSHOT_RATE = 20;
+
+/* Datagram address of a player is challenged again at most this often */
+const unsigned DATAGRAM_CHALLENGE_INTERVAL_MS = 1000;
+
+/* Clients understand events sent by opcode since this minor version */
+const int OPCODE_PROTOCOL_MINOR = 2;
+
+/* Clients take game state without other cars since this minor version */
+const int CHUNKED_JOIN_PROTOCOL_MINOR = 3;
+
+/* Cars unknown to a receiver sent in one snapshot, rest waits for next ones */
+const int MAX_NEW_CARS_PER_SNAPSHOT = 8;
+
+/* Car states of one player waiting for validation, older ones are dropped */
+const unsigned MAX_PENDING_VALIDATIONS = 8;
+
+/* Replay time of car states allowed per tick */
+const int DEFAULT_VALIDATION_BUDGET_US = 2000;
+
+/* States always checked after a failed check of the player */
+const unsigned SUSPICIOUS_STATES = 100;
+
+/* Validation counters are logged this often */
+const unsigned VALIDATION_STATS_INTERVAL_MS = 60000;
+
+class ServerImpl;
+
+/**
+ * Wakes the room thread waiting in CL_KeepAlive::process when a
+ * datagram arrives, so it is received without waiting for next tick.
+ */
+class DatagramWakeup : public CL_KeepAliveObject
+{
+	public:
+
+		explicit DatagramWakeup(ServerImpl &p_impl) : m_impl(p_impl) {}
+
+		virtual CL_Event get_wakeup_event();
+
+		virtual void process();
+
+	private:
+
+		ServerImpl &m_impl;
+};
+
 class ServerImpl
 {
 	public:
@@ -67,6 +135,10 @@ class ServerImpl
 		SIG_IMPL(Server, playerLeft);
 
 
+		/** Car state known to one receiver */
+		typedef std::map<CL_NetGameConnection*, SnapshotInterest> TConnectionInterestMap;
+
+
 		struct Player {
 
 			CL_String m_name;
@@ -78,10 +150,87 @@ class ServerImpl
 
 			CarState m_lastCarState;
 
+			/** Decodes car states sent by this player */
+			CarStateCodec m_carStateCodec;
+
+			/** Encodes this player car states for snapshots */
+			CarStateCodec m_snapshotCodec;
+
+			/**
+			 * Newest car state, the one other players get. Replaced by
+			 * server state when validation disagrees.
+			 */
+			Race::CarStateData m_validState;
+
+			/** Replayed only by validation jobs, one at a time */
+			CL_SharedPtr<Race::Car> m_validationCar;
+
+			/** Validation job of this player is on the worker pool */
+			bool m_validating;
+
+			/** Car states waiting for the running validation */
+			std::deque<CL_SharedPtr<CarValidation> > m_pendingValidations;
+
+			/** Following states of this player are checked, not sampled */
+			unsigned m_suspiciousStates;
+
+			/** Full car state was requested and didn't arrive yet */
+			bool m_carStateRequested;
+
+			/** Car state changed since the last snapshot */
+			bool m_carStateDirty;
+
+			/** Number of states encoded by m_snapshotCodec */
+			unsigned m_snapshotVersion;
+
+			/** Delta encoded on current snapshot, empty when car didn't change */
+			CL_String8 m_snapshotDelta;
+
+			/** Full state of current snapshot, built when some receiver needs it */
+			CL_String8 m_snapshotFull;
+
+			/** Car states of other players known to this one */
+			TConnectionInterestMap m_interests;
+
+			/** Player understands events sent by opcode */
+			bool m_opcodes;
+
+			/** Player gets other cars through snapshots after joining */
+			bool m_chunkedJoin;
+
+			/** Identifies datagrams of this player, 0 when not assigned */
+			unsigned m_datagramToken;
+
+			/** Player must send it back in hello from his datagram address */
+			unsigned m_datagramChallenge;
+
+			unsigned m_datagramChallengeTime;
+
+			/** Player answered the challenge from m_datagramAddress */
+			bool m_datagramAddressKnown;
+
+			CL_SocketName m_datagramAddress;
+
+			/** Player receives datagrams, so they replace the reliable connection */
+			bool m_datagramOpen;
+
 			Player() :
 				m_gameStateSent(false),
+				m_carStateRequested(false),
+				m_carStateDirty(false),
+				m_validating(false),
+				m_suspiciousStates(0),
+				m_snapshotVersion(0),
+				m_opcodes(false),
+				m_chunkedJoin(false),
+				m_datagramToken(0),
+				m_datagramChallenge(0),
+				m_datagramChallengeTime(0),
+				m_datagramAddressKnown(false),
+				m_datagramOpen(false),
 				m_player(new ::Player("")),
-				m_car(new Race::Car(m_player.get()))
+				m_car(new Race::Car(m_player.get())),
+				m_validationCar(new Race::Car(m_player.get()))
 			{}
 		};
 
@@ -89,6 +238,10 @@ class ServerImpl
 		typedef std::map<CL_NetGameConnection*, Player> TConnectionPlayerMap;
 		typedef std::pair<CL_NetGameConnection*, Player> TConnectionPlayerPair;
 
+		typedef std::map<unsigned, CL_NetGameConnection*> TTokenConnectionMap;
+
+		typedef void (ServerImpl::*TEventHandler)(CL_NetGameConnection*, const CL_NetGameEvent&);
+
 
 		Server *m_parent;
 
@@ -100,28 +253,63 @@ class ServerImpl
 
 		TConnectionPlayerMap m_connections;
 
+		/** Opcodes of this server, clients use them too */
+		PacketRegistry m_registry;
 
-		Race::Level m_level;
+		/** Handlers by opcode, NULL for events not handled here */
+		TEventHandler m_handlers[OPCODE_COUNT];
 
-		VoteSystem m_voteSystem;
 
+		/** Car states and snapshots, NULL when it cannot be opened */
+		CL_SharedPtr<DatagramChannel> m_datagramChannel;
 
-		CL_Thread m_masterServerThread;
+		/** Set while the channel is open, must be created on the room thread */
+		CL_SharedPtr<DatagramWakeup> m_datagramWakeup;
 
-		MasterServerRegistrant m_serverRegistrant;
+		TTokenConnectionMap m_datagramTokens;
 
+		unsigned m_tokenSeed;
 
-		CL_SlotContainer m_slots;
 
+		/** Time between snapshots in milliseconds */
+		unsigned m_snapshotInterval;
 
-		ServerImpl(Server *p_parent);
+		unsigned m_lastSnapshotTime;
 
-		~ServerImpl();
+
+		const ServerConfiguration m_config;
+
+		/** Shared with other rooms, read only */
+		const Race::Level &m_level;
+
+		/** Track positions of cars for interest management */
+		Race::Progress m_progress;
+
+		VoteSystem m_voteSystem;
 
 
-		void startServerRegistrant();
+		/** Replays car states, shared with other rooms */
+		WorkerPool &m_validationPool;
 
-		void stopServerRegistrant();
+		CL_SharedPtr<CarValidationResults> m_validationResults;
+
+		/** Keeps replay time within budget */
+		ValidationScheduler m_validationScheduler;
+
+		unsigned m_lastValidationStatsTime;
+
+
+		CL_SlotContainer m_slots;
+
+
+		ServerImpl(
+				Server *p_parent,
+				const ServerConfiguration &p_config,
+				const Race::Level &p_level,
+				WorkerPool &p_validationPool
+		);
+
+		~ServerImpl();
 
 
 		// helpers
@@ -132,14 +320,67 @@ class ServerImpl
 
 		GameState prepareGameState();
 
+		/** Game state with car state of the receiver only */
+		GameState prepareGameStateHeader(CL_NetGameConnection *p_receiver);
+
+		/** @return last state of player car encoded in full */
+		CarState prepareFullCarState(const Player &p_player);
+
 		void startRace();
 
+		void sendSnapshot();
+
+		/** Splits snapshot into datagrams of safe size */
+		void sendDatagramSnapshot(const Player &p_receiver, const Snapshot &p_snapshot);
+
+		void sendDatagram(const Player &p_receiver, unsigned p_type, const CL_String8 &p_payload);
+
+		static CL_String8 buildDatagram(unsigned p_type, const CL_String8 &p_payload);
+
+		/** Tells the player how his car looks like after validation */
+		void sendCarStateAck(CL_NetGameConnection *p_conn, const Player &p_player, const Race::CarStateData &p_state);
+
+		/** Validates p_state now or after validations already queued */
+		void queueValidation(Player &p_player, const Race::CarStateData &p_state);
+
+		/** Applies finished validations and starts next ones */
+		void applyValidationResults();
+
+		/** Corrects player car, unless newer states of it wait for validation */
+		void applyCorrection(Player &p_player, const Race::CarStateData &p_state);
+
+		void receiveDatagrams();
+
+		/** Gives player a token and opens the datagram channel for him */
+		void openDatagramChannel(CL_NetGameConnection *p_conn);
+
+		/** Asks player to confirm his datagram address, which changed */
+		void challengeDatagramAddress(CL_NetGameConnection *p_conn);
+
+		/** @return random number other than 0 */
+		unsigned generateToken();
+
+		/** Adds p_car state to snapshot of p_receiver when it is due */
+		void addToSnapshot(
+				Player &p_receiver,
+				CL_NetGameConnection *p_carConn,
+				Player &p_car,
+				unsigned p_now,
+				Snapshot *p_snapshot
+		);
+
+		/** @return minimal time between states of p_car sent to p_receiver */
+		unsigned getSnapshotInterval(const Player &p_receiver, const Player &p_car) const;
+
+		/** Marks all current car states as known to p_receiver */
+		void markCarStatesSent(Player &p_receiver);
+
 		void kick(CL_NetGameConnection *p_conn, GoodbyeReason p_reason);
 
 
 		// network events
 
-		void handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
+		void handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event);
 
 		void onClientConnected(CL_NetGameConnection *p_connection);
 
@@ -157,6 +398,13 @@ class ServerImpl
 
 		void onCarState(CL_NetGameConnection *p_connection, const CL_NetGameEvent &p_event);
 
+		/** Handles car state received through any channel */
+		void handleCarState(CL_NetGameConnection *p_connection, const CarState &p_carState);
+
+		void onCarStateRequest(CL_NetGameConnection *p_connection, const CL_NetGameEvent &p_event);
+
+		void onDatagramOpen(CL_NetGameConnection *p_connection, const CL_NetGameEvent &p_event);
+
 		void onVoteStart(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
 
 		void onVoteTick(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
@@ -173,8 +421,8 @@ class ServerImpl
 SIG_CPP(Server, playerJoined);
 SIG_CPP(Server, playerLeft);
 
-Server::Server() :
-	m_impl(new ServerImpl(this))
+Server::Server(const ServerConfiguration &p_config, const Race::Level &p_level, WorkerPool &p_validationPool) :
+	m_impl(new ServerImpl(this, p_config, p_level, p_validationPool))
 {
 	// empty
 }
@@ -186,29 +434,51 @@ Server::~Server()
 	}
 }
 
-ServerImpl::ServerImpl(Server *p_parent) :
+ServerImpl::ServerImpl(
+		Server *p_parent,
+		const ServerConfiguration &p_config,
+		const Race::Level &p_level,
+		WorkerPool &p_validationPool
+) :
 		m_parent(p_parent),
 		m_serverName("unnamed"),
-		m_running(false)
+		m_running(false),
+		m_snapshotInterval(1000 / DEFAULT_SNAPSHOT_RATE),
+		m_lastSnapshotTime(0),
+		m_tokenSeed(static_cast<unsigned>(CL_System::get_microseconds())),
+		m_config(p_config),
+		m_level(p_level),
+		m_progress(&m_level),
+		m_validationPool(p_validationPool),
+		m_validationResults(new CarValidationResults()),
+		m_validationScheduler(Properties::getInt(SRV_VALIDATION_BUDGET, DEFAULT_VALIDATION_BUDGET_US)),
+		m_lastValidationStatsTime(0)
 {
-	const CL_String levPath =
-			cl_format(
-					"%1/%2",
-					LEVELS_DIR,
-					Properties::getString(SRV_LEVEL)
-			);
+	// clients adopt opcodes of the server
+	m_registry.setPeerNames(PacketRegistry::getNames());
 
-	if (!CL_FileHelp::file_exists(levPath)) {
-		cl_log_event(LOG_ERROR, "level %1 doesn't exists, exiting", levPath);
-		exit(1);
+	for (int i = 0; i < OPCODE_COUNT; ++i) {
+		m_handlers[i] = NULL;
 	}
 
-	m_level.load(levPath);
-	if (!m_level.isUsable()) {
-		cl_log_event(LOG_ERROR, "level %1 is not usable, exiting", levPath);
-		exit(1);
+	m_handlers[OP_CLIENT_INFO] = &ServerImpl::onClientInfo;
+	m_handlers[OP_INFO_REQUEST] = &ServerImpl::onServerInfoRequest;
+	m_handlers[OP_CAR_STATE] = &ServerImpl::onCarState;
+	m_handlers[OP_CAR_STATE_REQUEST] = &ServerImpl::onCarStateRequest;
+	m_handlers[OP_DATAGRAM_OPEN] = &ServerImpl::onDatagramOpen;
+	m_handlers[OP_VOTE_START] = &ServerImpl::onVoteStart;
+	m_handlers[OP_VOTE_TICK] = &ServerImpl::onVoteTick;
+
+	const int snapshotRate = Properties::getInt(SRV_SNAPSHOT_RATE, DEFAULT_SNAPSHOT_RATE);
+
+	if (snapshotRate > 0) {
+		m_snapshotInterval = 1000 / snapshotRate;
+	} else {
+		cl_log_event(LOG_WARN, "invalid snapshot rate: %1", snapshotRate);
 	}
 
+	m_progress.initialize();
+
 	m_slots.connect(
 			m_gameServer.sig_client_connected(),
 			this, &ServerImpl::onClientConnected
@@ -236,49 +506,61 @@ void Server::start()
 {
 	G_ASSERT(!m_impl->m_running);
 
-	const int port = Properties::getInt(SRV_PORT, DEFAULT_PORT);
+	const int port = m_impl->m_config.getPort();
 
 	try {
 		m_impl->m_gameServer.start(CL_StringHelp::int_to_local8(port));
 
-		m_impl->m_running = true;
-		cl_log_event(LOG_INFO, "server is up and running");
+		try {
+			m_impl->m_datagramChannel = CL_SharedPtr<DatagramChannel>(
+					new DatagramChannel(UdpSocket::open(CL_StringHelp::int_to_local8(port)))
+			);
+
+			m_impl->m_datagramWakeup = CL_SharedPtr<DatagramWakeup>(new DatagramWakeup(*m_impl));
+		} catch (const CL_Exception &e) {
+			// everything will go through reliable connections
+			cl_log_event(LOG_WARN, "unable to open datagram channel: %1", e.message);
+		}
 
-		m_impl->startServerRegistrant();
+		m_impl->m_running = true;
+		cl_log_event(LOG_INFO, "server is up and running on port %1", port);
 	} catch (const CL_Exception &e) {
 		cl_log_event(LOG_ERROR, "unable to start the server: %1", e.message);
 	}
 }
 
-void ServerImpl::startServerRegistrant()
-{
-	cl_log_event(LOG_DEBUG, "launching game server register thread");
-	m_masterServerThread.start(&m_serverRegistrant);
-}
-
 void Server::stop()
 {
 	G_ASSERT(m_impl->m_running);
 
 	try {
 		m_impl->m_gameServer.stop();
+		m_impl->m_datagramWakeup = CL_SharedPtr<DatagramWakeup>();
+		m_impl->m_datagramChannel = CL_SharedPtr<DatagramChannel>();
 		m_impl->m_running = false;
-		m_impl->stopServerRegistrant();
 	} catch (const CL_Exception &e) {
 		cl_log_event(LOG_ERROR, "unable to stop the server: %1", e.message);
 	}
 }
 
-void ServerImpl::stopServerRegistrant()
+void Server::setServerName(const CL_String &p_serverName)
 {
-	cl_log_event(LOG_DEBUG, "stopping game server register thread");
-	m_serverRegistrant.interrupt();
-	m_masterServerThread.join();
+	m_impl->m_serverName = p_serverName;
 }
 
-void Server::setServerName(const CL_String &p_serverName)
+const ServerConfiguration &Server::getConfiguration() const
 {
-	m_impl->m_serverName = p_serverName;
+	return m_impl->m_config;
+}
+
+unsigned Server::getCheckedStateCount() const
+{
+	return m_impl->m_validationScheduler.getCheckedCount();
+}
+
+unsigned Server::getSkippedStateCount() const
+{
+	return m_impl->m_validationScheduler.getSkippedCount();
 }
 
 void ServerImpl::onClientConnected(CL_NetGameConnection *p_conn)
@@ -288,15 +570,24 @@ void ServerImpl::onClientConnected(CL_NetGameConnection *p_conn)
 	Player player;
 
 	// set default car state
-	CL_NetGameEvent data("");
+	Race::CarStateData state;
 
 	player.m_car->setPosition(CL_Pointf(-50.0f, -50.0f));
-	player.m_car->serialize(&data);
-	player.m_lastCarState.setSerializedData(data);
+	player.m_car->captureState(&state);
+	player.m_carStateCodec.setState(state);
+	player.m_snapshotCodec.setState(state);
+	player.m_validState = state;
 
 	m_connections[p_conn] = player;
+	m_progress.addCar(player.m_car.get());
 
 	sendGameMode(p_conn);
+
+	// client may send events by opcode from now on
+	OpcodeTable opcodeTable;
+	opcodeTable.setNames(PacketRegistry::getNames());
+
+	send(p_conn, opcodeTable.buildEvent());
 }
 
 void ServerImpl::onClientDisconnected(CL_NetGameConnection *p_conn)
@@ -328,57 +619,47 @@ void ServerImpl::onClientDisconnected(CL_NetGameConnection *p_conn)
 	sendToAll(playerLeft.buildEvent(), itor->first);
 
 	// cleanup
+	TConnectionPlayerMap::iterator other;
+
+	for (other = m_connections.begin(); other != m_connections.end(); ++other) {
+		other->second.m_interests.erase(p_conn);
+	}
+
+	if (player.m_datagramToken != 0) {
+		m_datagramTokens.erase(player.m_datagramToken);
+
+		if (m_datagramChannel) {
+			m_datagramChannel->forget(player.m_datagramToken);
+		}
+	}
+
+	m_progress.removeCar(player.m_car.get());
 	m_connections.erase(itor);
 }
 
 void ServerImpl::onEventArrived(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
 {
 	cl_log_event(LOG_EVENT, "event %1 arrived", p_event.to_string());
-	m_parent->handleEvent(p_conn, p_event);
+
+	const int opcode = m_registry.decode(p_event);
+	m_parent->handleEvent(p_conn, opcode, m_registry.restore(p_event, opcode));
 }
 
-void Server::handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
+void Server::handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event)
 {
-	m_impl->handleEvent(p_conn, p_event);
+	m_impl->handleEvent(p_conn, p_opcode, p_event);
 }
 
-void ServerImpl::handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
+void ServerImpl::handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event)
 {
-	try {
-		bool unhandled = false;
-
-
-		const CL_String eventName = p_event.get_name();
-
-		// connection initialize events
-
-		if (eventName == EVENT_CLIENT_INFO) {
-			onClientInfo(p_conn, p_event);
-		}
-
-		// master server events
-		if (eventName == EVENT_INFO_REQUEST) {
-			onServerInfoRequest(p_conn, p_event);
-		}
-
-		// race events
-
-		else if (eventName == EVENT_CAR_STATE) {
-			onCarState(p_conn, p_event);
-		} else if (eventName == EVENT_VOTE_START) {
-			onVoteStart(p_conn, p_event);
-		} else if (eventName == EVENT_VOTE_TICK) {
-			onVoteTick(p_conn, p_event);
-		}
-
-		// unknown events remains unhandled
-
-		else {
-			unhandled = true;
-		}
+	G_TRACE("Server::handleEvent");
 
+	try {
+		const TEventHandler handler = p_opcode != OP_UNKNOWN ? m_handlers[p_opcode] : NULL;
 
-		if (unhandled) {
+		if (handler != NULL) {
+			(this->*handler)(p_conn, p_event);
+		} else {
 			cl_log_event(
 					LOG_EVENT,
 					"event %1 remains unhandled",
@@ -461,72 +742,219 @@ void ServerImpl::onCarState(
 		CL_NetGameConnection *p_conn,
 		const CL_NetGameEvent &p_event)
 {
-	// state check precision
-	static const float PRECISSION = 0.5f;
+	G_TRACE("Server::onCarState");
 
+	CarState carState;
+	carState.parseEvent(p_event);
 
-	// register last car state
+	handleCarState(p_conn, carState);
+}
+
+void ServerImpl::handleCarState(
+		CL_NetGameConnection *p_conn,
+		const CarState &p_carState)
+{
 	Player &player = m_connections[p_conn];
-	player.m_lastCarState.parseEvent(p_event);
+
+	// decode against the previous state of this player
+	const CL_NetGameEvent data = p_carState.getSerializedData();
+	Race::CarStateData state;
+
+	if (
+			data.get_argument_count() != 1
+			|| !player.m_carStateCodec.decode(data.get_argument(0), &state)
+	) {
+		if (!player.m_carStateRequested) {
+			cl_log_event(LOG_DEBUG, "cannot decode car state of '%1', requesting full one", player.m_name);
+
+			CarStateRequest request;
+			request.setName(player.m_name);
+
+			send(p_conn, request.buildEvent());
+			player.m_carStateRequested = true;
+		}
+
+		return;
+	}
+
+	player.m_carStateRequested = false;
+
+	// register last car state
+	player.m_lastCarState = p_carState;
 
 	// player name may be not set by client
 	player.m_lastCarState.setName(player.m_name);
 
-	sendToAll(player.m_lastCarState.buildEvent(), p_conn);
+	// other players get it with the next snapshot without waiting
+	// for validation, which corrects it later when needed
+	player.m_validState = state;
+	player.m_car->applyState(state);
+	player.m_carStateDirty = true;
 
+	queueValidation(player, state);
+}
 
-	// validate client physics calculations
-	// and kick player when his state differs from server one
-	if (player.m_car->getIterationId() != -1) {
+void ServerImpl::queueValidation(Player &p_player, const Race::CarStateData &p_state)
+{
+	const bool suspicious = p_player.m_suspiciousStates > 0;
 
-		try {
-			CL_NetGameEvent serverState("");
+	if (suspicious) {
+		--p_player.m_suspiciousStates;
+	}
 
-			player.m_car->updateToIteration(
-					player.m_lastCarState.getIterationId()
-			);
+	const bool check = m_validationScheduler.shouldCheck(suspicious);
+
+	const CL_SharedPtr<CarValidation> validation(
+			new CarValidation(
+					p_player.m_validationCar,
+					p_state,
+					p_player.m_lastCarState.getIterationId(),
+					p_player.m_lastCarState.isAfterCollision(),
+					check,
+					m_validationResults
+			)
+	);
+
+	if (!p_player.m_validating) {
+		p_player.m_validating = true;
+		m_validationPool.submit(validation);
 
-			// compare server and client car position
+		return;
+	}
 
-			// this is position calculated by server
-			const CL_Pointf servPos = player.m_car->getPosition();
+	// newer states matter more, skipped one is taken unchecked by the next
+	if (p_player.m_pendingValidations.size() >= MAX_PENDING_VALIDATIONS) {
+		cl_log_event(LOG_WARN, "validation of '%1' falls behind, taking a state unchecked", p_player.m_name);
 
-			// apply client data and retrieve his position
-			player.m_car->deserialize(
-					player.m_lastCarState.getSerializedData()
-			);
-			const CL_Pointf &cliPos = player.m_car->getPosition();
-
-
-			if (!player.m_lastCarState.isAfterCollision()) {
-				if (
-						!Math::Float::cmp(servPos.x, cliPos.x, PRECISSION)
-						|| !Math::Float::cmp(servPos.y, cliPos.y, PRECISSION)
-				) {
-					cl_log_event(
-							LOG_WARN,
-							CL_String("diff in client and server states:\n")
-							+ "client x: %1  y: %2\nserver x: %3  y: %4",
-							cliPos.x, cliPos.y,
-							servPos.x, servPos.y
-					);
-
-//					kick(p_conn, GR_CHEATING);
-				}
+		const CL_SharedPtr<CarValidation> skipped = p_player.m_pendingValidations.front();
+		p_player.m_pendingValidations.pop_front();
+
+		if (p_player.m_pendingValidations.empty()) {
+			validation->setBaseState(skipped->getClientState());
+		} else {
+			p_player.m_pendingValidations.front()->setBaseState(skipped->getClientState());
+		}
+	}
+
+	p_player.m_pendingValidations.push_back(validation);
+}
+
+void ServerImpl::applyCorrection(Player &p_player, const Race::CarStateData &p_state)
+{
+	const int latestIteration = p_player.m_validState.get(Race::CarStateData::F_ITERATION);
+
+	// states received during validation are newer and are validated
+	// starting from this correction, so they catch up with it
+	if (p_state.get(Race::CarStateData::F_ITERATION) != latestIteration) {
+		return;
+	}
+
+	p_player.m_validState = p_state;
+	p_player.m_car->applyState(p_state);
+}
+
+void ServerImpl::applyValidationResults()
+{
+	G_TRACE("Server::applyValidationResults");
+
+	std::vector<CarValidationResult> results;
+	m_validationResults->take(&results);
+
+	foreach (const CarValidationResult &result, results) {
+
+		if (result.m_checked) {
+			m_validationScheduler.addCheckTime(result.m_replayUs);
+		}
+
+		// player may have left while his state was validated
+		TConnectionPlayerMap::iterator itor;
+
+		for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+			if (itor->second.m_validationCar == result.m_car) {
+				break;
 			}
+		}
+
+		if (itor == m_connections.end()) {
+			continue;
+		}
+
+		CL_NetGameConnection *conn = itor->first;
+		Player &player = itor->second;
 
-		} catch (CL_Exception &e) {
-			// something went wrong while comparing states
+		if (!result.m_error.empty()) {
 			// this also may be a cheater doing
-			cl_log_event(LOG_WARN, "%1", e.message);
-//			kick(p_conn, GR_CHEATING);
+			cl_log_event(LOG_WARN, "%1", result.m_error);
+			player.m_suspiciousStates = SUSPICIOUS_STATES;
+//			kick(conn, GR_CHEATING);
 		}
 
-	} else {
-		// this is first iteration, read data without checking it
-		player.m_car->deserialize(player.m_lastCarState.getSerializedData());
+		if (result.m_mismatch) {
+			cl_log_event(
+					LOG_WARN,
+					CL_String("diff in client and server states:\n")
+					+ "client x: %1  y: %2\nserver x: %3  y: %4",
+					result.m_clientPosition.x, result.m_clientPosition.y,
+					result.m_serverPosition.x, result.m_serverPosition.y
+			);
+
+			applyCorrection(player, result.m_state);
+			player.m_carStateDirty = true;
+			player.m_suspiciousStates = SUSPICIOUS_STATES;
+
+//			kick(conn, GR_CHEATING);
+		}
+
+		sendCarStateAck(conn, player, result.m_state);
+
+		// validations of one car go one after another
+		if (player.m_pendingValidations.empty()) {
+			player.m_validating = false;
+		} else {
+			m_validationPool.submit(player.m_pendingValidations.front());
+			player.m_pendingValidations.pop_front();
+		}
 	}
 
+	m_validationScheduler.tick();
+
+	const unsigned now = CL_System::get_time();
+
+	if (now - m_lastValidationStatsTime >= VALIDATION_STATS_INTERVAL_MS) {
+		cl_log_event(
+				LOG_INFO,
+				"car states checked: %1, skipped: %2, sample rate: %3",
+				m_validationScheduler.getCheckedCount(),
+				m_validationScheduler.getSkippedCount(),
+				m_validationScheduler.getSampleRate()
+		);
+
+		m_lastValidationStatsTime = now;
+	}
+}
+
+void ServerImpl::onCarStateRequest(
+		CL_NetGameConnection *p_conn,
+		const CL_NetGameEvent &p_event)
+{
+	CarStateRequest request;
+	request.parseEvent(p_event);
+
+	TConnectionPlayerMap::iterator itor;
+
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+		const Player &player = itor->second;
+
+		if (player.m_gameStateSent && player.m_name == request.getName()) {
+			send(p_conn, prepareFullCarState(player).buildEvent());
+
+			m_connections[p_conn].m_interests[itor->first].markSent(
+					player.m_snapshotVersion, CL_System::get_time()
+			);
+
+			break;
+		}
+	}
 }
 
 void ServerImpl::onClientInfo(
@@ -550,6 +978,14 @@ void ServerImpl::onClientInfo(
 		return;
 	}
 
+	// older clients ignore the opcode table and expect full names
+	m_connections[p_conn].m_opcodes =
+			clientInfo.getProtocolVersion().getMinor() >= OPCODE_PROTOCOL_MINOR;
+
+	// older clients need all car states in the game state
+	m_connections[p_conn].m_chunkedJoin =
+			clientInfo.getProtocolVersion().getMinor() >= CHUNKED_JOIN_PROTOCOL_MINOR;
+
 	// check name availability
 	bool nameAvailable = true;
 	TConnectionPlayerPair pair;
@@ -588,10 +1024,19 @@ void ServerImpl::onClientInfo(
 	sendToAll(playerJoined.buildEvent(), p_conn);
 
 	// send the gamestate
-	const GameState gamestate = prepareGameState();
-	send(p_conn, gamestate.buildEvent());
+	Player &player = m_connections[p_conn];
+
+	if (player.m_chunkedJoin) {
+		// other cars are streamed by following snapshots
+		send(p_conn, prepareGameStateHeader(p_conn).buildEvent());
+	} else {
+		send(p_conn, prepareGameState().buildInlineEvent());
+		markCarStatesSent(player);
+	}
+
+	player.m_gameStateSent = true;
 
-	m_connections[p_conn].m_gameStateSent = true;
+	openDatagramChannel(p_conn);
 }
 
 void ServerImpl::sendGameMode(CL_NetGameConnection *p_conn)
@@ -612,33 +1057,66 @@ GameState ServerImpl::prepareGameState()
 {
 	GameState gamestate;
 
-	TConnectionPlayerPair pair;
+	TConnectionPlayerMap::const_iterator itor;
 
-	foreach (pair, m_connections) {
-		const ServerImpl::Player &player = pair.second;
-		gamestate.addPlayer(player.m_name, player.m_lastCarState);
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+		const ServerImpl::Player &player = itor->second;
+		gamestate.addPlayer(player.m_name, prepareFullCarState(player));
 	}
 
 
-	const CL_String levPath =
-			cl_format(
-					"%1/%2",
-					LEVELS_DIR,
-					Properties::getString(SRV_LEVEL)
-			);
+	gamestate.setLevel(m_config.getLevelPath());
 
-	gamestate.setLevel(levPath);
+	return gamestate;
+}
+
+GameState ServerImpl::prepareGameStateHeader(CL_NetGameConnection *p_receiver)
+{
+	GameState gamestate;
+
+	TConnectionPlayerMap::const_iterator itor;
+
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+		const ServerImpl::Player &player = itor->second;
+
+		if (itor->first == p_receiver) {
+			gamestate.addPlayer(player.m_name, prepareFullCarState(player));
+		} else {
+			gamestate.addPlayer(player.m_name);
+		}
+	}
+
+	gamestate.setLevel(m_config.getLevelPath());
 
 	return gamestate;
 }
 
+CarState ServerImpl::prepareFullCarState(const Player &p_player)
+{
+	CarState carState(p_player.m_lastCarState);
+	CL_NetGameEvent data("");
+
+	data.add_argument(p_player.m_snapshotCodec.encodeFull());
+
+	carState.setName(p_player.m_name);
+	carState.setIterationId(p_player.m_snapshotCodec.getState().get(Race::CarStateData::F_ITERATION));
+	carState.setSerializedData(data);
+
+	return carState;
+}
 
 void ServerImpl::send(
 		CL_NetGameConnection *p_con,
 		const CL_NetGameEvent &p_event
 )
 {
-	p_con->send_event(p_event);
+	const TConnectionPlayerMap::const_iterator itor = m_connections.find(p_con);
+
+	if (itor != m_connections.end() && itor->second.m_opcodes) {
+		p_con->send_event(m_registry.encode(p_event));
+	} else {
+		p_con->send_event(p_event);
+	}
 }
 
 void ServerImpl::sendToAll(
@@ -647,19 +1125,411 @@ void ServerImpl::sendToAll(
 		bool p_ignoreNotFullyConnected
 )
 {
-	TConnectionPlayerPair pair;
+	// iterate by reference, copying each player is more
+	// expensive than sending the event
+	TConnectionPlayerMap::const_iterator itor;
+
+	// encoded once for all players that understand opcodes
+	const CL_NetGameEvent encoded = m_registry.encode(p_event);
+
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+
+		if (itor->first == p_ignore) {
+			continue;
+		}
+
+		if (p_ignoreNotFullyConnected && !itor->second.m_gameStateSent) {
+			continue;
+		}
+
+		itor->first->send_event(itor->second.m_opcodes ? encoded : p_event);
+	}
+}
+
+void Server::update()
+{
+	if (m_impl->m_datagramChannel) {
+		m_impl->receiveDatagrams();
+	}
+
+	m_impl->applyValidationResults();
+
+	const unsigned now = CL_System::get_time();
+
+	if (now - m_impl->m_lastSnapshotTime >= m_impl->m_snapshotInterval) {
+		m_impl->sendSnapshot();
+		m_impl->m_lastSnapshotTime = now;
+	}
+}
+
+void ServerImpl::sendSnapshot()
+{
+	G_TRACE("Server::sendSnapshot");
+
+	const unsigned now = CL_System::get_time();
+	TConnectionPlayerMap::iterator itor, carItor;
+
+	// encode each changed car once for all receivers
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+		Player &player = itor->second;
 
-	foreach(pair, m_connections) {
+		player.m_snapshotDelta.clear();
+		player.m_snapshotFull.clear();
 
-		if (pair.first == p_ignore) {
+		if (!player.m_carStateDirty || !player.m_gameStateSent) {
 			continue;
 		}
 
-		if (p_ignoreNotFullyConnected && !pair.second.m_gameStateSent) {
+		// states received since last snapshot are merged,
+		// so they are encoded again as one step of the stream
+		player.m_snapshotDelta = player.m_snapshotCodec.encode(player.m_validState);
+		++player.m_snapshotVersion;
+
+		player.m_carStateDirty = false;
+	}
+
+	m_progress.update();
+
+	// each receiver gets only cars relevant to it
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+		Player &receiver = itor->second;
+
+		if (!receiver.m_gameStateSent) {
 			continue;
 		}
 
-		pair.first->send_event(p_event);
+		Snapshot snapshot;
+		int newCars = 0;
+
+		for (carItor = m_connections.begin(); carItor != m_connections.end(); ++carItor) {
+			if (carItor == itor || !carItor->second.m_gameStateSent) {
+				continue;
+			}
+
+			// joining player gets big rooms spread over a few snapshots
+			const bool known =
+					receiver.m_interests.find(carItor->first) != receiver.m_interests.end();
+
+			if (!known) {
+				if (newCars == MAX_NEW_CARS_PER_SNAPSHOT) {
+					continue;
+				}
+
+				++newCars;
+			}
+
+			addToSnapshot(receiver, carItor->first, carItor->second, now, &snapshot);
+		}
+
+		if (snapshot.isEmpty()) {
+			continue;
+		}
+
+		if (receiver.m_datagramOpen) {
+			sendDatagramSnapshot(receiver, snapshot);
+		} else {
+			send(itor->first, snapshot.buildEvent());
+		}
+	}
+}
+
+void ServerImpl::addToSnapshot(
+		Player &p_receiver,
+		CL_NetGameConnection *p_carConn,
+		Player &p_car,
+		unsigned p_now,
+		Snapshot *p_snapshot
+)
+{
+	SnapshotInterest &interest = p_receiver.m_interests[p_carConn];
+
+	const SnapshotInterest::Content content = interest.getContent(
+			p_car.m_snapshotVersion,
+			!p_car.m_snapshotDelta.empty(),
+			interest.isKnown() ? getSnapshotInterval(p_receiver, p_car) : 0,
+			!p_receiver.m_datagramOpen,
+			p_now
+	);
+
+	if (content == SnapshotInterest::C_NONE) {
+		return;
+	}
+
+	CarState carState(p_car.m_lastCarState);
+	CL_NetGameEvent data("");
+
+	if (content == SnapshotInterest::C_DELTA) {
+		data.add_argument(p_car.m_snapshotDelta);
+	} else {
+		if (p_car.m_snapshotFull.empty()) {
+			p_car.m_snapshotFull = p_car.m_snapshotCodec.encodeFull();
+		}
+
+		data.add_argument(p_car.m_snapshotFull);
+	}
+
+	carState.setSerializedData(data);
+	p_snapshot->addCarState(carState);
+
+	interest.markSent(p_car.m_snapshotVersion, p_now);
+}
+
+void ServerImpl::sendDatagramSnapshot(const Player &p_receiver, const Snapshot &p_snapshot)
+{
+	// each datagram is a snapshot on its own, parts of one snapshot
+	// carry different cars, so none of them makes the others stale
+	std::vector<CL_String8> parts;
+
+	Snapshot chunk;
+	unsigned chunkSize = 0;
+
+	const int count = p_snapshot.getCarStateCount();
+
+	for (int i = 0; i < count; ++i) {
+		const CarState &carState = p_snapshot.getCarState(i);
+
+		BitWriter writer;
+		carState.write(writer);
+
+		const unsigned size = writer.getData().length();
+
+		if (!chunk.isEmpty() && chunkSize + size > DatagramChannel::MAX_MESSAGE_SIZE) {
+			parts.push_back(buildDatagram(DATAGRAM_SNAPSHOT, chunk.pack()));
+
+			chunk = Snapshot();
+			chunkSize = 0;
+		}
+
+		chunk.addCarState(carState);
+		chunkSize += size;
+	}
+
+	if (!chunk.isEmpty()) {
+		parts.push_back(buildDatagram(DATAGRAM_SNAPSHOT, chunk.pack()));
+	}
+
+	m_datagramChannel->sendParts(p_receiver.m_datagramToken, parts, p_receiver.m_datagramAddress);
+}
+
+void ServerImpl::sendDatagram(const Player &p_receiver, unsigned p_type, const CL_String8 &p_payload)
+{
+	m_datagramChannel->send(
+			p_receiver.m_datagramToken,
+			buildDatagram(p_type, p_payload),
+			p_receiver.m_datagramAddress
+	);
+}
+
+CL_String8 ServerImpl::buildDatagram(unsigned p_type, const CL_String8 &p_payload)
+{
+	CL_String8 message;
+
+	message.push_back(static_cast<char>(p_type));
+	message.append(p_payload);
+
+	return message;
+}
+
+void ServerImpl::sendCarStateAck(
+		CL_NetGameConnection *p_conn,
+		const Player &p_player,
+		const Race::CarStateData &p_state
+)
+{
+	CarStateCodec codec;
+	codec.setState(p_state);
+
+	CarStateAck ack;
+	ack.setData(codec.encodeFull());
+
+	if (p_player.m_datagramOpen) {
+		sendDatagram(p_player, DATAGRAM_CAR_STATE_ACK, ack.getData());
+	} else {
+		send(p_conn, ack.buildEvent());
+	}
+}
+
+CL_Event DatagramWakeup::get_wakeup_event()
+{
+	return m_impl.m_datagramChannel->getReadEvent();
+}
+
+void DatagramWakeup::process()
+{
+	m_impl.receiveDatagrams();
+}
+
+void ServerImpl::receiveDatagrams()
+{
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	while (m_datagramChannel->receive(&token, &message, &from)) {
+		TTokenConnectionMap::iterator itor = m_datagramTokens.find(token);
+
+		if (itor == m_datagramTokens.end()) {
+			// do not keep sequences of made up tokens
+			m_datagramChannel->forget(token);
+			continue;
+		}
+
+		if (message.empty()) {
+			continue;
+		}
+
+		CL_NetGameConnection *conn = itor->second;
+		Player &player = m_connections[conn];
+
+		const unsigned type = static_cast<unsigned char>(message[0]);
+		const CL_String8 payload = message.substr(1);
+
+		// channel takes datagrams only from host of the player, but
+		// the port may change behind NAT, so new one is challenged
+		const bool knownAddress = player.m_datagramAddressKnown && from == player.m_datagramAddress;
+
+		switch (type) {
+			case DATAGRAM_HELLO: {
+				BitReader reader(payload);
+				const unsigned challenge = reader.readBits(32);
+
+				if (reader.isOverrun() || challenge != player.m_datagramChallenge) {
+					if (!knownAddress) {
+						challengeDatagramAddress(conn);
+					}
+
+					break;
+				}
+
+				if (!knownAddress) {
+					player.m_datagramAddress = from;
+					player.m_datagramAddressKnown = true;
+				}
+
+				sendDatagram(player, DATAGRAM_HELLO, "");
+				break;
+			}
+
+			case DATAGRAM_CAR_STATE: {
+				BitReader reader(payload);
+
+				CarState carState;
+				carState.read(reader);
+
+				if (!reader.isOverrun()) {
+					handleCarState(conn, carState);
+				}
+
+				if (!knownAddress) {
+					challengeDatagramAddress(conn);
+				}
+
+				break;
+			}
+
+			default:
+				cl_log_event(LOG_EVENT, "datagram type %1 remains unhandled", type);
+		}
+	}
+}
+
+void ServerImpl::openDatagramChannel(CL_NetGameConnection *p_conn)
+{
+	if (!m_datagramChannel) {
+		return;
+	}
+
+	unsigned token;
+
+	do {
+		token = generateToken();
+	} while (m_datagramTokens.find(token) != m_datagramTokens.end());
+
+	Player &player = m_connections[p_conn];
+
+	player.m_datagramToken = token;
+	m_datagramTokens[token] = p_conn;
+
+	// spoofed datagrams must not steer the stream to other hosts
+	m_datagramChannel->bind(token, p_conn->get_remote_address().get_address());
+
+	challengeDatagramAddress(p_conn);
+}
+
+void ServerImpl::onDatagramOpen(
+		CL_NetGameConnection *p_conn,
+		const CL_NetGameEvent &p_event)
+{
+	DatagramOpen datagramOpen;
+	datagramOpen.parseEvent(p_event);
+
+	Player &player = m_connections[p_conn];
+
+	// confirmation may answer a challenge replaced in the meantime
+	if (!player.m_datagramAddressKnown || datagramOpen.getChallenge() != player.m_datagramChallenge) {
+		return;
+	}
+
+	if (!player.m_datagramOpen) {
+		cl_log_event(LOG_EVENT, "datagram channel of '%1' is open", player.m_name);
+		player.m_datagramOpen = true;
+	}
+}
+
+void ServerImpl::challengeDatagramAddress(CL_NetGameConnection *p_conn)
+{
+	Player &player = m_connections[p_conn];
+	const unsigned now = CL_System::get_time();
+
+	if (player.m_datagramChallenge != 0 && now - player.m_datagramChallengeTime < DATAGRAM_CHALLENGE_INTERVAL_MS) {
+		return;
+	}
+
+	// datagrams go through reliable connection until the answer
+	player.m_datagramChallenge = generateToken();
+	player.m_datagramChallengeTime = now;
+	player.m_datagramAddressKnown = false;
+	player.m_datagramOpen = false;
+
+	DatagramToken datagramToken;
+
+	datagramToken.setToken(player.m_datagramToken);
+	datagramToken.setPort(m_config.getPort());
+	datagramToken.setChallenge(player.m_datagramChallenge);
+
+	send(p_conn, datagramToken.buildEvent());
+}
+
+unsigned ServerImpl::generateToken()
+{
+	unsigned token;
+
+	do {
+		m_tokenSeed = m_tokenSeed * 1664525 + 1013904223;
+		token = m_tokenSeed ^ static_cast<unsigned>(CL_System::get_microseconds());
+	} while (token == 0);
+
+	return token;
+}
+
+unsigned ServerImpl::getSnapshotInterval(const Player &p_receiver, const Player &p_car) const
+{
+	const CL_Pointf &receiverPos = p_receiver.m_car->getPosition();
+	const CL_Pointf &carPos = p_car.m_car->getPosition();
+
+	return SnapshotInterest::getInterval(
+			receiverPos.distance(carPos),
+			m_progress.getTrackDistance(*p_receiver.m_car, *p_car.m_car)
+	);
+}
+
+void ServerImpl::markCarStatesSent(Player &p_receiver)
+{
+	const unsigned now = CL_System::get_time();
+	TConnectionPlayerMap::const_iterator itor;
+
+	for (itor = m_connections.begin(); itor != m_connections.end(); ++itor) {
+		p_receiver.m_interests[itor->first].markSent(itor->second.m_snapshotVersion, now);
 	}
 }
 
@@ -35,10 +35,15 @@
 
 class CL_NetGameConnection;
 class CL_NetGameEvent;
-class ServerConfiguration;
+class WorkerPool;
+namespace Race {
+class Level;
+}
 
 namespace Net {
 
+class ServerConfiguration;
+
 class ServerImpl;
 
 class Server {
@@ -49,19 +54,37 @@ class Server {
 
 	public:
 
-		Server();
+		/**
+		 * Creates the room described by p_config. Level and the pool
+		 * validating car states are shared with other rooms, level must
+		 * not change while the server exists.
+		 */
+		Server(const ServerConfiguration &p_config, const Race::Level &p_level, WorkerPool &p_validationPool);
+
 		virtual ~Server();
 
 		void start();
 		void stop();
 
+		/** Sends pending car states when snapshot time comes */
+		void update();
+
 		void setServerName(const CL_String &p_serverName);
 
+		const ServerConfiguration &getConfiguration() const;
+
+
+		/** @return number of car states replayed to check them */
+		unsigned getCheckedStateCount() const;
+
+		/** @return number of car states taken without check to save time */
+		unsigned getSkippedStateCount() const;
+
 
 	protected:
 
-		/** @return true if event was handled */
-		virtual void handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
+		/** Handles event with opcode p_opcode, OP_UNKNOWN for unknown ones */
+		virtual void handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event);
 
 		virtual TGameMode getGameMode() const;
 
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ServerConfiguration.h"
+
+#include "common.h"
+#include "common/Properties.h"
+
+namespace Net {
+
+namespace {
+
+/** @return room specific property key for global key p_key */
+CL_String roomKey(int p_room, const CL_String &p_key)
+{
+	// strip "srv_" part of global key
+	return cl_format("%1%2_%3", SRV_ROOM_PREFIX, p_room, p_key.substr(4));
+}
+
+CL_String roomString(int p_room, const CL_String &p_key, const CL_String &p_default)
+{
+	return Properties::getString(roomKey(p_room, p_key), Properties::getString(p_key, p_default));
+}
+
+} // namespace
+
+ServerConfiguration::ServerConfiguration() :
+		m_port(DEFAULT_PORT),
+		m_gameMode(SRV_GAME_MODE_ARCADE)
+{
+	// empty
+}
+
+ServerConfiguration ServerConfiguration::fromProperties(int p_room)
+{
+	ServerConfiguration config;
+
+	const int basePort = Properties::getInt(SRV_PORT, DEFAULT_PORT);
+
+	config.m_port = Properties::getInt(roomKey(p_room, SRV_PORT), basePort + p_room);
+	config.m_level = roomString(p_room, SRV_LEVEL, "");
+	config.m_gameMode = roomString(p_room, SRV_GAME_MODE, SRV_GAME_MODE_ARCADE);
+
+	return config;
+}
+
+CL_String ServerConfiguration::getLevelPath() const
+{
+	return cl_format("%1/%2", LEVELS_DIR, m_level);
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "clanlib/core/text.h"
+
+namespace Net {
+
+/** Settings of one room hosted by the server */
+class ServerConfiguration {
+
+	public:
+
+		ServerConfiguration();
+
+		/**
+		 * Reads settings of room p_room. Keys srv_room<n>_* override
+		 * the srv_* ones, rooms get consecutive ports by default.
+		 */
+		static ServerConfiguration fromProperties(int p_room);
+
+
+		int getPort() const { return m_port; }
+
+		/** @return level file name relative to levels directory */
+		const CL_String &getLevel() const { return m_level; }
+
+		/** @return level path relative to working directory */
+		CL_String getLevelPath() const;
+
+		const CL_String &getGameMode() const { return m_gameMode; }
+
+
+		void setPort(int p_port) { m_port = p_port; }
+
+		void setLevel(const CL_String &p_level) { m_level = p_level; }
+
+		void setGameMode(const CL_String &p_gameMode) { m_gameMode = p_gameMode; }
+
+	private:
+
+		int m_port;
+
+		CL_String m_level;
+
+		CL_String m_gameMode;
+};
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SnapshotInterest.h"
+
+#include <algorithm>
+
+namespace Net {
+
+/* Cars closer than this are on the receiver screen and sent on every snapshot */
+const float VISIBLE_DISTANCE = 600.0f;
+
+/* Cars closer along the track are sent at reduced rate */
+const int NEAR_TRACK_DISTANCE = 2000;
+const unsigned NEAR_INTERVAL_MS = 200;
+
+/* Rest of cars is only refreshed from time to time */
+const unsigned FAR_INTERVAL_MS = 2000;
+
+/* Unchanged cars are sent again through datagrams in case they were lost */
+const unsigned DATAGRAM_REFRESH_MS = 500;
+
+SnapshotInterest::SnapshotInterest() :
+	m_known(false),
+	m_version(0),
+	m_sentTime(0)
+{
+	// empty
+}
+
+unsigned SnapshotInterest::getInterval(float p_distance, int p_trackDistance)
+{
+	if (p_distance <= VISIBLE_DISTANCE) {
+		return 0;
+	}
+
+	if (p_trackDistance <= NEAR_TRACK_DISTANCE) {
+		return NEAR_INTERVAL_MS;
+	}
+
+	return FAR_INTERVAL_MS;
+}
+
+SnapshotInterest::Content SnapshotInterest::getContent(
+		unsigned p_version,
+		bool p_hasDelta,
+		unsigned p_interval,
+		bool p_reliable,
+		unsigned p_now
+) const
+{
+	// cars unknown to the receiver are sent at once
+	if (!m_known) {
+		return C_FULL;
+	}
+
+	const unsigned sinceSent = p_now - m_sentTime;
+
+	if (m_version == p_version) {
+		if (p_reliable || sinceSent < std::max(p_interval, DATAGRAM_REFRESH_MS)) {
+			return C_NONE;
+		}
+	} else if (sinceSent < p_interval) {
+		return C_NONE;
+	}
+
+	if (p_reliable && p_hasDelta && m_version + 1 == p_version) {
+		return C_DELTA;
+	}
+
+	// receiver missed some states
+	return C_FULL;
+}
+
+void SnapshotInterest::markSent(unsigned p_version, unsigned p_now)
+{
+	m_known = true;
+	m_version = p_version;
+	m_sentTime = p_now;
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+namespace Net {
+
+/**
+ * What one receiver was sent of one car. Decides when the car goes
+ * to the next snapshot of the receiver and whether a delta is enough.
+ * Cars on the receiver screen are sent with every snapshot, cars near
+ * along the track at reduced rate and the rest only from time to time.
+ */
+class SnapshotInterest
+{
+	public:
+
+		enum Content {
+			/** Receiver does not need the car now */
+			C_NONE,
+			/** Delta from the version receiver has */
+			C_DELTA,
+			/** Full state, receiver missed something or it may be lost */
+			C_FULL
+		};
+
+
+		/** Interest in a car that was not sent yet */
+		SnapshotInterest();
+
+
+		/**
+		 * @param p_distance Distance between the cars in world units
+		 * @param p_trackDistance Distance between the cars along the track
+		 * @return time between states of the car in milliseconds
+		 */
+		static unsigned getInterval(float p_distance, int p_trackDistance);
+
+		/**
+		 * @param p_version Current snapshot version of the car
+		 * @param p_hasDelta Delta from the previous version is available
+		 * @param p_interval Result of getInterval()
+		 * @param p_reliable Receiver gets snapshots through the reliable
+		 *        connection, datagrams may be lost so they carry full states
+		 */
+		Content getContent(
+				unsigned p_version,
+				bool p_hasDelta,
+				unsigned p_interval,
+				bool p_reliable,
+				unsigned p_now
+		) const;
+
+		void markSent(unsigned p_version, unsigned p_now);
+
+
+		bool isKnown() const { return m_known; }
+
+	private:
+
+		bool m_known;
+
+		/** Snapshot version of the car last sent to the receiver */
+		unsigned m_version;
+
+		unsigned m_sentTime;
+};
+
+}
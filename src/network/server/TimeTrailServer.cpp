@@ -28,7 +28,7 @@
 
 #include "TimeTrailServer.h"
 
-#include "network/events.h"
+#include "network/PacketRegistry.h"
 #include "network/server/RankingService.h"
 
 namespace Net
@@ -44,11 +44,11 @@ class TimeTrailServerImpl
 
 		TimeTrailServerImpl(TimeTrailServer *p_parent);
 
-		bool handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
-		void handleRankingEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
+		bool handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event);
 };
 
-TimeTrailServer::TimeTrailServer() :
+TimeTrailServer::TimeTrailServer(const ServerConfiguration &p_config, const Race::Level &p_level, WorkerPool &p_validationPool) :
+		Server(p_config, p_level, p_validationPool),
 		m_impl(new TimeTrailServerImpl(this))
 {
 	// empty
@@ -65,31 +65,29 @@ TimeTrailServer::~TimeTrailServer()
 	// empty
 }
 
-void TimeTrailServer::handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
+void TimeTrailServer::handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event)
 {
-	const bool handled = m_impl->handleEvent(p_conn, p_event);
+	const bool handled = m_impl->handleEvent(p_conn, p_opcode, p_event);
 
 	if (!handled) {
-		Server::handleEvent(p_conn, p_event);
+		Server::handleEvent(p_conn, p_opcode, p_event);
 	}
 }
 
-bool TimeTrailServerImpl::handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
+bool TimeTrailServerImpl::handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event)
 {
-	if (isRankingEvent(p_event)) {
-		handleRankingEvent(p_conn, p_event);
-		return true;
-	} else {
-		return false;
+	switch (p_opcode) {
+		case OP_RANKING_FIND:
+		case OP_RANKING_ADVANCE:
+		case OP_RANKING_REQUEST:
+			m_rankingServer.parseEvent(p_conn, p_opcode, p_event);
+			return true;
+
+		default:
+			return false;
 	}
 }
 
-void TimeTrailServerImpl::handleRankingEvent(
-		CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event)
-{
-	m_rankingServer.parseEvent(p_conn, p_event);
-}
-
 TGameMode TimeTrailServer::getGameMode() const
 {
 	return GM_TIME_TRAIL;
@@ -40,13 +40,13 @@ class TimeTrailServer : public Server
 {
 	public:
 
-		TimeTrailServer();
+		TimeTrailServer(const ServerConfiguration &p_config, const Race::Level &p_level, WorkerPool &p_validationPool);
 		virtual ~TimeTrailServer();
 
 
 	protected:
 
-		virtual void handleEvent(CL_NetGameConnection *p_conn, const CL_NetGameEvent &p_event);
+		virtual void handleEvent(CL_NetGameConnection *p_conn, int p_opcode, const CL_NetGameEvent &p_event);
 
 		virtual TGameMode getGameMode() const;
 
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ValidationScheduler.h"
+
+#include <algorithm>
+
+#include "clanlib/core/system.h"
+
+namespace Net {
+
+/** Some states are checked however busy the room is */
+const float MIN_SAMPLE_RATE = 0.02f;
+
+/** Rate grows back slowly when checks take less than half of budget */
+const float SAMPLE_RATE_GROWTH = 1.25f;
+
+ValidationScheduler::ValidationScheduler(unsigned p_budgetUs) :
+	m_budgetUs(p_budgetUs),
+	m_spentUs(0),
+	m_sampleRate(1.0f),
+	m_checkedCount(0),
+	m_skippedCount(0)
+{
+	// each room starts at a different point of the sequence
+	m_seed = static_cast<unsigned>(CL_System::get_microseconds())
+			^ static_cast<unsigned>(reinterpret_cast<size_t>(this));
+}
+
+ValidationScheduler::ValidationScheduler(unsigned p_budgetUs, unsigned p_seed) :
+	m_budgetUs(p_budgetUs),
+	m_spentUs(0),
+	m_sampleRate(1.0f),
+	m_seed(p_seed),
+	m_checkedCount(0),
+	m_skippedCount(0)
+{
+	// empty
+}
+
+bool ValidationScheduler::shouldCheck(bool p_suspicious)
+{
+	if (p_suspicious || random() < m_sampleRate) {
+		++m_checkedCount;
+		return true;
+	}
+
+	++m_skippedCount;
+	return false;
+}
+
+void ValidationScheduler::addCheckTime(unsigned p_us)
+{
+	m_spentUs += p_us;
+}
+
+void ValidationScheduler::tick()
+{
+	if (m_spentUs > m_budgetUs) {
+		// scale down to what would fit the budget
+		m_sampleRate *= static_cast<float>(m_budgetUs) / m_spentUs;
+	} else if (m_spentUs < m_budgetUs / 2) {
+		m_sampleRate *= SAMPLE_RATE_GROWTH;
+	}
+
+	m_sampleRate = std::max(MIN_SAMPLE_RATE, std::min(m_sampleRate, 1.0f));
+	m_spentUs = 0;
+}
+
+float ValidationScheduler::random()
+{
+	m_seed = m_seed * 1664525 + 1013904223;
+	return (m_seed >> 8) / static_cast<float>(1 << 24);
+}
+
+}
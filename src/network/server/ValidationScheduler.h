@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+namespace Net {
+
+/**
+ * Decides which car states are replayed to check them, so validation
+ * of a room stays within its CPU budget. States of suspicious players
+ * are always checked, the rest are sampled at a rate adjusted after
+ * each tick to the time the checks took.
+ */
+class ValidationScheduler
+{
+	public:
+
+		/**
+		 * Samples states at random, so players cannot predict which
+		 * of their states are checked.
+		 *
+		 * @param p_budgetUs replay time allowed per tick in microseconds
+		 */
+		explicit ValidationScheduler(unsigned p_budgetUs);
+
+		/** Samples states in sequence given by p_seed, for tests */
+		ValidationScheduler(unsigned p_budgetUs, unsigned p_seed);
+
+
+		/** @return true when the state should be replayed */
+		bool shouldCheck(bool p_suspicious);
+
+		/** Counts replay time of a finished check */
+		void addCheckTime(unsigned p_us);
+
+		/** Adjusts sample rate to time spent since previous tick */
+		void tick();
+
+
+		float getSampleRate() const { return m_sampleRate; }
+
+		unsigned getCheckedCount() const { return m_checkedCount; }
+
+		unsigned getSkippedCount() const { return m_skippedCount; }
+
+	private:
+
+		unsigned m_budgetUs;
+
+		unsigned m_spentUs;
+
+		/** Part of not suspicious states that is checked */
+		float m_sampleRate;
+
+		unsigned m_seed;
+
+		unsigned m_checkedCount;
+
+		unsigned m_skippedCount;
+
+
+		/** @return pseudo random number in [0, 1) */
+		float random();
+};
+
+}
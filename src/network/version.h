@@ -38,5 +38,5 @@
 // When both numbers are equal then communication is fully
 // established.
 
-#define PROTOCOL_VERSION_MAJOR 4
-#define PROTOCOL_VERSION_MINOR 0
+#define PROTOCOL_VERSION_MAJOR 6
+#define PROTOCOL_VERSION_MINOR 3
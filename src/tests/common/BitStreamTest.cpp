@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+
+#include "common/BitStream.h"
+
+BOOST_AUTO_TEST_SUITE(BitStreamTest)
+
+BOOST_AUTO_TEST_CASE(readWritten)
+{
+	BitWriter writer;
+
+	writer.writeBits(5, 3);
+	writer.writeBool(true);
+	writer.writeSigned(-1000, 12);
+	writer.writeBits(0xDEADBEEF, 32);
+	writer.writeVarUint(0);
+	writer.writeVarUint(300);
+	writer.writeVarUint(0xFFFFFFFF);
+	writer.writeSigned(-2147483647 - 1, 32);
+
+	BitReader reader(writer.getData());
+
+	BOOST_CHECK_EQUAL(reader.readBits(3), 5u);
+	BOOST_CHECK(reader.readBool());
+	BOOST_CHECK_EQUAL(reader.readSigned(12), -1000);
+	BOOST_CHECK_EQUAL(reader.readBits(32), 0xDEADBEEF);
+	BOOST_CHECK_EQUAL(reader.readVarUint(), 0u);
+	BOOST_CHECK_EQUAL(reader.readVarUint(), 300u);
+	BOOST_CHECK_EQUAL(reader.readVarUint(), 0xFFFFFFFF);
+	BOOST_CHECK_EQUAL(reader.readSigned(32), -2147483647 - 1);
+
+	BOOST_CHECK(!reader.isOverrun());
+}
+
+BOOST_AUTO_TEST_CASE(packedSize)
+{
+	BitWriter writer;
+
+	for (int i = 0; i < 8; ++i) {
+		writer.writeBool(i % 2 == 0);
+	}
+
+	BOOST_CHECK_EQUAL(writer.getData().length(), 1u);
+
+	writer.writeBits(1, 1);
+	BOOST_CHECK_EQUAL(writer.getData().length(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(overrun)
+{
+	BitWriter writer;
+	writer.writeBits(0xAB, 8);
+
+	BitReader reader(writer.getData());
+
+	BOOST_CHECK_EQUAL(reader.readBits(8), 0xABu);
+	BOOST_CHECK(!reader.isOverrun());
+
+	BOOST_CHECK_EQUAL(reader.readBits(1), 0u);
+	BOOST_CHECK(reader.isOverrun());
+}
+
+BOOST_AUTO_TEST_CASE(readTemporary)
+{
+	BitWriter writer;
+	writer.writeBits(0xDEADBEEF, 32);
+
+	// data outlives the string given to the reader
+	BitReader reader(writer.getData().substr(0));
+	writer = BitWriter();
+
+	BOOST_CHECK_EQUAL(reader.readBits(32), 0xDEADBEEF);
+	BOOST_CHECK(!reader.isOverrun());
+}
+
+BOOST_AUTO_TEST_CASE(strings)
+{
+	BitWriter writer;
+
+	writer.writeString("aligned");
+	writer.writeBool(true);
+	writer.writeString("unaligned");
+	writer.writeString("");
+
+	BitReader reader(writer.getData());
+
+	BOOST_CHECK(reader.readString() == "aligned");
+	BOOST_CHECK(reader.readBool());
+	BOOST_CHECK(reader.readString() == "unaligned");
+	BOOST_CHECK(reader.readString() == "");
+	BOOST_CHECK(!reader.isOverrun());
+
+	// length pointing past the end
+	BitWriter broken;
+	broken.writeVarUint(100);
+
+	BitReader brokenReader(broken.getData());
+
+	BOOST_CHECK(brokenReader.readString() == "");
+	BOOST_CHECK(brokenReader.isOverrun());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
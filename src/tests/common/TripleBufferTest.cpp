@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/TripleBuffer.h"
+
+BOOST_AUTO_TEST_SUITE(TripleBufferTest)
+
+BOOST_AUTO_TEST_CASE(readNewest)
+{
+	TripleBuffer<int> buffer;
+
+	BOOST_CHECK(!buffer.hasFresh());
+
+	buffer.getBack() = 1;
+	buffer.publish();
+
+	BOOST_CHECK(buffer.hasFresh());
+	BOOST_CHECK_EQUAL(buffer.read(), 1);
+	BOOST_CHECK(!buffer.hasFresh());
+
+	// reader gets the last published value only
+	buffer.getBack() = 2;
+	buffer.publish();
+	buffer.getBack() = 3;
+	buffer.publish();
+
+	BOOST_CHECK_EQUAL(buffer.read(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(readWithoutPublish)
+{
+	TripleBuffer<int> buffer;
+
+	buffer.getBack() = 5;
+	buffer.publish();
+
+	BOOST_CHECK_EQUAL(buffer.read(), 5);
+
+	// writing without publishing is not visible
+	buffer.getBack() = 6;
+
+	BOOST_CHECK_EQUAL(buffer.read(), 5);
+	BOOST_CHECK_EQUAL(buffer.read(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(buffersNotShared)
+{
+	TripleBuffer<int> buffer;
+
+	// reader's value must stay valid while writer works
+	for (int i = 0; i < 10; ++i) {
+		buffer.getBack() = i;
+		buffer.publish();
+
+		const int &value = buffer.read();
+		BOOST_CHECK_EQUAL(value, i);
+
+		buffer.getBack() = -1;
+		BOOST_CHECK_EQUAL(value, i);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
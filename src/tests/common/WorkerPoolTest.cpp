@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/WorkerPool.h"
+
+namespace {
+
+class CountingJob : public WorkerJob
+{
+	public:
+
+		CountingJob(CL_Mutex *p_mutex, int *p_count, int p_total, CL_Event *p_done) :
+			m_mutex(p_mutex),
+			m_count(p_count),
+			m_total(p_total),
+			m_done(p_done)
+		{}
+
+		virtual void run()
+		{
+			CL_MutexSection lock(m_mutex);
+
+			if (++*m_count == m_total) {
+				m_done->set();
+			}
+		}
+
+	private:
+
+		CL_Mutex *m_mutex;
+
+		int *m_count, m_total;
+
+		CL_Event *m_done;
+};
+
+/** Finishes only when the other job runs at the same time */
+class WaitingJob : public WorkerJob
+{
+	public:
+
+		WaitingJob(CL_Event *p_wait, CL_Event *p_set, bool *p_succeed) :
+			m_wait(p_wait),
+			m_set(p_set),
+			m_succeed(p_succeed)
+		{}
+
+		virtual void run()
+		{
+			m_set->set();
+			*m_succeed = CL_Event::wait(*m_wait, 1000) == 0;
+		}
+
+	private:
+
+		CL_Event *m_wait, *m_set;
+
+		bool *m_succeed;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(WorkerPoolTest)
+
+BOOST_AUTO_TEST_CASE(runsAllJobs)
+{
+	static const int JOB_COUNT = 100;
+
+	CL_Mutex mutex;
+	CL_Event done(true, false);
+	int count = 0;
+
+	WorkerPool pool(3);
+
+	for (int i = 0; i < JOB_COUNT; ++i) {
+		pool.submit(CL_SharedPtr<WorkerJob>(new CountingJob(&mutex, &count, JOB_COUNT, &done)));
+	}
+
+	BOOST_REQUIRE(CL_Event::wait(done, 5000) == 0);
+	BOOST_CHECK_EQUAL(count, JOB_COUNT);
+}
+
+BOOST_AUTO_TEST_CASE(parallelJobs)
+{
+	CL_Event first(true, false), second(true, false);
+	bool firstSucceed = false, secondSucceed = false;
+
+	{
+		WorkerPool pool(2);
+
+		pool.submit(CL_SharedPtr<WorkerJob>(new WaitingJob(&second, &first, &firstSucceed)));
+		pool.submit(CL_SharedPtr<WorkerJob>(new WaitingJob(&first, &second, &secondSucceed)));
+
+		CL_Event::wait(first, 1000);
+		CL_Event::wait(second, 1000);
+
+		// pool waits for running jobs
+	}
+
+	BOOST_CHECK(firstSucceed);
+	BOOST_CHECK(secondSucceed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,8 @@
 
 #include "common/Player.h"
 #include "logic/race/Car.h"
+#include "logic/race/CarStateData.h"
+#include "math/Float.h"
 
 /*
  * Minimal testing facility:
@@ -68,9 +70,74 @@ BOOST_AUTO_TEST_CASE(SerializeTest)
 	// deserialize
 	car2.deserialize(ev);
 
-	// check
-	BOOST_CHECK(car1 == car2);
+	// state is quantized, check within its precision
+	BOOST_CHECK(Math::Float::cmp(car1.getPosition().x, car2.getPosition().x, 0.01f));
+	BOOST_CHECK(Math::Float::cmp(car1.getPosition().y, car2.getPosition().y, 0.01f));
+	BOOST_CHECK(Math::Float::cmp(car1.getSpeed(), car2.getSpeed(), 0.001f));
+	BOOST_CHECK(Math::Float::cmp(car1.getPhyWheelTurn(), car2.getPhyWheelTurn(), 0.001f));
+	BOOST_CHECK(car1.getIterationId() == car2.getIterationId());
+	BOOST_CHECK(car1.getInputState().turn == car2.getInputState().turn);
 
+	// quantized state goes through another round trip unchanged
+	Race::Car car3(&player);
+
+	CL_NetGameEvent ev2("");
+	car2.serialize(&ev2);
+	car3.deserialize(ev2);
+
+	BOOST_CHECK(car2 == car3);
+}
+
+BOOST_AUTO_TEST_CASE(DeserializeInvalidTest)
+{
+	Player player("");
+	Race::Car car1(&player), car2(&player), car3(&player);
+
+	car1.setAcceleration(true);
+	car1.update(500);
+
+	CL_NetGameEvent ev("");
+	car1.serialize(&ev);
+
+	// truncated data is ignored
+	const CL_String8 data = ev.get_argument(0);
+
+	CL_NetGameEvent truncated("");
+	truncated.add_argument(data.substr(0, data.length() / 2));
+
+	car2.deserialize(truncated);
+
+	BOOST_CHECK(car2 == car3);
+}
+
+BOOST_AUTO_TEST_CASE(ReplayTest)
+{
+	Player player("");
+	Race::Car car1(&player), car2(&player);
+
+	car1.setAcceleration(true);
+	car1.update(500);
+
+	car1.setTurn(1.0f);
+	car1.update(500);
+
+	// state from the moment of input change replays to the same place
+	const Race::CarStateData &changed = car1.getInputChangeState();
+
+	BOOST_REQUIRE(changed.get(Race::CarStateData::F_ITERATION) < car1.getIterationId());
+
+	car2.applyState(changed);
+	car2.updateToIteration(car1.getIterationId());
+
+	BOOST_CHECK(car1.getIterationId() == car2.getIterationId());
+	BOOST_CHECK(Math::Float::cmp(car1.getPosition().x, car2.getPosition().x, 0.1f));
+	BOOST_CHECK(Math::Float::cmp(car1.getPosition().y, car2.getPosition().y, 0.1f));
+
+	// nothing to do when the iteration is reached
+	const CL_Pointf position = car2.getPosition();
+	car2.updateToIteration(car1.getIterationId());
+
+	BOOST_CHECK(position == car2.getPosition());
 }
 
 BOOST_AUTO_TEST_CASE(CloneTest)
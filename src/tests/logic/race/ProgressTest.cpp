@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Player.h"
+#include "logic/race/Car.h"
+#include "logic/race/Progress.h"
+#include "logic/race/level/Checkpoint.h"
+#include "logic/race/level/Level.h"
+#include "logic/race/level/Track.h"
+#include "logic/race/level/TrackTriangulator.h"
+
+namespace {
+
+/** Closed square track */
+void buildLevel(Race::Level *p_level)
+{
+	Race::Track track;
+
+	track.addPoint(CL_Pointf(0.0f, 0.0f), 50.0f, 0.0f);
+	track.addPoint(CL_Pointf(1000.0f, 0.0f), 50.0f, 0.0f);
+	track.addPoint(CL_Pointf(1000.0f, 1000.0f), 50.0f, 0.0f);
+	track.addPoint(CL_Pointf(0.0f, 1000.0f), 50.0f, 0.0f);
+
+	p_level->setTrack(track);
+	p_level->getTrackTriangulator().triangulate(p_level->getTrack());
+}
+
+/** Drives p_car checkpoint by checkpoint up to p_index */
+void driveTo(Race::Progress &p_progress, Race::Car &p_car, int p_index)
+{
+	for (int i = p_progress.getCheckpoint(p_car).getIndex() + 1; i <= p_index; ++i) {
+		p_car.setPosition(p_progress.getCheckpoint(i).getPosition());
+		p_progress.update();
+	}
+
+	BOOST_REQUIRE_EQUAL(p_progress.getCheckpoint(p_car).getIndex(), p_index);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(ProgressTest)
+
+BOOST_AUTO_TEST_CASE(trackDistanceWrapsAround)
+{
+	Race::Level level;
+	buildLevel(&level);
+
+	Race::Progress progress(&level);
+	progress.initialize();
+
+	const int count = progress.getCheckpointCount();
+	BOOST_REQUIRE(count >= 8);
+
+	Player leaderPlayer("leader"), lastPlayer("last");
+	Race::Car leader(&leaderPlayer), last(&lastPlayer);
+
+	leader.setPosition(progress.getCheckpoint(0).getPosition());
+	last.setPosition(progress.getCheckpoint(0).getPosition());
+
+	progress.addCar(&leader);
+	progress.addCar(&last);
+
+	BOOST_CHECK_EQUAL(progress.getTrackDistance(leader, last), 0);
+
+	driveTo(progress, leader, 1);
+	const int first = progress.getTrackDistance(leader, last);
+
+	driveTo(progress, leader, count / 4);
+	const int quarter = progress.getTrackDistance(leader, last);
+
+	driveTo(progress, leader, count / 2);
+	const int half = progress.getTrackDistance(leader, last);
+
+	driveTo(progress, leader, count * 3 / 4);
+	const int threeQuarters = progress.getTrackDistance(leader, last);
+
+	driveTo(progress, leader, count - 1);
+	const int lastCheckpoint = progress.getTrackDistance(leader, last);
+
+	BOOST_CHECK(first > 0);
+	BOOST_CHECK(quarter > first);
+	BOOST_CHECK(half > quarter);
+
+	// past the half of the lap the other way around is shorter
+	BOOST_CHECK(threeQuarters < half);
+	BOOST_CHECK(lastCheckpoint < quarter);
+
+	// distance does not depend on the order of cars
+	BOOST_CHECK_EQUAL(progress.getTrackDistance(last, leader), lastCheckpoint);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -84,4 +84,44 @@ BOOST_AUTO_TEST_CASE(EasingNoneLoop)
 	BOOST_CHECK_CLOSE(f.get(), 1.0f, 0.01f);
 }
 
+BOOST_AUTO_TEST_CASE(DelayedSequence)
+{
+	Math::Float f;
+	f.animate(0.1f, 0.3f, 250, Math::Easing::NONE, 0);
+	f.animate(0.3f, 0.0f, 500, Math::Easing::NONE, 500);
+
+	BOOST_CHECK_CLOSE(f.get(), 0.1f, 0.01f);
+
+	f.update(250);
+	BOOST_CHECK_CLOSE(f.get(), 0.3f, 0.01f);
+
+	// waiting for the second animation
+	f.update(100);
+	BOOST_CHECK_CLOSE(f.get(), 0.3f, 0.01f);
+	BOOST_CHECK(f.isAnimating());
+
+	f.update(400);
+	BOOST_CHECK_CLOSE(f.get(), 0.15f, 0.01f);
+
+	f.update(250);
+	BOOST_CHECK(f.get() == 0.0f);
+	BOOST_CHECK(!f.isAnimating());
+}
+
+BOOST_AUTO_TEST_CASE(PendingOverflow)
+{
+	Math::Float f;
+
+	for (int i = 0; i < Math::Float::MAX_PENDING + 2; ++i) {
+		f.animate(i, i + 1, 100, Math::Easing::NONE, 100 * (i + 1));
+	}
+
+	// the first scheduled animations are still there
+	f.update(150);
+	BOOST_CHECK_CLOSE(f.get(), 0.5f, 0.01f);
+
+	f.update(100);
+	BOOST_CHECK_CLOSE(f.get(), 1.5f, 0.01f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Player.h"
+#include "logic/race/Car.h"
+#include "logic/race/CarStateData.h"
+#include "network/CarStateCodec.h"
+
+BOOST_AUTO_TEST_SUITE(CarStateCodecTest)
+
+BOOST_AUTO_TEST_CASE(deltaTest)
+{
+	Player player("");
+	Race::Car car(&player);
+
+	car.setPosition(CL_Pointf(-300.0f, 120.0f));
+	car.setAcceleration(true);
+	car.setTurn(-1.0f);
+
+	Net::CarStateCodec sender, receiver;
+	Race::CarStateData sent, received;
+
+	car.captureState(&sent);
+	const CL_String8 full = sender.encode(sent);
+
+	BOOST_REQUIRE(receiver.decode(full, &received));
+	BOOST_CHECK(received == sent);
+
+	for (int i = 0; i < 10; ++i) {
+		car.update(100);
+		car.captureState(&sent);
+
+		const CL_String8 delta = sender.encode(sent);
+
+		BOOST_REQUIRE(receiver.decode(delta, &received));
+		BOOST_CHECK(received == sent);
+		BOOST_CHECK(delta.length() < full.length());
+	}
+
+	// unchanged state takes only the header and field mask
+	BOOST_CHECK_EQUAL(sender.encode(sent).length(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(lostStateTest)
+{
+	Net::CarStateCodec sender, receiver, joined;
+	Race::CarStateData state, received;
+
+	state.set(Race::CarStateData::F_POSITION_X, -5000);
+	BOOST_REQUIRE(receiver.decode(sender.encode(state), &received));
+
+	// delta without its base is refused
+	state.set(Race::CarStateData::F_POSITION_X, -5010);
+	const CL_String8 delta = sender.encode(state);
+
+	BOOST_CHECK(!joined.decode(delta, &received));
+	BOOST_REQUIRE(receiver.decode(delta, &received));
+
+	// late joiner continues from full state of the receiver
+	BOOST_REQUIRE(joined.decode(receiver.encodeFull(), &received));
+
+	state.set(Race::CarStateData::F_SPEED, -7);
+	const CL_String8 next = sender.encode(state);
+
+	BOOST_REQUIRE(joined.decode(next, &received));
+	BOOST_CHECK(received == state);
+
+	// skipped state breaks the stream until a full one arrives
+	sender.encode(state);
+	BOOST_CHECK(!receiver.decode(sender.encode(state), &received));
+
+	sender.reset();
+	BOOST_REQUIRE(receiver.decode(sender.encode(state), &received));
+	BOOST_CHECK(received == state);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
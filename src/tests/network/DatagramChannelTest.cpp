@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unistd.h>
+#include <deque>
+#include <boost/test/unit_test.hpp>
+
+#include "network/DatagramChannel.h"
+#include "network/LossySocket.h"
+
+namespace {
+
+/**
+ * In-memory socket that receives everything it sends,
+ * each datagram seems to come from its destination
+ */
+class LoopbackSocket : public Net::DatagramSocket
+{
+	public:
+
+		typedef std::pair<CL_String8, CL_SocketName> TDatagram;
+
+
+		virtual void send(const CL_String8 &p_data, const CL_SocketName &p_to)
+		{
+			m_queue.push_back(TDatagram(p_data, p_to));
+		}
+
+		virtual bool receive(CL_String8 *p_data, CL_SocketName *p_from)
+		{
+			if (m_queue.empty()) {
+				return false;
+			}
+
+			*p_data = m_queue.front().first;
+			*p_from = m_queue.front().second;
+			m_queue.pop_front();
+
+			return true;
+		}
+
+		virtual CL_Event getReadEvent()
+		{
+			return m_readEvent;
+		}
+
+		std::deque<TDatagram> m_queue;
+
+		CL_Event m_readEvent;
+};
+
+CL_String8 number(int p_value)
+{
+	return CL_StringHelp::int_to_local8(p_value);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(DatagramChannelTest)
+
+BOOST_AUTO_TEST_CASE(newestWins)
+{
+	LoopbackSocket *loopback = new LoopbackSocket();
+	Net::DatagramChannel channel((CL_SharedPtr<Net::DatagramSocket>(loopback)));
+
+	const CL_SocketName to;
+
+	channel.send(7, "first", to);
+	channel.send(7, "second", to);
+	channel.send(9, "other", to);
+
+	// reorder and duplicate first two datagrams of peer 7
+	std::swap(loopback->m_queue[0], loopback->m_queue[1]);
+	loopback->m_queue.push_back(loopback->m_queue[0]);
+
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	BOOST_REQUIRE(channel.receive(&token, &message, &from));
+	BOOST_CHECK_EQUAL(token, 7u);
+	BOOST_CHECK(message == "second");
+
+	BOOST_REQUIRE(channel.receive(&token, &message, &from));
+	BOOST_CHECK_EQUAL(token, 9u);
+	BOOST_CHECK(message == "other");
+
+	BOOST_CHECK(!channel.receive(&token, &message, &from));
+	BOOST_CHECK_EQUAL(channel.getDroppedCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(partsOfNewestMessage)
+{
+	LoopbackSocket *loopback = new LoopbackSocket();
+	Net::DatagramChannel channel((CL_SharedPtr<Net::DatagramSocket>(loopback)));
+
+	const CL_SocketName to;
+
+	std::vector<CL_String8> parts;
+	parts.push_back("a");
+	parts.push_back("b");
+
+	channel.send(7, "old", to);
+	channel.sendParts(7, parts, to);
+
+	// second part arrives first, first part twice, old message last
+	std::swap(loopback->m_queue[1], loopback->m_queue[2]);
+	loopback->m_queue.push_back(loopback->m_queue[2]);
+	loopback->m_queue.push_back(loopback->m_queue[0]);
+	loopback->m_queue.pop_front();
+
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	BOOST_REQUIRE(channel.receive(&token, &message, &from));
+	BOOST_CHECK(message == "b");
+
+	BOOST_REQUIRE(channel.receive(&token, &message, &from));
+	BOOST_CHECK(message == "a");
+
+	BOOST_CHECK(!channel.receive(&token, &message, &from));
+	BOOST_CHECK_EQUAL(channel.getDroppedCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(sequenceWraps)
+{
+	Net::DatagramChannel channel(CL_SharedPtr<Net::DatagramSocket>(new LoopbackSocket()));
+
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	for (int i = 0; i < 70000; ++i) {
+		channel.send(1, number(i), CL_SocketName());
+
+		BOOST_REQUIRE(channel.receive(&token, &message, &from));
+		BOOST_REQUIRE(message == number(i));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(boundPeerIgnoresOtherHosts)
+{
+	LoopbackSocket *loopback = new LoopbackSocket();
+	Net::DatagramChannel channel((CL_SharedPtr<Net::DatagramSocket>(loopback)));
+
+	const CL_SocketName peer("127.0.0.1", "2500");
+	const CL_SocketName spoofer("10.0.0.66", "2500");
+
+	channel.bind(7, "127.0.0.1");
+
+	channel.send(7, "first", peer);
+	channel.send(7, "second", peer);
+	channel.send(7, "spoofed", spoofer);
+
+	// spoofed datagram is newest and arrives first
+	loopback->m_queue.push_front(loopback->m_queue.back());
+	loopback->m_queue.pop_back();
+
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	BOOST_REQUIRE(channel.receive(&token, &message, &from));
+	BOOST_CHECK(message == "first");
+
+	BOOST_REQUIRE(channel.receive(&token, &message, &from));
+	BOOST_CHECK(message == "second");
+
+	BOOST_CHECK(!channel.receive(&token, &message, &from));
+	BOOST_CHECK_EQUAL(channel.getDroppedCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(lossyLink)
+{
+	CL_SharedPtr<Net::DatagramSocket> loopback(new LoopbackSocket());
+	Net::LossySocket *lossy = new Net::LossySocket(loopback, 30, 20, 10);
+
+	Net::DatagramChannel channel((CL_SharedPtr<Net::DatagramSocket>(lossy)));
+
+	for (int i = 0; i < 200; ++i) {
+		channel.send(1, number(i), CL_SocketName());
+	}
+
+	unsigned token;
+	CL_String8 message;
+	CL_SocketName from;
+
+	// nothing arrives before the latency
+	BOOST_CHECK(!channel.receive(&token, &message, &from));
+
+	usleep(40 * 1000);
+
+	int received = 0;
+	int last = -1;
+
+	while (channel.receive(&token, &message, &from)) {
+		const int value = CL_StringHelp::local8_to_int(message);
+
+		BOOST_CHECK(value > last);
+		last = value;
+
+		++received;
+	}
+
+	BOOST_CHECK(lossy->getDroppedCount() > 30);
+	BOOST_CHECK(received > 0);
+	BOOST_CHECK(received + lossy->getDroppedCount() + channel.getDroppedCount() == 200);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "network/packets/GameState.h"
+
+BOOST_AUTO_TEST_SUITE(GameStateTest)
+
+BOOST_AUTO_TEST_CASE(headerWithSomeStates)
+{
+	Net::CarState carState;
+	CL_NetGameEvent data("");
+
+	data.add_argument(CL_String8("packed state"));
+
+	carState.setName("joining");
+	carState.setIterationId(42);
+	carState.setSerializedData(data);
+
+	Net::GameState sent;
+
+	sent.setLevel("levels/level.xml");
+	sent.addPlayer("other");
+	sent.addPlayer("joining", carState);
+
+	Net::GameState received;
+	received.parseEvent(sent.buildEvent());
+
+	BOOST_CHECK(received.getLevel() == "levels/level.xml");
+	BOOST_REQUIRE_EQUAL(received.getPlayerCount(), 2);
+
+	BOOST_CHECK(received.getPlayerName(0) == "other");
+	BOOST_CHECK(!received.hasCarState(0));
+
+	BOOST_CHECK(received.getPlayerName(1) == "joining");
+	BOOST_REQUIRE(received.hasCarState(1));
+	BOOST_CHECK_EQUAL(received.getCarState(1).getIterationId(), 42);
+
+	const CL_String8 state = received.getCarState(1).getSerializedData().get_argument(0);
+	BOOST_CHECK(state == "packed state");
+}
+
+BOOST_AUTO_TEST_CASE(truncated)
+{
+	Net::GameState sent;
+
+	sent.setLevel("levels/level.xml");
+	sent.addPlayer("first");
+	sent.addPlayer("second");
+
+	const CL_NetGameEvent event = sent.buildEvent();
+	const CL_String8 packed = event.get_argument(1);
+
+	CL_NetGameEvent truncated(event.get_name());
+	truncated.add_argument(event.get_argument(0));
+	truncated.add_argument(packed.substr(0, packed.length() - 2));
+
+	Net::GameState received;
+	BOOST_CHECK_THROW(received.parseEvent(truncated), CL_Exception);
+	BOOST_CHECK_EQUAL(received.getPlayerCount(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "math/Float.h"
+#include "network/InterpolationBuffer.h"
+
+namespace {
+
+Net::InterpolationBuffer::Sample makeSample(double p_time, float p_x, float p_speed)
+{
+	Net::InterpolationBuffer::Sample sample;
+
+	sample.m_time = p_time;
+	sample.m_position = CL_Pointf(p_x, 0.0f);
+	sample.m_velocity = CL_Vec2f(p_speed, 0.0f);
+	sample.m_angle = CL_Angle(0.0f, cl_radians);
+
+	return sample;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(InterpolationBufferTest)
+
+BOOST_AUTO_TEST_CASE(uniformMotion)
+{
+	Net::InterpolationBuffer buffer;
+
+	// one unit per millisecond
+	for (int i = 0; i < 5; ++i) {
+		BOOST_REQUIRE(buffer.add(makeSample(i * 100, i * 100, 1.0f), i * 100));
+	}
+
+	Net::InterpolationBuffer::Sample sample;
+
+	// path goes through samples and uniform motion stays uniform
+	buffer.sample(200.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, 200.0f, 0.01f));
+
+	buffer.sample(250.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, 250.0f, 0.01f));
+
+	buffer.sample(333.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, 333.0f, 0.01f));
+
+	// shown time is behind the newest sample
+	BOOST_CHECK(buffer.getRenderTime(400.0) < 400.0);
+}
+
+BOOST_AUTO_TEST_CASE(smoothCorrection)
+{
+	Net::InterpolationBuffer buffer;
+
+	buffer.add(makeSample(0.0, 0.0f, 0.0f), 0.0);
+	buffer.add(makeSample(100.0, 100.0f, 0.0f), 100.0);
+
+	Net::InterpolationBuffer::Sample sample;
+
+	// standing samples give ease in and out
+	buffer.sample(25.0, &sample);
+	BOOST_CHECK(sample.m_position.x > 0.0f && sample.m_position.x < 25.0f);
+
+	buffer.sample(50.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, 50.0f, 0.01f));
+}
+
+BOOST_AUTO_TEST_CASE(staleAndExtrapolation)
+{
+	Net::InterpolationBuffer buffer;
+
+	buffer.add(makeSample(0.0, 0.0f, 1.0f), 0.0);
+	buffer.add(makeSample(100.0, 100.0f, 1.0f), 100.0);
+
+	// older and duplicated samples are ignored
+	BOOST_CHECK(!buffer.add(makeSample(50.0, 10.0f, 1.0f), 150.0));
+	BOOST_CHECK(!buffer.add(makeSample(100.0, 10.0f, 1.0f), 150.0));
+
+	Net::InterpolationBuffer::Sample sample;
+
+	buffer.sample(200.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, 200.0f, 0.01f));
+
+	// path doesn't continue forever
+	const float limit = 100.0f + Net::InterpolationBuffer::MAX_EXTRAPOLATION_MS;
+
+	buffer.sample(10000.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, limit, 0.01f));
+
+	// before the oldest sample car stays at it
+	buffer.sample(-100.0, &sample);
+	BOOST_CHECK(Math::Float::cmp(sample.m_position.x, 0.0f, 0.01f));
+}
+
+BOOST_AUTO_TEST_CASE(adaptiveDelay)
+{
+	Net::InterpolationBuffer steady, jittery;
+
+	for (int i = 0; i < 200; ++i) {
+		const double time = i * 50.0;
+		const double jitter = (i % 2) * 80.0;
+
+		steady.add(makeSample(time, 0.0f, 0.0f), time);
+		jittery.add(makeSample(time, 0.0f, 0.0f), time + jitter);
+	}
+
+	BOOST_CHECK(steady.getDelay() >= Net::InterpolationBuffer::MIN_DELAY_MS);
+	BOOST_CHECK(steady.getDelay() < 60.0);
+	BOOST_CHECK(jittery.getDelay() > steady.getDelay() + 50.0);
+	BOOST_CHECK(jittery.getDelay() <= Net::InterpolationBuffer::MAX_DELAY_MS);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
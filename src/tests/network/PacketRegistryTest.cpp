@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "network/PacketRegistry.h"
+#include "network/events.h"
+
+BOOST_AUTO_TEST_SUITE(PacketRegistryTest)
+
+BOOST_AUTO_TEST_CASE(names)
+{
+	Net::PacketRegistry registry;
+
+	BOOST_CHECK(Net::PacketRegistry::getOpcode(EVENT_CAR_STATE) == Net::OP_CAR_STATE);
+	BOOST_CHECK(Net::PacketRegistry::getName(Net::OP_SNAPSHOT) == EVENT_SNAPSHOT);
+	BOOST_CHECK(Net::PacketRegistry::getOpcode("no_such_event") == Net::OP_UNKNOWN);
+
+	// events go by name until the peer knows opcodes
+	const CL_NetGameEvent event(EVENT_VOTE_TICK, 1);
+
+	BOOST_CHECK(registry.encode(event).get_name() == EVENT_VOTE_TICK);
+	BOOST_CHECK(registry.decode(event) == Net::OP_VOTE_TICK);
+}
+
+BOOST_AUTO_TEST_CASE(peerOpcodes)
+{
+	// server of other version knows events in different order
+	std::vector<CL_String> serverNames;
+
+	serverNames.push_back(EVENT_SNAPSHOT);
+	serverNames.push_back("some_new_event");
+	serverNames.push_back(EVENT_CAR_STATE);
+
+	Net::PacketRegistry server, client;
+
+	server.setPeerNames(serverNames);
+	client.setPeerNames(serverNames);
+
+	CL_NetGameEvent event(EVENT_CAR_STATE);
+	event.add_argument(7);
+	event.add_argument("name");
+
+	const CL_NetGameEvent sent = client.encode(event);
+
+	BOOST_CHECK(sent.get_name().length() == 1);
+
+	const int opcode = server.decode(sent);
+	BOOST_REQUIRE(opcode == Net::OP_CAR_STATE);
+
+	const CL_NetGameEvent restored = server.restore(sent, opcode);
+
+	BOOST_CHECK(restored.get_name() == EVENT_CAR_STATE);
+	BOOST_REQUIRE(restored.get_argument_count() == 2);
+	BOOST_CHECK(static_cast<int>(restored.get_argument(0)) == 7);
+
+	// events unknown to the peer still go by name
+	BOOST_CHECK(client.encode(CL_NetGameEvent(EVENT_VOTE_END)).get_name() == EVENT_VOTE_END);
+
+	// opcodes out of the table are unknown
+	BOOST_CHECK(server.decode(CL_NetGameEvent("~")) == Net::OP_UNKNOWN);
+	BOOST_CHECK(server.decode(CL_NetGameEvent("\"")) == Net::OP_UNKNOWN);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "network/loadbot/LatencyStats.h"
+#include "network/loadbot/LoadStats.h"
+
+BOOST_AUTO_TEST_SUITE(LoadStatsTest)
+
+BOOST_AUTO_TEST_CASE(latencyPercentiles)
+{
+	Net::LatencyStats stats;
+
+	BOOST_CHECK_EQUAL(stats.getAverage(), 0u);
+	BOOST_CHECK_EQUAL(stats.getPercentile(95), 0u);
+
+	for (unsigned ms = 100; ms >= 1; --ms) {
+		stats.add(ms);
+	}
+
+	BOOST_CHECK_EQUAL(stats.getCount(), 100u);
+	BOOST_CHECK_EQUAL(stats.getAverage(), 50u);
+	BOOST_CHECK_EQUAL(stats.getMax(), 100u);
+	BOOST_CHECK_EQUAL(stats.getPercentile(50), 50u);
+	BOOST_CHECK_EQUAL(stats.getPercentile(95), 95u);
+	BOOST_CHECK_EQUAL(stats.getPercentile(100), 100u);
+
+	stats.clear();
+	BOOST_CHECK_EQUAL(stats.getCount(), 0u);
+	BOOST_CHECK_EQUAL(stats.getMax(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(relayTimedFromSend)
+{
+	Net::LoadStats stats;
+
+	stats.carStateSent("bot0", 10, 30, 1000);
+	stats.carStateSent("bot0", 12, 20, 1050);
+
+	stats.carStateRelayed("bot0", 12, 1080);
+	stats.carStateRelayed("bot0", 10, 1100);
+
+	// states not sent by a bot are counted, but not timed
+	stats.carStateRelayed("bot0", 11, 1100);
+	stats.carStateRelayed("player", 5, 1100);
+
+	BOOST_CHECK_EQUAL(stats.getSentCount(), 2u);
+	BOOST_CHECK_EQUAL(stats.getSentBytes(), 50u);
+	BOOST_CHECK_EQUAL(stats.getRelayedCount(), 4u);
+
+	BOOST_CHECK_EQUAL(stats.getRelay().getCount(), 2u);
+	BOOST_CHECK_EQUAL(stats.getRelay().getAverage(), 65u);
+	BOOST_CHECK_EQUAL(stats.getRelay().getMax(), 100u);
+
+	// send times outlive report interval
+	stats.clear();
+	stats.carStateRelayed("bot0", 12, 1150);
+
+	BOOST_CHECK_EQUAL(stats.getSentCount(), 0u);
+	BOOST_CHECK_EQUAL(stats.getRelay().getMax(), 100u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.h"
+#include "common/Properties.h"
+#include "network/server/ServerConfiguration.h"
+
+BOOST_AUTO_TEST_SUITE(ServerConfigurationTest)
+
+BOOST_AUTO_TEST_CASE(roomOverrides)
+{
+	Properties::set(SRV_PORT, 3000);
+	Properties::set(SRV_LEVEL, CL_String("default.xml"));
+	Properties::set(SRV_GAME_MODE, CL_String(SRV_GAME_MODE_TIMETRAIL));
+
+	Properties::set("srv_room1_level", CL_String("other.xml"));
+	Properties::set("srv_room2_port", 4000);
+	Properties::set("srv_room2_game_mode", CL_String(SRV_GAME_MODE_ARCADE));
+
+	const Net::ServerConfiguration first = Net::ServerConfiguration::fromProperties(0);
+
+	BOOST_CHECK_EQUAL(first.getPort(), 3000);
+	BOOST_CHECK(first.getLevel() == "default.xml");
+	BOOST_CHECK(first.getLevelPath() == CL_String(LEVELS_DIR) + "/default.xml");
+	BOOST_CHECK(first.getGameMode() == SRV_GAME_MODE_TIMETRAIL);
+
+	// rooms without own port get consecutive ones
+	const Net::ServerConfiguration second = Net::ServerConfiguration::fromProperties(1);
+
+	BOOST_CHECK_EQUAL(second.getPort(), 3001);
+	BOOST_CHECK(second.getLevel() == "other.xml");
+	BOOST_CHECK(second.getGameMode() == SRV_GAME_MODE_TIMETRAIL);
+
+	const Net::ServerConfiguration third = Net::ServerConfiguration::fromProperties(2);
+
+	BOOST_CHECK_EQUAL(third.getPort(), 4000);
+	BOOST_CHECK(third.getLevel() == "default.xml");
+	BOOST_CHECK(third.getGameMode() == SRV_GAME_MODE_ARCADE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
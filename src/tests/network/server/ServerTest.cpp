@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "ClanLib/core.h"
+#include "ClanLib/network.h"
+
+#include "common/Properties.h"
+#include "common/WorkerPool.h"
+#include "logic/race/level/Level.h"
+#include "logic/race/level/Track.h"
+#include "logic/race/level/TrackTriangulator.h"
+#include "network/client/Client.h"
+#include "network/packets/GameState.h"
+#include "network/server/Server.h"
+#include "network/server/ServerConfiguration.h"
+
+namespace {
+
+const int TEST_PORT = 25480;
+
+const unsigned JOIN_TIMEOUT_MS = 5000;
+
+/** Closed square track, enough for progress checkpoints */
+void buildLevel(Race::Level *p_level)
+{
+	Race::Track track;
+
+	track.addPoint(CL_Pointf(0.0f, 0.0f), 50.0f, 0.0f);
+	track.addPoint(CL_Pointf(1000.0f, 0.0f), 50.0f, 0.0f);
+	track.addPoint(CL_Pointf(1000.0f, 1000.0f), 50.0f, 0.0f);
+	track.addPoint(CL_Pointf(0.0f, 1000.0f), 50.0f, 0.0f);
+
+	p_level->setTrack(track);
+	p_level->getTrackTriangulator().triangulate(p_level->getTrack());
+}
+
+class TestClient
+{
+	public:
+
+		Net::Client m_client;
+
+		Net::GameState m_gameState;
+
+		bool m_joined;
+
+		CL_SlotContainer m_slots;
+
+
+		explicit TestClient(const CL_String &p_name) :
+			m_joined(false)
+		{
+			m_client.setPlayerName(p_name);
+			m_client.setServerAddr("127.0.0.1");
+			m_client.setServerPort(TEST_PORT);
+
+			m_slots.connect(m_client.sig_gameStateReceived(), this, &TestClient::onGameState);
+		}
+
+		void onGameState(const Net::GameState &p_gameState)
+		{
+			m_gameState = p_gameState;
+			m_joined = true;
+		}
+
+		int findPlayer(const CL_String &p_name) const
+		{
+			for (int i = 0; i < m_gameState.getPlayerCount(); ++i) {
+				if (m_gameState.getPlayerName(i) == p_name) {
+					return i;
+				}
+			}
+
+			return -1;
+		}
+};
+
+/** Runs server and client in this thread until client gets game state */
+bool join(Net::Server &p_server, TestClient &p_client)
+{
+	if (!p_client.m_client.connect()) {
+		return false;
+	}
+
+	const unsigned start = CL_System::get_time();
+
+	while (!p_client.m_joined && CL_System::get_time() - start < JOIN_TIMEOUT_MS) {
+		p_server.update();
+		p_client.m_client.update();
+
+		CL_KeepAlive::process(10);
+	}
+
+	return p_client.m_joined;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(ServerTest)
+
+BOOST_AUTO_TEST_CASE(joinHeaderHasOwnCarState)
+{
+	CL_SetupCore setupCore;
+	CL_SetupNetwork setupNetwork;
+
+	Race::Level level;
+	buildLevel(&level);
+
+	Net::ServerConfiguration config;
+	config.setPort(TEST_PORT);
+	config.setLevel("test.xml");
+	config.setGameMode(SRV_GAME_MODE_ARCADE);
+
+	WorkerPool validationPool(1);
+
+	Net::Server server(config, level, validationPool);
+	server.start();
+
+	TestClient first("first");
+	BOOST_REQUIRE(join(server, first));
+
+	TestClient joiner("joiner");
+	BOOST_REQUIRE(join(server, joiner));
+
+	// first player was alone in the room
+	const int firstSelf = first.findPlayer("first");
+	BOOST_REQUIRE(firstSelf != -1);
+	BOOST_CHECK(first.m_gameState.hasCarState(firstSelf));
+
+	// other cars come with snapshots, own one is in the header
+	const int self = joiner.findPlayer("joiner");
+	const int other = joiner.findPlayer("first");
+
+	BOOST_REQUIRE(self != -1);
+	BOOST_REQUIRE(other != -1);
+
+	BOOST_CHECK(joiner.m_gameState.hasCarState(self));
+	BOOST_CHECK(!joiner.m_gameState.hasCarState(other));
+
+	BOOST_CHECK(joiner.m_gameState.getCarState(self).getName() == "joiner");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "network/server/SnapshotInterest.h"
+
+using Net::SnapshotInterest;
+
+BOOST_AUTO_TEST_SUITE(SnapshotInterestTest)
+
+BOOST_AUTO_TEST_CASE(intervalFollowsDistance)
+{
+	// on screen cars go with every snapshot, even far along the track
+	BOOST_CHECK_EQUAL(SnapshotInterest::getInterval(100.0f, 3000), 0u);
+
+	const unsigned nearInterval = SnapshotInterest::getInterval(1000.0f, 1000);
+	const unsigned farInterval = SnapshotInterest::getInterval(1000.0f, 3000);
+
+	BOOST_CHECK(nearInterval > 0);
+	BOOST_CHECK(farInterval > nearInterval);
+}
+
+BOOST_AUTO_TEST_CASE(unknownCarIsSentFull)
+{
+	const SnapshotInterest interest;
+
+	BOOST_CHECK(!interest.isKnown());
+	BOOST_CHECK_EQUAL(interest.getContent(5, true, 2000, true, 0), SnapshotInterest::C_FULL);
+}
+
+BOOST_AUTO_TEST_CASE(reliableReceiverGetsDeltas)
+{
+	const unsigned interval = SnapshotInterest::getInterval(1000.0f, 1000);
+
+	SnapshotInterest interest;
+	interest.markSent(1, 1000);
+
+	// nothing changed
+	BOOST_CHECK_EQUAL(interest.getContent(1, true, interval, true, 1000 + 10 * interval), SnapshotInterest::C_NONE);
+
+	// changed, but not yet time for it
+	BOOST_CHECK_EQUAL(interest.getContent(2, true, interval, true, 1000 + interval / 2), SnapshotInterest::C_NONE);
+
+	// next version goes as delta
+	BOOST_CHECK_EQUAL(interest.getContent(2, true, interval, true, 1000 + interval), SnapshotInterest::C_DELTA);
+
+	// no delta at hand or a version was skipped
+	BOOST_CHECK_EQUAL(interest.getContent(2, false, interval, true, 1000 + interval), SnapshotInterest::C_FULL);
+	BOOST_CHECK_EQUAL(interest.getContent(3, true, interval, true, 1000 + interval), SnapshotInterest::C_FULL);
+}
+
+BOOST_AUTO_TEST_CASE(datagramReceiverGetsFullStates)
+{
+	const unsigned interval = SnapshotInterest::getInterval(100.0f, 0);
+
+	SnapshotInterest interest;
+	interest.markSent(1, 1000);
+
+	BOOST_CHECK_EQUAL(interest.getContent(2, true, interval, false, 1000), SnapshotInterest::C_FULL);
+
+	// unchanged car is repeated after a while in case it was lost
+	BOOST_CHECK_EQUAL(interest.getContent(1, true, interval, false, 1010), SnapshotInterest::C_NONE);
+	BOOST_CHECK_EQUAL(interest.getContent(1, true, interval, false, 1000 + 10000), SnapshotInterest::C_FULL);
+
+	interest.markSent(1, 11000);
+	BOOST_CHECK_EQUAL(interest.getContent(1, true, interval, false, 11010), SnapshotInterest::C_NONE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
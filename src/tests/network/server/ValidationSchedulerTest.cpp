@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "network/server/ValidationScheduler.h"
+
+/** Constant seed keeps test runs repeatable */
+const unsigned TEST_SEED = 0x9E3779B9;
+
+BOOST_AUTO_TEST_SUITE(ValidationSchedulerTest)
+
+BOOST_AUTO_TEST_CASE(staysWithinBudget)
+{
+	// each check takes 1 ms, 2 ms are allowed per tick
+	static const unsigned CHECK_US = 1000;
+	static const int STATES_PER_TICK = 20;
+
+	Net::ValidationScheduler scheduler(2 * CHECK_US, TEST_SEED);
+
+	BOOST_CHECK_EQUAL(scheduler.getSampleRate(), 1.0f);
+
+	unsigned checked = 0;
+
+	for (int tick = 0; tick < 200; ++tick) {
+		checked = 0;
+
+		for (int i = 0; i < STATES_PER_TICK; ++i) {
+			if (scheduler.shouldCheck(false)) {
+				scheduler.addCheckTime(CHECK_US);
+				++checked;
+			}
+		}
+
+		scheduler.tick();
+	}
+
+	// about one tenth of states fit the budget
+	BOOST_CHECK(checked <= 4);
+	BOOST_CHECK(scheduler.getSampleRate() > 0.05f);
+	BOOST_CHECK(scheduler.getSampleRate() < 0.2f);
+
+	BOOST_CHECK_EQUAL(
+			scheduler.getCheckedCount() + scheduler.getSkippedCount(),
+			200u * STATES_PER_TICK
+	);
+	BOOST_CHECK(scheduler.getSkippedCount() > scheduler.getCheckedCount());
+}
+
+BOOST_AUTO_TEST_CASE(suspiciousAlwaysChecked)
+{
+	Net::ValidationScheduler scheduler(1, TEST_SEED);
+
+	// overload the budget to drop the rate to minimum
+	for (int i = 0; i < 10; ++i) {
+		scheduler.shouldCheck(false);
+		scheduler.addCheckTime(1000);
+		scheduler.tick();
+	}
+
+	BOOST_CHECK(scheduler.getSampleRate() < 0.05f);
+
+	for (int i = 0; i < 100; ++i) {
+		BOOST_CHECK(scheduler.shouldCheck(true));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(recoversWhenIdle)
+{
+	Net::ValidationScheduler scheduler(1000, TEST_SEED);
+
+	scheduler.addCheckTime(100000);
+	scheduler.tick();
+
+	BOOST_CHECK(scheduler.getSampleRate() < 0.05f);
+
+	for (int i = 0; i < 100; ++i) {
+		scheduler.tick();
+	}
+
+	BOOST_CHECK_EQUAL(scheduler.getSampleRate(), 1.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()